@@ -0,0 +1,46 @@
+#include "alloc_counter.h"
+
+#ifdef UI_ALLOC_COUNTER
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete. The nothrow forms call these by
+// default, so they are counted too; the aligned forms are not.
+static thread_local uint64_t allocationCount = 0;
+
+uint64_t thread_allocation_count() {
+    return allocationCount;
+}
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif // UI_ALLOC_COUNTER
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Allocation counter ---
+// Counts calls to the global operator new made by the calling thread, so a
+// frame can check that its UI path allocates nothing: read the count before
+// and after, and compare. Worker threads have their own counts.
+//
+// Counting replaces the global operator new and delete, so it is built only
+// when UI_ALLOC_COUNTER is defined: always in native builds (the replay
+// benchmarks report it), and in web builds only with -DUI_ALLOC_COUNTER on
+// the build line. Without it the count is always 0 and alloc_counter.cpp
+// compiles to nothing, so the deployed page keeps the default allocator.
+#if !defined(UI_ALLOC_COUNTER) && !defined(__EMSCRIPTEN__)
+#define UI_ALLOC_COUNTER
+#endif
+
+#ifdef UI_ALLOC_COUNTER
+const bool ALLOC_COUNTER_ENABLED = true;
+uint64_t thread_allocation_count();
+#else
+const bool ALLOC_COUNTER_ENABLED = false;
+inline uint64_t thread_allocation_count() { return 0; }
+#endif
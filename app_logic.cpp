@@ -4,18 +4,11 @@
 
 #include "app_logic.h"
 #include <iostream> 
+#include <cstdio>
 
 // Using namespace std for convenience in this .cpp file
 using namespace std;
 
-// This global is used by attemptDeleteEvent/attemptSignUp to store the suggestion
-// It's then read by confirmDeleteSuggestedEvent/confirmSignUpSuggestedEvent
-// and by the UI in main.cpp to display the "Did you mean X?" message.
-// This is not ideal from a strict encapsulation perspective but matches the prior structure.
-// A better approach would be for these functions to return a struct containing
-// the message and any suggestion, or for a UI state class to manage this.
-extern string suggestedMatch; // Defined in main.cpp
-
 // --- Helper Function Definitions ---
 string cEncrypt(const string& str, int shift) {
     string result = str;
@@ -102,15 +95,62 @@ void addIfAccurateEnough(vector<string>& vec, const string& query, const string&
     }
 }
 
+bool lengthRulesOutMatch(size_t queryLength, size_t candidateLength, double threshold) {
+    size_t longer = max(queryLength, candidateLength);
+    if (longer == 0) return false;
+    size_t gap = longer - min(queryLength, candidateLength);
+    return 1.0 - static_cast<double>(gap) / longer < threshold; // Same arithmetic as addIfAccurateEnough's accuracy
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's days_from_civil).
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+bool parseDateTime(const string& dt, int64_t& epochOut) {
+    int day, month, year, hour, minute, consumed = -1;
+    if (sscanf(dt.c_str(), "%d/%d/%d %d:%d%n", &day, &month, &year, &hour, &minute, &consumed) != 5 || consumed < 0) {
+        return false;
+    }
+    if (dt.find_first_not_of(" \t", consumed) != string::npos) return false; // Trailing junk
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1 || year > 9999 || month < 1 || month > 12 || hour < 0 || hour > 23 || minute < 0 || minute > 59) return false;
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    int monthDays = daysInMonth[month - 1] + ((month == 2 && leap) ? 1 : 0);
+    if (day < 1 || day > monthDays) return false;
+
+    epochOut = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60;
+    return true;
+}
+
+string eventTypeName(eventType type) {
+    switch (type) {
+        case Webinar: return "Webinar";
+        case Conference: return "Conference";
+        case Workshop: return "Workshop";
+    }
+    return "Event";
+}
+
+static int64_t startTimeOf(const string& dt) {
+    int64_t t = UNKNOWN_EVENT_TIME;
+    parseDateTime(dt, t);
+    return t;
+}
+
 // --- User Class Method Definitions ---
 User* User::instance = nullptr; 
 
 User::User() : name(""), email(""), phoneNum(""), companyOrSchool("") {} 
 
 User* User::getInstance() {
-    if (!instance) {
-        instance = new User();
-    }
+    static once_flag created; // The first call may come from any thread in a native host
+    call_once(created, [] { instance = new User(); });
     return instance;
 }
 
@@ -123,59 +163,91 @@ string User::getEmail() const { return email; }
 string User::getPhoneNumber() const { return phoneNum; }
 string User::getCompanyOrSchool() const { return companyOrSchool; }
 
-// --- attendee Class Method Definitions ---
-attendee::attendee(string n, string e, string p, string cs) :
-    name(n), email(e), phoneNum(p), companyOrSchool(cs) {}
-string attendee::getName() const { return name; }
-string attendee::getEmail() const { return email; }
-string attendee::getPhoneNum() const { return phoneNum; }
-string attendee::getcompanyOrSchool() const { return companyOrSchool; }
-
-
 // --- event Class Method Definitions ---
 event::event(string t, string h, string d, string dt, string v, int c) :
-    title(t), host(h), description(d), dateAndTime(dt), vPlatform(v), capacity(c) {}
+    title(t), host(h), description(d), dateAndTime(dt), vPlatform(v), startTime(startTimeOf(dt)), capacity(c) {
+    updateAccounting();
+}
 
 event::event(User* user, const string& t, const string& desc, const string& dt, const string& vp, int cap) :
-    title(t), description(desc), dateAndTime(dt), vPlatform(vp), capacity(cap) {
+    title(t), description(desc), dateAndTime(dt), vPlatform(vp), startTime(startTimeOf(dt)), capacity(cap) {
     if (user) {
         host = user->getName();
     } else {
         host = "Unknown Host"; 
     }
+    updateAccounting();
 }
 
 event::~event() {
-    for (auto a : attendees) {
-        delete a;
-    }
-    attendees.clear();
+    memory_release(MEM_EVENTS, accountedBytes); // Attendees belong to the manager's PersonTable
+}
+
+// The subclasses add only their type tag to sizeof(event).
+void event::updateAccounting() {
+    size_t bytes = sizeof(event) + string_heap_bytes(title) + string_heap_bytes(host) + string_heap_bytes(description) +
+                   string_heap_bytes(dateAndTime) + string_heap_bytes(vPlatform);
+    memory_add(MEM_EVENTS, bytes);
+    memory_release(MEM_EVENTS, accountedBytes);
+    accountedBytes = bytes;
 }
 
 string event::getTitle() const { return title; }
 string event::getHost() const { return host; }
 string event::getDescription() const { return description; }
 string event::getdateAndTime() const { return dateAndTime; }
+int64_t event::getStartTime() const { return startTime; }
 string event::getvPlatform() const { return vPlatform; }
 int event::getcapacity() const { return capacity; }
-int event::getAttendeeCount() const { return attendees.size(); }
+// Counts reserved seats, so it is safe to read while other threads sign up. It can
+// run one ahead of capacity for the instant a losing reservation is rolled back.
+int event::getAttendeeCount() const { return seatsTaken.load(memory_order_acquire); }
+int event::getFreeSeats() const { return max(0, capacity - getAttendeeCount()); }
+bool event::isFull() const { return getAttendeeCount() >= capacity; }
+
+bool event::tryReserveSeat() {
+    if (isFull()) return false; // Reject without a read-modify-write once the event is full
+    if (seatsTaken.fetch_add(1, memory_order_acq_rel) < capacity) return true;
+    seatsTaken.fetch_sub(1, memory_order_acq_rel); // Lost the race for the last seat
+    return false;
+}
 
-const std::vector<attendee*>& event::getAttendees() const {
+const AttendeeList& event::getAttendees() const {
     return attendees;
 }
-void event::addAttendee(attendee* a) {
-    if (a) { // Basic null check
-        attendees.push_back(a);
-    }
+void event::addAttendee(PersonId who) {
+    attendees.push_back(who);
+    seatsTaken.fetch_add(1, memory_order_acq_rel);
+}
+
+bool event::tryAddAttendee(PersonId who) {
+    if (!tryReserveSeat()) return false;
+    attendees.push_back(who);
+    return true;
 }
 
-void event::setTitle(string t) { title = t; }
-void event::setHost(string h) { host = h; }
-void event::setDescription(string d) { description = d; }
-void event::setDateAndTime(string dt_val) { dateAndTime = dt_val; } // Parameter name changed to avoid conflict
-void event::setvPlatform(string v) { vPlatform = v; }
+void event::reserveAttendees(size_t additional) { attendees.reserve(attendees.size() + additional); }
+
+string event::fullMessage() const { return "Sorry! Capacity is full for " + eventTypeName(getType()) + ": " + title; }
+
+void event::setTitle(string t) { title = t; updateAccounting(); }
+void event::setHost(string h) { host = h; updateAccounting(); }
+void event::setDescription(string d) { description = d; updateAccounting(); }
+void event::setDateAndTime(string dt_val) { dateAndTime = dt_val; startTime = startTimeOf(dateAndTime); updateAccounting(); } // Parameter name changed to avoid conflict
+void event::setvPlatform(string v) { vPlatform = v; updateAccounting(); }
 void event::setCapacity(int c) { capacity = c; }
 
+event* event::createEvent(eventType type, const string& host_val, const string& title_val, const string& desc_val, const string& dts_val, const string& vps_val, int capacity_val) {
+    switch (type) {
+        case Webinar: return new webinar(type, title_val, host_val, desc_val, dts_val, vps_val, capacity_val);
+        case Conference: return new conference(type, title_val, host_val, desc_val, dts_val, vps_val, capacity_val);
+        case Workshop: return new workshop(type, title_val, host_val, desc_val, dts_val, vps_val, capacity_val);
+        default: 
+            cerr << "Unknown event type in factory: " << type << endl;
+            return nullptr;
+    }
+}
+
 event* event::createEvent(eventType type, User* user, const string& title_val, const string& desc_val, const string& dts_val, const string& vps_val, int capacity_val) {
     switch (type) {
         case Webinar: return new webinar(user, title_val, desc_val, dts_val, vps_val, capacity_val);
@@ -195,17 +267,16 @@ webinar::webinar(User* user, const string& t, const string& desc, const string&
     : event(user, t, desc, date, vp, cap) {
     type_val = Webinar;
 }
-string webinar::signUp(User* user, string& message) {
-    if (!user) { message = "Error: User details not available for sign up."; return message; }
-    if (attendees.size() >= static_cast<size_t>(capacity)) {
-        message = "Sorry! Capacity is full for Webinar: " + title;
-        return message;
+bool webinar::signUp(PersonId who, string& message) {
+    if (!tryReserveSeat()) {
+        message = fullMessage();
+        return false;
     }
-    attendees.push_back(new attendee(user->getName(), user->getEmail(), user->getPhoneNumber(), user->getCompanyOrSchool()));
+    attendees.push_back(who);
     message = "Signed up for Webinar: " + title + " on " + dateAndTime + ". See you there!";
-    return message;
+    return true;
 }
-eventType webinar::getType() { return type_val; }
+eventType webinar::getType() const { return type_val; }
 
 // --- conference Class Method Definitions ---
 conference::conference(eventType ty_enum, string t, string h, string d, string dt_val, string v, int c) // dt_val
@@ -215,17 +286,16 @@ conference::conference(User* user, const string& t, const string& desc, const st
     : event(user, t, desc, date, vp, cap) {
     type_val = Conference;
 }
-string conference::signUp(User* user, string& message) {
-    if (!user) { message = "Error: User details not available for sign up."; return message; }
-    if (attendees.size() >= static_cast<size_t>(capacity)) {
-        message = "Sorry! Capacity is full for Conference: " + title;
-        return message;
+bool conference::signUp(PersonId who, string& message) {
+    if (!tryReserveSeat()) {
+        message = fullMessage();
+        return false;
     }
-    attendees.push_back(new attendee(user->getName(), user->getEmail(), user->getPhoneNumber(), user->getCompanyOrSchool()));
+    attendees.push_back(who);
     message = "Signed up for Conference: " + title + " on " + dateAndTime + ". See you there!";
-    return message;
+    return true;
 }
-eventType conference::getType() { return type_val; }
+eventType conference::getType() const { return type_val; }
 
 // --- workshop Class Method Definitions ---
 workshop::workshop(eventType ty_enum, string t, string h, string d, string dt_val, string v, int c) // dt_val
@@ -235,39 +305,251 @@ workshop::workshop(User* user, const string& t, const string& desc, const string
     : event(user, t, desc, date, vp, cap) {
     type_val = Workshop;
 }
-string workshop::signUp(User* user, string& message) {
-    if (!user) { message = "Error: User details not available for sign up."; return message; }
-    if (attendees.size() >= static_cast<size_t>(capacity)) {
-        message = "Sorry! Capacity is full for Workshop: " + title;
-        return message;
+bool workshop::signUp(PersonId who, string& message) {
+    if (!tryReserveSeat()) {
+        message = fullMessage();
+        return false;
     }
-    attendees.push_back(new attendee(user->getName(), user->getEmail(), user->getPhoneNumber(), user->getCompanyOrSchool()));
+    attendees.push_back(who);
     message = "Signed up for Workshop: " + title + " on " + dateAndTime + ". See you there!";
-    return message;
+    return true;
 }
-eventType workshop::getType() { return type_val; }
+eventType workshop::getType() const { return type_val; }
 
 // --- events Class Method Definitions ---
-events::events() : dataFilePath("/database_eventmgm/EventFile.txt") { 
-    allEvents.clear(); 
+const char* const events::DEFAULT_DATA_FILE = "/database_eventmgm/EventFile.txt";
+
+events::events() : events(DEFAULT_DATA_FILE) {}
+
+events::events(const string& filePath) : events(filePath, DeferLoad()) {
     loadEventsFromFile();
 }
 
+events::events(const string& filePath, DeferLoad) : dataFilePath(filePath) {
+    published.store(new EventSnapshot());
+    if (dataFilePath.empty()) fileLoaded = true; // Nothing to load
+}
+
 events::~events() {
     saveEventsToFile(); 
-    for (auto e : allEvents) {
-        if (e) delete e; // Null check before delete
+    delete published.exchange(nullptr); // Older versions and deleted events go with the reclaimer
+    for (auto& slot : slots) {
+        delete slot.ev;
+        slot.ev = nullptr;
+    }
+    gMetrics.liveEvents.add(-static_cast<int64_t>(liveEventCount));
+    slots.clear();
+    freeSlots.clear();
+    for (const auto& entry : titleIndex) memory_release(MEM_INDEXES, string_heap_bytes(entry.first));
+    titleIndex.clear();
+    timeIndex.clear();
+}
+
+event* events::resolve(EventHandle h) const {
+    if (!h.isValid() || h.index >= slots.size()) return nullptr;
+    const EventSlot& slot = slots[h.index];
+    return slot.generation == h.generation ? slot.ev : nullptr;
+}
+
+EventHandle events::insertSlot(event* e) {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    EventSlot& slot = slots[index];
+    slot.ev = e;
+    slot.type = e->getType();
+    ++liveEventCount;
+    gMetrics.liveEvents.add(1);
+    auto entry = titleIndex.emplace(e->getTitle(), index);
+    memory_add(MEM_INDEXES, string_heap_bytes(entry->first));
+    titlesChanged();
+    return EventHandle{index, slot.generation};
+}
+
+void events::eraseTitle(const string& title, uint32_t index) {
+    auto range = titleIndex.equal_range(title);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == index) {
+            memory_release(MEM_INDEXES, string_heap_bytes(it->first));
+            titleIndex.erase(it);
+            return;
+        }
+    }
+}
+
+void events::titlesChanged() {
+    ++titlesVersion;
+    suggestions.clear(); // Stale now; frees them rather than waiting for the version check
+}
+
+void events::indexSlot(EventHandle h, vector<pair<int64_t, EventHandle>>* timeBatch) {
+    EventSlot& slot = slots[h.index];
+    slot.indexedTime = slot.ev->getStartTime();
+    slot.indexedFreeSeats = slot.ev->getFreeSeats();
+    if (timeBatch) timeBatch->emplace_back(slot.indexedTime, h);
+    else timeIndex.insert(slot.indexedTime, h);
+    availabilityIndex.insert(h, slot.type, slot.indexedFreeSeats);
+    listing.set(h, slot.ev->getTitle(), slot.ev->getHost(), slot.ev->getAttendeeCount(), slot.ev->getcapacity());
+}
+
+EventHandle events::insertEvent(event* e) {
+    EventHandle h = insertSlot(e);
+    {
+        lock_guard<mutex> indexGuard(indexLock);
+        indexSlot(h);
+    }
+    publishSnapshot({h.index});
+    return h;
+}
+
+void events::releaseEvent(EventHandle h) {
+    EventSlot& slot = slots[h.index];
+    {
+        lock_guard<mutex> indexGuard(indexLock);
+        timeIndex.erase(slot.indexedTime, h);
+        availabilityIndex.erase(h, slot.type, slot.indexedFreeSeats);
+        listing.erase(h);
     }
-    allEvents.clear();
+    eraseTitle(slot.ev->getTitle(), h.index);
+    titlesChanged();
+    event* removed = slot.ev;
+    vector<PersonId> attending; // No sign-up can race this: tableLock is exclusive
+    attending.reserve(removed->getAttendees().size());
+    for (PersonId who : removed->getAttendees()) attending.push_back(who);
+    people.removeAttendance(attending, h);
+    slot.ev = nullptr;
+    if (++slot.generation == 0) slot.generation = 1; // Skip the reserved invalid generation on wrap
+    freeSlots.push_back(h.index);
+    --liveEventCount;
+    gMetrics.liveEvents.add(-1);
+    publishSnapshot({h.index});
+    reclaimer.retire([removed] { delete removed; }); // Pinned snapshots may still be reading it
+}
+
+void events::refreshAvailability(EventHandle h) {
+    event* e = resolve(h);
+    if (!e) return;
+    EventSlot& slot = slots[h.index];
+    lock_guard<mutex> indexGuard(indexLock);
+    int freeSeats = e->getFreeSeats(); // Read under indexLock so concurrent refreshes apply in order
+    availabilityIndex.update(h, slot.type, slot.indexedFreeSeats, freeSeats);
+    slot.indexedFreeSeats = freeSeats;
+    listing.setCount(h, e->getAttendeeCount());
+}
+
+shared_ptr<const SnapshotChunk> events::buildChunk(size_t chunkIndex) const {
+    auto chunk = allocate_shared<SnapshotChunk>(TrackedAllocator<SnapshotChunk, MEM_SNAPSHOTS>());
+    size_t first = chunkIndex * SNAPSHOT_CHUNK_SIZE;
+    size_t last = min(slots.size(), first + SNAPSHOT_CHUNK_SIZE);
+    for (size_t i = first; i < last; ++i) {
+        const EventSlot& slot = slots[i];
+        if (!slot.ev) continue;
+        EventRecord& r = chunk->records[i - first];
+        r.handle = EventHandle{static_cast<uint32_t>(i), slot.generation};
+        r.ev = slot.ev;
+        r.title = slot.ev->getTitle();
+        chunk->titleBytes += string_heap_bytes(r.title);
+        r.startTime = slot.ev->getStartTime();
+        r.type = slot.type;
+    }
+    memory_add(MEM_SNAPSHOTS, chunk->titleBytes);
+    return chunk;
+}
+
+void events::publishSnapshot(const vector<uint32_t>& changedSlots) {
+    const EventSnapshot* previous = published.load(memory_order_relaxed); // Only writers (tableLock exclusive) store it
+    EventSnapshot* next = new EventSnapshot();
+    next->version = previous->version + 1;
+    next->liveCount = liveEventCount;
+
+    // Share every unchanged chunk with the previous version; rebuild the rest.
+    size_t chunkCount = (slots.size() + SNAPSHOT_CHUNK_SIZE - 1) / SNAPSHOT_CHUNK_SIZE;
+    size_t shared = min(previous->chunks.size(), chunkCount);
+    next->chunks.reserve(chunkCount);
+    next->chunks.assign(previous->chunks.begin(), previous->chunks.begin() + shared);
+    vector<bool> rebuilt(shared, false);
+    for (uint32_t index : changedSlots) {
+        size_t c = index / SNAPSHOT_CHUNK_SIZE;
+        if (c < shared && !rebuilt[c]) {
+            next->chunks[c] = buildChunk(c);
+            rebuilt[c] = true;
+        }
+    }
+    for (size_t c = shared; c < chunkCount; ++c) next->chunks.push_back(buildChunk(c));
+
+    published.store(next);
+    reclaimer.retire([previous] { delete previous; });
+}
+
+PinnedSnapshot events::snapshot() const {
+    return PinnedSnapshot(reclaimer, published);
+}
+
+event* events::get(EventHandle h) const {
+    shared_lock<shared_mutex> table(tableLock);
+    return resolve(h);
+}
+
+bool events::isLive(EventHandle h) const { return get(h) != nullptr; }
+
+size_t events::size() const {
+    return snapshot()->liveCount;
+}
+
+vector<EventHandle> events::getAllEventHandles() const {
+    PinnedSnapshot snap = snapshot();
+    vector<EventHandle> handles;
+    handles.reserve(snap->liveCount);
+    snap->forEach([&](const EventRecord& r) { handles.push_back(r.handle); });
+    return handles;
+}
+
+string events::getEventTitle(EventHandle h) const {
+    PinnedSnapshot snap = snapshot();
+    const EventRecord* r = snap->find(h);
+    return r ? r->title : string();
+}
+
+string events::getEventSummary(EventHandle h) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    const string* text = listing.text(h);
+    return text ? *text : "(deleted event)";
 }
 
 string events::createEvent(User* user, eventType type_enum, const string& title_val, const string& desc_val, const string& dt_val, const string& vp_val, const string& capStr_val) {
     if (!user) {
         return "Error: User details not available. Cannot create event.";
     }
+    return createEventForHost(user->getName(), type_enum, title_val, desc_val, dt_val, vp_val, capStr_val);
+}
+
+bool fitsDataFile(const string& field) {
+    return field.find_first_of("\n\r|\\") == string::npos;
+}
+
+bool fitsDataFile(const attendee& who) {
+    return fitsDataFile(who.getName()) && fitsDataFile(who.getEmail()) && fitsDataFile(who.getPhoneNum()) && fitsDataFile(who.getcompanyOrSchool());
+}
+
+static const char* const UNSTORABLE_FIELD_ERROR = "Error: Event details cannot contain line breaks, '|' or '\\'.";
+
+string validateEventFields(const string& title_val, const string& desc_val, const string& dt_val, const string& vp_val, const string& capStr_val, int& capacityOut) {
     if (title_val.empty() || desc_val.empty() || dt_val.empty() || vp_val.empty() || capStr_val.empty()) {
         return "Error: All event detail fields must be filled.";
     }
+    if (!fitsDataFile(title_val) || !fitsDataFile(desc_val) || !fitsDataFile(dt_val) || !fitsDataFile(vp_val)) {
+        return UNSTORABLE_FIELD_ERROR;
+    }
+
+    int64_t parsedStart;
+    if (!parseDateTime(dt_val, parsedStart)) {
+        return "Error: Date & Time must be a valid date in DD/MM/YYYY HH:MM format.";
+    }
 
     int capacity_val_int;
     try {
@@ -286,348 +568,1004 @@ string events::createEvent(User* user, eventType type_enum, const string& title_
     } catch (const std::exception& e) { 
         return "Error: Problem parsing capacity. " + string(e.what());
     }
+    capacityOut = capacity_val_int;
+    return "";
+}
 
-    event* newEvent = event::createEvent(type_enum, user, title_val, desc_val, dt_val, vp_val, capacity_val_int);
-    if (newEvent) {
-        allEvents.push_back(newEvent);
-        return "Event '" + title_val + "' created successfully.";
+string events::createEventForHost(const string& host_val, eventType type_enum, const string& title_val, const string& desc_val, const string& dt_val, const string& vp_val, const string& capStr_val) {
+    TracedCall trace(tracer.load());
+    int capacity_val_int = 0;
+    string result = validateEventFields(title_val, desc_val, dt_val, vp_val, capStr_val, capacity_val_int);
+    if (result.empty() && !fitsDataFile(host_val)) result = UNSTORABLE_FIELD_ERROR;
+    bool created = false;
+    if (result.empty()) {
+        event* newEvent = event::createEvent(type_enum, host_val, title_val, desc_val, dt_val, vp_val, capacity_val_int);
+        if (newEvent) {
+            unique_lock<shared_mutex> table(tableLock);
+            insertEvent(newEvent);
+            created = true;
+            gMetrics.eventsCreated.add();
+            result = "Event '" + title_val + "' created successfully.";
+        } else {
+            result = "Error: Could not create event instance after parsing.";
+        }
     }
-    return "Error: Could not create event instance after parsing.";
+    if (trace.active()) trace.finish(TRACE_CREATE, created ? TRACE_OK : TRACE_MISS, {to_string(type_enum), cEncrypt(host_val, SHIFT), title_val, desc_val, dt_val, vp_val, capStr_val});
+    return result;
+}
+
+vector<EventHandle> events::getEventsChronological() const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return timeIndex.all();
+}
+
+vector<EventHandle> events::getEventsBetween(int64_t from, int64_t to) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return timeIndex.range(from, to);
+}
+
+vector<EventHandle> events::getUpcomingEvents(int64_t from, size_t count) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return timeIndex.upcoming(from, count);
+}
+
+vector<EventHandle> events::getEventsPage(size_t offset, size_t limit) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return timeIndex.slice(offset, limit);
+}
+
+uint64_t events::getListingPage(size_t offset, size_t limit, vector<ListingRow>& rows) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    uint64_t version = listing.version(); // Writers bump it under indexLock, so it matches the rows read
+    listing.read(timeIndex.slice(offset, limit), rows);
+    return version;
+}
+
+vector<EventHandle> events::getEventsWithFreeSeats(int minFree, size_t limit) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return availabilityIndex.withFreeSeats(minFree, limit);
+}
+
+vector<EventHandle> events::getOpenEventsOfType(eventType type, int minFree, size_t limit) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return availabilityIndex.withFreeSeats(type, minFree, limit);
+}
+
+vector<EventHandle> events::getMostAvailable(eventType type, size_t count) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return availabilityIndex.withFreeSeats(type, 1, count);
+}
+
+size_t events::getOpenEventCount() const {
+    lock_guard<mutex> indexGuard(indexLock);
+    return availabilityIndex.openCount();
+}
+
+uint64_t events::getOpenListingPage(size_t offset, size_t limit, vector<ListingRow>& rows) const {
+    lock_guard<mutex> indexGuard(indexLock);
+    uint64_t version = listing.version();
+    listing.read(availabilityIndex.openPage(offset, limit), rows);
+    return version;
 }
 
 vector<string> events::getAllEventTitles() const {
     vector<string> titles;
-    if (allEvents.empty()) {
-        titles.push_back("No events created yet.");
-    } else {
-        for (const auto e : allEvents) {
-            if (e) { 
-                 titles.push_back(e->getTitle() + " (Host: " + (e->getHost().empty() ? "N/A" : e->getHost()) + ", Cap: " + to_string(e->getAttendeeCount()) + "/" + to_string(e->getcapacity()) + ")");
-            }
+    {
+        lock_guard<mutex> indexGuard(indexLock);
+        vector<EventHandle> ordered = timeIndex.all();
+        titles.reserve(ordered.size());
+        for (const EventHandle& h : ordered) {
+            if (const string* text = listing.text(h)) titles.push_back(*text);
         }
     }
+    if (titles.empty()) {
+        titles.push_back("No events created yet.");
+    }
     return titles;
 }
 
-string events::attemptDeleteEvent(const string& titleQuery, bool& foundDirectly, bool& foundSuggestion) {
+// Lowest-slot live event titled exactly `title`, via the title index.
+EventHandle events::findExactTitle(const string& title) const {
+    auto range = titleIndex.equal_range(title);
+    uint32_t best = numeric_limits<uint32_t>::max();
+    for (auto it = range.first; it != range.second; ++it) best = min(best, it->second);
+    if (best == numeric_limits<uint32_t>::max()) return EventHandle{};
+    return EventHandle{best, slots[best].generation};
+}
+
+static const int MAX_SUGGESTION_DISTANCE = 5; // "Did you mean" is offered below this edit distance
+
+// --- SuggestionCache Method Definitions ---
+bool SuggestionCache::lookup(const string& query, uint64_t catalogVersion, EventHandle& suggestion) {
+    lock_guard<mutex> guard(lock);
+    auto it = catalogVersion == version ? byQuery.find(query) : byQuery.end();
+    if (it == byQuery.end()) {
+        gMetrics.suggestionCacheMisses.add();
+        return false;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    suggestion = it->second->suggestion;
+    gMetrics.suggestionCacheHits.add();
+    gMetrics.suggestionCacheSavedNs.add(it->second->scanNs);
+    return true;
+}
+
+bool SuggestionCache::holds(const string& query, uint64_t catalogVersion) {
+    lock_guard<mutex> guard(lock);
+    return catalogVersion == version && byQuery.count(query) != 0;
+}
+
+void SuggestionCache::store(const string& query, uint64_t catalogVersion, EventHandle suggestion, uint64_t scanNs) {
+    lock_guard<mutex> guard(lock);
+    if (catalogVersion < version) return; // Scanned titles that have changed since (a SuggestionScan's snapshot)
+    if (catalogVersion != version) {
+        clearLocked();
+        version = catalogVersion;
+    }
+    if (byQuery.count(query)) return; // Another reader scanned it meanwhile: same answer
+    if (lru.size() >= CAPACITY) {
+        const Entry& oldest = lru.back();
+        byQuery.erase(oldest.query);
+        memory_release(MEM_INDEXES, string_heap_bytes(oldest.query));
+        lru.pop_back();
+    }
+    lru.push_front(Entry{query, suggestion, scanNs});
+    memory_add(MEM_INDEXES, string_heap_bytes(lru.front().query));
+    byQuery.emplace(lru.front().query, lru.begin());
+}
+
+void SuggestionCache::clear() {
+    lock_guard<mutex> guard(lock);
+    clearLocked();
+}
+
+void SuggestionCache::clearLocked() {
+    if (lru.empty()) return;
+    for (const Entry& e : lru) memory_release(MEM_INDEXES, string_heap_bytes(e.query));
+    byQuery.clear();
+    lru.clear();
+}
+
+// --- TitleMatcher Method Definitions ---
+void TitleMatcher::consider(const string& title, EventHandle h) {
+    // The distance is at least the length gap: skip titles that could neither beat
+    // the best so far nor be close enough to offer.
+    size_t gap = max(query.size(), title.size()) - min(query.size(), title.size());
+    if (gap >= static_cast<size_t>(min(minDist, MAX_SUGGESTION_DISTANCE))) {
+        ++pruned;
+        return;
+    }
+    ++compared;
+    int prevDist = minDist;
+    updateBestMatch(query, title, best, minDist);
+    if (minDist < prevDist) {
+        bestHandle = h;
+    }
+}
+
+EventHandle TitleMatcher::suggestion() const {
+    if (!bestHandle.isValid() || best.empty() || minDist >= MAX_SUGGESTION_DISTANCE ||
+        static_cast<size_t>(minDist) > best.length() / 2) {
+        return EventHandle{};
+    }
+    return bestHandle;
+}
+
+// Returns the handle of the event titled exactly `titleQuery`, or an invalid handle.
+// On a miss, `bestSuggestion` is set to the closest title if it is near enough to offer.
+EventHandle events::findByTitle(const string& titleQuery, EventHandle& bestSuggestion) const {
+    bestSuggestion = EventHandle{};
+    EventHandle exact = findExactTitle(titleQuery);
+    if (exact.isValid()) return exact; // Only a miss needs the fuzzy scan
+    if (suggestions.lookup(titleQuery, titlesVersion, bestSuggestion)) return EventHandle{}; // Retried query, or no title changed since
+
+    uint64_t scanStart = metrics_now_ns();
+    TitleMatcher matcher(titleQuery);
+    for (uint32_t i = 0; i < slots.size(); ++i) {
+        const event* e = slots[i].ev;
+        if (!e) continue;
+        matcher.consider(e->getTitle(), EventHandle{i, slots[i].generation});
+    }
+    if (matcher.compared) gMetrics.levenshteinCalls.add(matcher.compared);
+    if (matcher.pruned) gMetrics.candidatesPruned.add(matcher.pruned);
+    bestSuggestion = matcher.suggestion();
+    suggestions.store(titleQuery, titlesVersion, bestSuggestion, metrics_now_ns() - scanStart);
+    return EventHandle{};
+}
+
+bool events::answersTitleWithoutScan(const string& titleQuery) const {
+    shared_lock<shared_mutex> table(tableLock);
+    return findExactTitle(titleQuery).isValid() || suggestions.holds(titleQuery, titlesVersion);
+}
+
+PinnedSnapshot events::snapshotWithTitlesVersion(uint64_t& version) const {
+    shared_lock<shared_mutex> table(tableLock); // Titles change and publish under the exclusive lock
+    version = titlesVersion;
+    return snapshot();
+}
+
+// --- SuggestionScan Method Definitions ---
+SuggestionScan::SuggestionScan(const events& m, const string& title)
+    : manager(m), snap(m.snapshotWithTitlesVersion(titlesVersion)), matcher(title) {}
+
+bool SuggestionScan::step(size_t maxSlots) {
+    if (finished) return true;
+    uint64_t stepStart = metrics_now_ns();
+    uint64_t compared = matcher.compared, pruned = matcher.pruned;
+    finished = snap->forEachFrom(position, maxSlots, [&](const EventRecord& r) { matcher.consider(r.title, r.handle); });
+    if (matcher.compared != compared) gMetrics.levenshteinCalls.add(matcher.compared - compared);
+    if (matcher.pruned != pruned) gMetrics.candidatesPruned.add(matcher.pruned - pruned);
+    scanNs += metrics_now_ns() - stepStart;
+    if (finished) manager.suggestions.store(matcher.query, titlesVersion, matcher.suggestion(), scanNs);
+    return finished;
+}
+
+// How a delete or sign-up by title ended, for the trace.
+static TraceOutcome titleCallOutcome(bool foundDirectly, bool foundSuggestion, bool done) {
+    if (foundDirectly) return done ? TRACE_OK : TRACE_REFUSED;
+    return foundSuggestion ? TRACE_SUGGESTED : TRACE_MISS;
+}
+
+string events::attemptDeleteEvent(const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, EventHandle& suggestion) {
+    TracedCall trace(tracer.load());
     foundDirectly = false;
     foundSuggestion = false;
-    string localSuggestedMatch = ""; 
-    int minDist = numeric_limits<int>::max();
-
-    for (size_t i = 0; i < allEvents.size(); ++i) {
-        if (allEvents[i] && allEvents[i]->getTitle() == titleQuery) {
-            string deletedTitle = allEvents[i]->getTitle();
-            delete allEvents[i];
-            allEvents.erase(allEvents.begin() + i);
-            foundDirectly = true;
-            return "Deleted event '" + deletedTitle + "' successfully.";
-        }
-        if(allEvents[i]) { 
-            updateBestMatch(titleQuery, allEvents[i]->getTitle(), localSuggestedMatch, minDist);
-        }
+    suggestion = EventHandle{};
+
+    EventHandle match;
+    string suggestedTitle;
+    {
+        shared_lock<shared_mutex> table(tableLock);
+        match = findByTitle(titleQuery, suggestion);
+        if (suggestion.isValid()) suggestedTitle = resolve(suggestion)->getTitle();
     }
-    
-    if (!localSuggestedMatch.empty() && minDist < 5 && levenshteinDistance(titleQuery, localSuggestedMatch) <= (localSuggestedMatch.length() / 2) ) {
-        suggestedMatch = localSuggestedMatch; 
+    string result;
+    if (match.isValid()) {
+        foundDirectly = true;
+        result = removeEvent(match); // Re-checks the handle under the exclusive lock
+    } else if (suggestion.isValid()) {
         foundSuggestion = true;
-        return "Event '" + titleQuery + "' not found. Did you mean '" + suggestedMatch + "'?";
+        result = "Event '" + titleQuery + "' not found. Did you mean '" + suggestedTitle + "'?";
+    } else {
+        result = "Event '" + titleQuery + "' not found.";
     }
-    return "Event '" + titleQuery + "' not found.";
+    if (trace.active()) trace.finish(TRACE_DELETE, titleCallOutcome(foundDirectly, foundSuggestion, result.rfind("Deleted", 0) == 0), {titleQuery});
+    return result;
 }
 
-string events::confirmDeleteSuggestedEvent() {
-    if (suggestedMatch.empty()) {
+string events::deleteEvent(EventHandle h) {
+    OpTraceRecorder* recorder = tracer.load();
+    if (!recorder) return removeEvent(h);
+    string title = getEventTitle(h); // Replayed as a delete by exact title
+    TracedCall trace(recorder);
+    string result = removeEvent(h);
+    trace.finish(TRACE_DELETE, result.rfind("Deleted", 0) == 0 ? TRACE_OK : TRACE_REFUSED, {title});
+    return result;
+}
+
+string events::removeEvent(EventHandle h) {
+    unique_lock<shared_mutex> table(tableLock);
+    event* e = resolve(h);
+    if (!e) {
+        return "Error: That event no longer exists.";
+    }
+    string deletedTitle = e->getTitle();
+    releaseEvent(h);
+    gMetrics.eventsDeleted.add();
+    return "Deleted event '" + deletedTitle + "' successfully.";
+}
+
+string events::editEvent(EventHandle h, EventField field, const string& value) {
+    unique_lock<shared_mutex> table(tableLock); // Exclusive: no sign-up is appending to the original meanwhile
+    event* original = resolve(h);
+    if (!original) {
+        return "Error: That event no longer exists.";
+    }
+    string title = original->getTitle(), host = original->getHost(), desc = original->getDescription();
+    string dt = original->getdateAndTime(), vp = original->getvPlatform(), capStr = to_string(original->getcapacity());
+    switch (field) {
+        case FIELD_TITLE: title = value; break;
+        case FIELD_HOST: host = value; break;
+        case FIELD_DESCRIPTION: desc = value; break;
+        case FIELD_DATE_TIME: dt = value; break;
+        case FIELD_PLATFORM: vp = value; break;
+        case FIELD_CAPACITY: capStr = value; break;
+    }
+    int capacity = 0;
+    string error = validateEventFields(title, desc, dt, vp, capStr, capacity);
+    if (!error.empty()) return error;
+    if (!fitsDataFile(host)) return UNSTORABLE_FIELD_ERROR;
+    if (capacity < original->getAttendeeCount()) {
+        return "Error: Capacity cannot be below the " + to_string(original->getAttendeeCount()) + " seats already taken.";
+    }
+
+    EventSlot& slot = slots[h.index];
+    event* edited = event::createEvent(slot.type, host, title, desc, dt, vp, capacity);
+    if (!edited) return "Error: Could not create event instance after parsing.";
+    edited->reserveAttendees(original->getAttendees().size());
+    for (PersonId who : original->getAttendees()) edited->addAttendee(who); // Same handle: attendance stays as it is
+
+    if (title != original->getTitle()) {
+        eraseTitle(original->getTitle(), h.index);
+        auto entry = titleIndex.emplace(title, h.index);
+        memory_add(MEM_INDEXES, string_heap_bytes(entry->first));
+        titlesChanged();
+    }
+    slot.ev = edited;
+    {
+        lock_guard<mutex> indexGuard(indexLock);
+        if (edited->getStartTime() != slot.indexedTime) {
+            timeIndex.erase(slot.indexedTime, h);
+            slot.indexedTime = edited->getStartTime();
+            timeIndex.insert(slot.indexedTime, h);
+        }
+        int freeSeats = edited->getFreeSeats();
+        availabilityIndex.update(h, slot.type, slot.indexedFreeSeats, freeSeats);
+        slot.indexedFreeSeats = freeSeats;
+        listing.set(h, title, host, edited->getAttendeeCount(), capacity); // No new version unless the row's text changed
+    }
+    publishSnapshot({h.index});
+    reclaimer.retire([original] { delete original; }); // Pinned snapshots may still be reading it
+    return "Updated event '" + title + "'.";
+}
+
+string events::confirmDeleteSuggestedEvent(EventHandle suggestion) {
+    if (!suggestion.isValid()) {
         return "Error: No suggested event to delete.";
     }
-    bool fd, fs; 
-    string result = attemptDeleteEvent(suggestedMatch, fd, fs);
+    return deleteEvent(suggestion);
+}
+
+// Caller holds tableLock (shared is enough): the seat is reserved atomically inside
+// signUp, and only the attendee list append needs the event's shard lock.
+bool events::signUpLocked(User* user, const attendee* who, EventHandle h, string& signUpMessage) {
+    event* e = resolve(h);
+    if (!e) {
+        signUpMessage = "Error: That event no longer exists.";
+        return false;
+    }
+    if (!who && !user) {
+        signUpMessage = "Error: User details not available for sign up.";
+        return false;
+    }
+    bool storable = who ? fitsDataFile(*who)
+                        : fitsDataFile(user->getName()) && fitsDataFile(user->getEmail()) &&
+                          fitsDataFile(user->getPhoneNumber()) && fitsDataFile(user->getCompanyOrSchool());
+    if (!storable) {
+        signUpMessage = "Error: Attendee details cannot contain line breaks, '|' or '\\'.";
+        return false;
+    }
+    if (e->isFull()) { // Checked first, as importBatch does, so a refused person is never interned
+        signUpMessage = e->fullMessage();
+        gMetrics.signUpsRefused.add();
+        return false;
+    }
+    // Interned outside the shard lock. Losing the last seat to a concurrent
+    // sign-up after the check above is the one way a refused person stays.
+    PersonId person = who ? people.intern(*who)
+                          : people.intern(attendee(user->getName(), user->getEmail(), user->getPhoneNumber(), user->getCompanyOrSchool()));
+    bool signedUp;
+    {
+        unique_lock<shared_mutex> shard(shardFor(h));
+        signedUp = e->signUp(person, signUpMessage);
+    }
+    if (signedUp) {
+        gMetrics.signUps.add();
+        people.addAttendance(person, h);
+        refreshAvailability(h);
+    } else {
+        gMetrics.signUpsRefused.add();
+    }
+    return signedUp;
+}
+
+string events::attemptSignUp(User* user, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage, EventHandle& suggestion) {
+    bool signedUp;
+    return attemptSignUp(user, titleQuery, foundDirectly, foundSuggestion, signUpMessage, suggestion, signedUp);
+}
+
+string events::attemptSignUp(User* user, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage, EventHandle& suggestion, bool& signedUp) {
+    TracedCall trace(tracer.load());
+    signedUp = false;
+    string result = attemptSignUpImpl(user, nullptr, titleQuery, foundDirectly, foundSuggestion, signUpMessage, suggestion, signedUp);
+    if (trace.active() && user) {
+        trace.finish(TRACE_SIGN_UP, titleCallOutcome(foundDirectly, foundSuggestion, signedUp),
+                     {titleQuery, cEncrypt(user->getName(), SHIFT), cEncrypt(user->getEmail(), SHIFT), cEncrypt(user->getPhoneNumber(), SHIFT), cEncrypt(user->getCompanyOrSchool(), SHIFT)});
+    }
     return result;
 }
 
-string events::attemptSignUp(User* user, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage) {
-    if (!user) {
-        signUpMessage = "Error: User not signed in. Cannot sign up.";
-        return signUpMessage;
+string events::attemptSignUpAs(const attendee& who, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage, EventHandle& suggestion) {
+    bool signedUp;
+    return attemptSignUpAs(who, titleQuery, foundDirectly, foundSuggestion, signUpMessage, suggestion, signedUp);
+}
+
+string events::attemptSignUpAs(const attendee& who, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage, EventHandle& suggestion, bool& signedUp) {
+    TracedCall trace(tracer.load());
+    signedUp = false;
+    string result = attemptSignUpImpl(nullptr, &who, titleQuery, foundDirectly, foundSuggestion, signUpMessage, suggestion, signedUp);
+    if (trace.active()) {
+        trace.finish(TRACE_SIGN_UP, titleCallOutcome(foundDirectly, foundSuggestion, signedUp),
+                     {titleQuery, cEncrypt(who.getName(), SHIFT), cEncrypt(who.getEmail(), SHIFT), cEncrypt(who.getPhoneNum(), SHIFT), cEncrypt(who.getcompanyOrSchool(), SHIFT)});
     }
+    return result;
+}
+
+string events::attemptSignUpImpl(User* user, const attendee* who, const string& titleQuery, bool& foundDirectly, bool& foundSuggestion, string& signUpMessage, EventHandle& suggestion, bool& signedUp) {
     foundDirectly = false;
     foundSuggestion = false;
+    suggestion = EventHandle{};
+    signedUp = false;
+    if (!user && !who) {
+        signUpMessage = "Error: User not signed in. Cannot sign up.";
+        return signUpMessage;
+    }
     signUpMessage = ""; // Clear previous message
-    string localSuggestedMatch = "";
-    int minDist = numeric_limits<int>::max();
 
-    for (auto e : allEvents) {
-        if (e && e->getTitle() == titleQuery) {
-            // signUpMessage is populated by the event's signUp method
-            return e->signUp(user, signUpMessage); 
-        }
-        if(e) {
-            updateBestMatch(titleQuery, e->getTitle(), localSuggestedMatch, minDist);
-        }
+    ScopedLatency latency(gMetrics.signUpLatency);
+    shared_lock<shared_mutex> table(tableLock);
+    EventHandle match = findByTitle(titleQuery, suggestion);
+    if (match.isValid()) {
+        foundDirectly = true;
+        signedUp = signUpLocked(user, who, match, signUpMessage);
+        return signUpMessage;
     }
-    
-    if (!localSuggestedMatch.empty() && minDist < 5 && levenshteinDistance(titleQuery, localSuggestedMatch) <= (localSuggestedMatch.length() / 2)) {
-        suggestedMatch = localSuggestedMatch; 
+    gMetrics.signUpsNotFound.add();
+    if (suggestion.isValid()) {
         foundSuggestion = true;
-        signUpMessage = "Event '" + titleQuery + "' not found. Did you mean '" + suggestedMatch + "'?";
+        signUpMessage = "Event '" + titleQuery + "' not found. Did you mean '" + resolve(suggestion)->getTitle() + "'?";
         return signUpMessage;
     }
     signUpMessage = "Event '" + titleQuery + "' not found for sign up.";
     return signUpMessage;
 }
 
-string events::confirmSignUpSuggestedEvent(User* user, string& signUpMessage) {
+string events::confirmSignUpSuggestedEvent(User* user, EventHandle suggestion, string& signUpMessage) {
     if (!user) {
         signUpMessage = "Error: User not signed in for confirmation.";
         return signUpMessage;
     }
-    if (suggestedMatch.empty()) {
+    if (!suggestion.isValid()) {
         signUpMessage = "Error: No suggested event to sign up for.";
         return signUpMessage;
     }
-    bool fd, fs; 
-    // signUpMessage will be populated by attemptSignUp
-    return attemptSignUp(user, suggestedMatch, fd, fs, signUpMessage);
+    OpTraceRecorder* recorder = tracer.load();
+    string title = recorder ? getEventTitle(suggestion) : string(); // Replayed as a sign-up by exact title
+    TracedCall trace(recorder);
+    bool signedUp;
+    {
+        ScopedLatency latency(gMetrics.signUpLatency);
+        shared_lock<shared_mutex> table(tableLock);
+        signedUp = signUpLocked(user, nullptr, suggestion, signUpMessage);
+    }
+    if (trace.active()) {
+        trace.finish(TRACE_SIGN_UP, signedUp ? TRACE_OK : TRACE_REFUSED,
+                     {title, cEncrypt(user->getName(), SHIFT), cEncrypt(user->getEmail(), SHIFT), cEncrypt(user->getPhoneNumber(), SHIFT), cEncrypt(user->getCompanyOrSchool(), SHIFT)});
+    }
+    return signUpMessage;
+}
+
+vector<EventHandle> events::getEventsAttendedBy(const string& email) const {
+    PersonId person = people.find(email);
+    if (person == PersonTable::NO_PERSON) return {};
+    return people.attendanceOf(person); // Deleted events were taken off as they went
+}
+
+vector<EventHandle> events::searchEvents(const string& query) const {
+    EventSearch search(*this, query); // Scans a pinned snapshot: never blocks creates and deletes
+    while (!search.step(numeric_limits<size_t>::max())) {}
+    return search.takeResults();
 }
 
-vector<string> events::searchEvents(const string& query) {
-    vector<string> results;
-    if (query.empty()) {
-        return getAllEventTitles(); 
+void events::importBatch(ImportBatch& batch, size_t& attendeesAdded, vector<size_t>& rejectedAttendees) {
+    attendeesAdded = 0;
+    unique_lock<shared_mutex> table(tableLock); // Exclusive: no sign-up can race the direct appends below
+
+    size_t needed = liveEventCount + batch.newEvents.size();
+    if (needed > slots.size()) slots.reserve(needed);
+    titleIndex.reserve(needed);
+
+    vector<EventHandle> added;
+    added.reserve(batch.newEvents.size());
+    for (event* e : batch.newEvents) {
+        if (e) added.push_back(insertSlot(e));
     }
-    if (allEvents.empty()) {
-        results.push_back("No events available to search.");
-        return results;
+    batch.newEvents.clear(); // Owned by the table now
+
+    // Resolve every attendee's event once, then size each attendee list before appending.
+    vector<EventHandle> targets(batch.attendees.size());
+    unordered_map<uint32_t, size_t> perEvent;
+    for (size_t i = 0; i < batch.attendees.size(); ++i) {
+        targets[i] = findExactTitle(batch.attendees[i].first);
+        if (targets[i].isValid()) ++perEvent[targets[i].index];
     }
-    for (auto e : allEvents) {
-        if (e) { 
-            addIfAccurateEnough(results, query, e->getTitle());
+    for (const auto& entry : perEvent) slots[entry.first].ev->reserveAttendees(entry.second);
+    people.reserve(batch.attendees.size());
+
+    vector<pair<PersonId, EventHandle>> attendance;
+    attendance.reserve(batch.attendees.size());
+    for (size_t i = 0; i < batch.attendees.size(); ++i) {
+        event* e = resolve(targets[i]);
+        if (!e || e->isFull()) { // Checked first so rejected rows are never interned
+            rejectedAttendees.push_back(i);
+            continue;
+        }
+        PersonId person = people.intern(move(batch.attendees[i].second)); // The batch is cleared below
+        if (e->tryAddAttendee(person)) {
+            attendance.emplace_back(person, targets[i]);
+            ++attendeesAdded;
+        } else {
+            rejectedAttendees.push_back(i);
         }
     }
-    if (results.empty()) {
-        results.push_back("No events found matching '" + query + "'.");
+    batch.attendees.clear();
+    people.addAttendances(attendance);
+
+    vector<uint32_t> addedSlots;
+    addedSlots.reserve(added.size());
+    {
+        lock_guard<mutex> indexGuard(indexLock);
+        vector<pair<int64_t, EventHandle>> timeEntries;
+        timeEntries.reserve(added.size());
+        for (const EventHandle& h : added) {
+            EventSlot& slot = slots[h.index];
+            slot.indexedTime = slot.ev->getStartTime();
+            slot.indexedFreeSeats = slot.ev->getFreeSeats(); // Final count: this batch's attendees are already in
+            availabilityIndex.insert(h, slot.type, slot.indexedFreeSeats);
+            listing.set(h, slot.ev->getTitle(), slot.ev->getHost(), slot.ev->getAttendeeCount(), slot.ev->getcapacity());
+            timeEntries.emplace_back(slot.indexedTime, h);
+            addedSlots.push_back(h.index);
+        }
+        timeIndex.insertBatch(timeEntries); // One merge for the whole batch
+        for (const auto& entry : perEvent) {
+            EventHandle h{entry.first, slots[entry.first].generation};
+            EventSlot& slot = slots[entry.first]; // No-op for events added above
+            int freeSeats = slot.ev->getFreeSeats();
+            availabilityIndex.update(h, slot.type, slot.indexedFreeSeats, freeSeats);
+            slot.indexedFreeSeats = freeSeats;
+            listing.setCount(h, slot.ev->getAttendeeCount());
+        }
     }
-    return results;
+    if (!addedSlots.empty()) publishSnapshot(addedSlots); // One new version for the whole batch
+}
+
+void events::visitEvents(const function<void(EventHandle, const event&)>& fn) const {
+    PinnedSnapshot snap = snapshot();
+    snap->forEach([&](const EventRecord& r) { fn(r.handle, *r.ev); });
 }
 
 bool events::saveEventsToFile() {
-    ofstream eventFile(dataFilePath, ios::trunc);
-    if (!eventFile.is_open()) {
-        cerr << "Error: Could not open " << dataFilePath << " for writing." << endl;
-        return false;
+    EventFileWriter writer(*this);
+    while (!writer.step(numeric_limits<size_t>::max())) {}
+    return writer.succeeded();
+}
+
+// --- Data file ---
+// Lines of the data file (every text field encrypted with cEncrypt):
+//   #format 2                              First line; files without it are format 1
+//   @name|email|phone|company              A person, numbered 0, 1, ... in file order
+//   type|title|host|description|dateAndTime|platform|capacity
+//   count;person;person;...                The previous event's attendees, by person number
+// A person line comes before the first attendee line that refers to it, so
+// each person is written once however many events they attend. Format 1 files
+// have no person lines; their attendee lines hold each attendee's details
+// ("count;name,email,phone,company;..."), and are folded into the person table
+// as they load.
+const int DATA_FILE_FORMAT = 2;
+
+namespace {
+
+// Parses an event line; logs and returns nullptr if it is malformed.
+event* parseEventLine(const string& eventLine, int lineNumber) {
+    stringstream s_event(eventLine);
+    string typeStr_load, title_load, host_load, description_load, dateAndTime_load, vPlatform_load, capStr_load;
+    char del = '|';
+
+    getline(s_event, typeStr_load, del);
+    getline(s_event, title_load, del);
+    getline(s_event, host_load, del);
+    getline(s_event, description_load, del);
+    getline(s_event, dateAndTime_load, del);
+    getline(s_event, vPlatform_load, del);
+    getline(s_event, capStr_load); 
+
+    if (s_event.fail() && !s_event.eof()){ 
+         cerr << "Warn: Stream error reading event line " << lineNumber << ": " << eventLine << ". Skipping." << endl;
+         return nullptr;
+    }
+    
+    if (typeStr_load.empty() || title_load.empty() || host_load.empty() || 
+        description_load.empty() || dateAndTime_load.empty() || vPlatform_load.empty() || capStr_load.empty()) {
+        if (!(typeStr_load.empty() && title_load.empty() && capStr_load.empty())) { 
+             cerr << "Warn: Malformed event line " << lineNumber << " (missing fields): " << eventLine << ". Skipping." << endl;
+        }
+        return nullptr;
+    }
+    
+    int capacity_load;
+    try {
+        size_t processed_chars = 0;
+        capacity_load = stoi(capStr_load, &processed_chars);
+        if(processed_chars != capStr_load.length() || capStr_load.find_first_not_of("0123456789") != string::npos) {
+            throw std::invalid_argument("Capacity contains non-digit characters or extra data.");
+        }
+    } catch (const std::exception& e) {
+        cerr << "Warn: Invalid capacity '" << capStr_load << "' in event line " << lineNumber << ": " << eventLine << ". Details: " << e.what() << ". Skipping." << endl;
+        return nullptr;
+    }
+
+    title_load = cDecrypt(title_load, SHIFT);
+    host_load = cDecrypt(host_load, SHIFT);
+    description_load = cDecrypt(description_load, SHIFT);
+    dateAndTime_load = cDecrypt(dateAndTime_load, SHIFT);
+    vPlatform_load = cDecrypt(vPlatform_load, SHIFT);
+
+    eventType type_enum_load;
+    if (typeStr_load == "0") type_enum_load = Webinar;
+    else if (typeStr_load == "1") type_enum_load = Conference;
+    else if (typeStr_load == "2") type_enum_load = Workshop;
+    else {
+        cerr << "Warn: Unknown event type '" << typeStr_load << "' in event line " << lineNumber << ": " << eventLine << ". Skipping." << endl;
+        return nullptr;
+    }
+    
+    event* ev = event::createEvent(type_enum_load, host_load, title_load, description_load, dateAndTime_load, vPlatform_load, capacity_load);
+    if (!ev) {
+        cerr << "Error creating event object from event line " << lineNumber << ": " << eventLine << endl;
     }
-    for (const auto e : allEvents) {
-        if (e) { 
-            eventFile << to_string(e->getType()) << '|'
-                      << cEncrypt(e->getTitle(), SHIFT) << '|'
-                      << cEncrypt(e->getHost(), SHIFT) << '|'
-                      << cEncrypt(e->getDescription(), SHIFT) << '|'
-                      << cEncrypt(e->getdateAndTime(), SHIFT) << '|'
-                      << cEncrypt(e->getvPlatform(), SHIFT) << '|'
-                      << to_string(e->getcapacity()) << "\n"; // End of event main line
+    return ev;
+}
+
+// Parses a person line ("@name|email|phone|company").
+attendee parsePersonLine(const string& line) {
+    stringstream s_person(line.substr(1));
+    string name_att, email_att, phone_att, company_att;
+    getline(s_person, name_att, '|');
+    getline(s_person, email_att, '|');
+    getline(s_person, phone_att, '|');
+    getline(s_person, company_att);
+    return attendee(cDecrypt(name_att, SHIFT), cDecrypt(email_att, SHIFT), cDecrypt(phone_att, SHIFT), cDecrypt(company_att, SHIFT));
+}
+
+// Parses a format 1 attendee line, adding each attendee to `people` and their
+// id to `attending`.
+void parseLegacyAttendees(const string& attendeeDataLine, const string& title_load, int lineNumber, PersonTable& people, vector<PersonId>& attending) {
+    stringstream s_attendees(attendeeDataLine);
+    string numAttendeesStr;
+    getline(s_attendees, numAttendeesStr, ';'); // Get number of attendees
+    try {
+        int numAttendees = 0;
+        if (!numAttendeesStr.empty()) {
+             numAttendees = stoi(numAttendeesStr);
+        }
+
+        for (int i = 0; i < numAttendees; ++i) {
+            string singleAttendeeData;
+            if (!getline(s_attendees, singleAttendeeData, ';')) {
+                cerr << "Warn: Could not read expected attendee data block " << (i+1) << " for event '" << title_load << "' on line " << lineNumber << endl;
+                break; 
+            }
             
-            const auto& eventAttendees = e->getAttendees();
-            if (!eventAttendees.empty()) {
-                eventFile << eventAttendees.size(); // Number of attendees
-                for (const auto att : eventAttendees) {
-                    if (att) {
-                        eventFile << ";" // Separator before each attendee block
-                                  << cEncrypt(att->getName(), SHIFT) << ","
-                                  << cEncrypt(att->getEmail(), SHIFT) << ","
-                                  << cEncrypt(att->getPhoneNum(), SHIFT) << ","
-                                  << cEncrypt(att->getcompanyOrSchool(), SHIFT);
-                    }
-                }
-                eventFile << "\n"; // Newline after all attendees for this event
+            stringstream s_single_attendee(singleAttendeeData);
+            string name_att, email_att, phone_att, company_att;
+            char comma_del = ',';
+
+            getline(s_single_attendee, name_att, comma_del);
+            getline(s_single_attendee, email_att, comma_del);
+            getline(s_single_attendee, phone_att, comma_del);
+            getline(s_single_attendee, company_att); // Read rest for company
+
+            if (name_att.empty() && email_att.empty() && phone_att.empty() && company_att.empty() && s_single_attendee.eof() && !s_single_attendee.fail()){
+                // Potentially an empty attendee string from an extra semicolon, skip it
+                continue;
             }
+            if (s_single_attendee.fail() && !s_single_attendee.eof()){
+                 cerr << "Warn: Stream error reading attendee details for event '" << title_load << "' on line " << lineNumber << endl;
+                 continue;
+            }
+
+            attending.push_back(people.intern(attendee(cDecrypt(name_att, SHIFT), cDecrypt(email_att, SHIFT),
+                                                       cDecrypt(phone_att, SHIFT), cDecrypt(company_att, SHIFT))));
         }
+    } catch (const std::exception& e) {
+        cerr << "Warn: Error parsing attendee count or data for event '" << title_load << "' on line " << lineNumber << ". Details: " << e.what() << endl;
     }
-    eventFile.close();
-    cout << "Saved " << allEvents.size() << " events to " << dataFilePath << endl;
-    #ifdef __EMSCRIPTEN__
-    EM_ASM({ 
-        if (typeof FS !== 'undefined' && FS.syncfs) {
-            FS.syncfs(false, function(err) { 
-                if (err) {
-                    console.error("FS.syncfs error during save for " + UTF8ToString($0) + ": ", err);
-                } else {
-                    console.log("FS.syncfs save complete for " + UTF8ToString($0));
-                }
-            });
-        } else {
-            console.warn("FS.syncfs not available for saveEventsToFile.");
+}
+
+// Parses a format 2 attendee line ("count;person;person;..."), mapping file
+// person numbers to ids through filePeople.
+void parseAttendeeNumbers(const string& attendeeDataLine, const string& title_load, int lineNumber, const vector<PersonId>& filePeople, vector<PersonId>& attending) {
+    stringstream s_attendees(attendeeDataLine);
+    string field;
+    getline(s_attendees, field, ';'); // Count: the numbers that follow are authoritative
+    while (getline(s_attendees, field, ';')) {
+        if (field.empty()) continue;
+        char* end = nullptr;
+        unsigned long number = strtoul(field.c_str(), &end, 10);
+        if (*end != '\0' || number >= filePeople.size()) {
+            cerr << "Warn: Unknown person '" << field << "' in the attendees of '" << title_load << "' on line " << lineNumber << endl;
+            continue;
         }
-    }, dataFilePath.c_str()); 
-    #endif
-    return true;
+        attending.push_back(filePeople[number]);
+    }
 }
 
+} // namespace
+
 void events::loadEventsFromFile() {
-    ifstream eventFile(dataFilePath);
-    if (!eventFile.is_open()) {
-        cout << "Info: " << dataFilePath << " not found or could not be opened. Starting with no events." << endl;
+    EventFileLoader loader(*this);
+    while (!loader.step(numeric_limits<size_t>::max())) {}
+}
+
+// --- EventFileLoader Method Definitions ---
+EventFileLoader::EventFileLoader(events& m) : manager(m) {
+    if (manager.dataFilePath.empty()) { // In-memory manager
+        finished = true;
         return;
     }
-    string eventLine;
-    int lineNumber = 0;
-    while (getline(eventFile, eventLine)) {
-        lineNumber++;
-        if (eventLine.empty() || eventLine.find_first_not_of(" \t\n\v\f\r") == string::npos) {
-            continue; 
-        }
+    unique_lock<shared_mutex> table(manager.tableLock);
+    if (manager.fileLoaded || manager.fileLoading) { // Read already, or being read by another loader
+        finished = true;
+        return;
+    }
+    file.open(manager.dataFilePath);
+    if (!file.is_open()) {
+        cout << "Info: " << manager.dataFilePath << " not found or could not be opened. Starting with no events." << endl;
+        manager.fileLoaded = true;
+        finished = true;
+        return;
+    }
+    manager.fileLoading = true;
+    file.seekg(0, ios::end);
+    fileBytes = file.tellg();
+    file.seekg(0, ios::beg);
+}
+
+EventFileLoader::~EventFileLoader() {
+    delete pending; // Abandoned part-way: the events filed so far stay, and saving stays refused
+}
 
-        stringstream s_event(eventLine);
-        string typeStr_load, title_load, host_load, description_load, dateAndTime_load, vPlatform_load, capStr_load;
-        char del = '|';
-
-        getline(s_event, typeStr_load, del);
-        getline(s_event, title_load, del);
-        getline(s_event, host_load, del);
-        getline(s_event, description_load, del);
-        getline(s_event, dateAndTime_load, del);
-        getline(s_event, vPlatform_load, del);
-        getline(s_event, capStr_load); 
-
-        if (s_event.fail() && !s_event.eof()){ 
-             cerr << "Warn: Stream error reading event line " << lineNumber << ": " << eventLine << ". Skipping." << endl;
-             continue;
+bool EventFileLoader::step(size_t maxLines) {
+    if (finished) return true;
+    uint64_t stepStart = metrics_now_ns();
+    {
+        unique_lock<shared_mutex> table(manager.tableLock);
+        bool more = true;
+        for (size_t read = 0; read < maxLines && (more = static_cast<bool>(getline(file, line))); ++read) {
+            readLine();
         }
-        
-        if (typeStr_load.empty() || title_load.empty() || host_load.empty() || 
-            description_load.empty() || dateAndTime_load.empty() || vPlatform_load.empty() || capStr_load.empty()) {
-            if (!(typeStr_load.empty() && title_load.empty() && capStr_load.empty())) { 
-                 cerr << "Warn: Malformed event line " << lineNumber << " (missing fields): " << eventLine << ". Skipping." << endl;
-            }
-            continue;
+        if (more) { // Merged once the whole file is in
+            lock_guard<mutex> indexGuard(manager.indexLock);
+            manager.timeIndex.insertDeferred(timeEntries);
+            timeEntries.clear();
+        } else {
+            finish();
         }
-        
-        int capacity_load;
-        try {
-            size_t processed_chars = 0;
-            capacity_load = stoi(capStr_load, &processed_chars);
-            if(processed_chars != capStr_load.length() || capStr_load.find_first_not_of("0123456789") != string::npos) {
-                throw std::invalid_argument("Capacity contains non-digit characters or extra data.");
-            }
-        } catch (const std::exception& e) {
-            cerr << "Warn: Invalid capacity '" << capStr_load << "' in event line " << lineNumber << ": " << eventLine << ". Details: " << e.what() << ". Skipping." << endl;
-            continue;
+    }
+    stepNs += metrics_now_ns() - stepStart;
+    if (finished) {
+        gMetrics.loads.add();
+        if (fileBytes > 0) gMetrics.bytesLoaded.add(static_cast<uint64_t>(fileBytes));
+        gMetrics.loadDuration.record(stepNs);
+    }
+    return finished;
+}
+
+void EventFileLoader::readLine() {
+    lineNumber++;
+    if (line.empty() || line.find_first_not_of(" \t\n\v\f\r") == string::npos) {
+        return;
+    }
+    if (line[0] == '#') {
+        if (line.rfind("#format ", 0) != 0) return;
+        format = atoi(line.c_str() + 8);
+        if (format > DATA_FILE_FORMAT) {
+            cerr << "Warn: " << manager.dataFilePath << " is format " << format << "; this build reads up to " << DATA_FILE_FORMAT << ". Loading what it can." << endl;
         }
+        return;
+    }
+    if (line[0] == '@') {
+        filePeople.push_back(manager.people.intern(parsePersonLine(line)));
+        return;
+    }
+    if (line.size() > 1 && line[1] == '|') { // Event lines start with their type digit
+        filePending();
+        pending = parseEventLine(line, lineNumber);
+        skippingEvent = !pending;
+        return;
+    }
+    if (!pending) {
+        if (!skippingEvent) cerr << "Warn: Attendee line " << lineNumber << " does not follow an event. Skipping." << endl;
+        return;
+    }
+    if (format >= 2) parseAttendeeNumbers(line, pending->getTitle(), lineNumber, filePeople, attending);
+    else parseLegacyAttendees(line, pending->getTitle(), lineNumber, manager.people, attending);
+}
 
-        title_load = cDecrypt(title_load, SHIFT);
-        host_load = cDecrypt(host_load, SHIFT);
-        description_load = cDecrypt(description_load, SHIFT);
-        dateAndTime_load = cDecrypt(dateAndTime_load, SHIFT);
-        vPlatform_load = cDecrypt(vPlatform_load, SHIFT);
-
-        eventType type_enum_load;
-        if (typeStr_load == "0") type_enum_load = Webinar;
-        else if (typeStr_load == "1") type_enum_load = Conference;
-        else if (typeStr_load == "2") type_enum_load = Workshop;
-        else {
-            cerr << "Warn: Unknown event type '" << typeStr_load << "' in event line " << lineNumber << ": " << eventLine << ". Skipping." << endl;
-            continue;
+void EventFileLoader::filePending() {
+    if (!pending) return;
+    pending->reserveAttendees(attending.size());
+    for (PersonId who : attending) pending->addAttendee(who);
+    EventHandle h = manager.insertSlot(pending);
+    {
+        lock_guard<mutex> indexGuard(manager.indexLock);
+        manager.indexSlot(h, &timeEntries);
+    }
+    for (PersonId who : attending) manager.people.addAttendance(who, h);
+    loadedSlots.push_back(h.index);
+    pending = nullptr;
+    attending.clear();
+}
+
+void EventFileLoader::finish() {
+    filePending();
+    file.close();
+    {
+        lock_guard<mutex> indexGuard(manager.indexLock);
+        manager.timeIndex.insertBatch(timeEntries); // Also merges the entries deferred by earlier steps
+    }
+    manager.publishSnapshot(loadedSlots); // One version for the whole file
+    manager.fileLoading = false;
+    manager.fileLoaded = true;
+    finished = true;
+    cout << "Loaded " << manager.liveEventCount << " events (" << manager.people.size() << " people) from " << manager.dataFilePath << endl;
+}
+
+// --- EventSearch Method Definitions ---
+EventSearch::EventSearch(const events& manager, const string& q)
+    : snap(manager.snapshot()), tracer(manager.traceRecorder()), tracedStartNs(tracer ? tracer->nowNs() : 0), query(q) {
+    found.reserve(query.empty() ? snap->liveCount : 0);
+}
+
+bool EventSearch::step(size_t maxSlots) {
+    if (finished) return true;
+    uint64_t stepStart = metrics_now_ns();
+    finished = scan(maxSlots);
+    stepNs += metrics_now_ns() - stepStart;
+    if (finished) { // One record for the whole search: started at construction, lasting the time spent in steps
+        gMetrics.searches.add();
+        gMetrics.searchLatency.record(stepNs);
+        if (tracer) tracer->record(TRACE_SEARCH, tracedStartNs, stepNs, found.size(), {query});
+    }
+    return finished;
+}
+
+bool EventSearch::scan(size_t maxSlots) {
+    uint64_t compared = 0, pruned = 0; // Added to gMetrics once per step
+    bool complete = snap->forEachFrom(position, maxSlots, [&](const EventRecord& r) {
+        if (query.empty()) {
+            found.push_back(r.handle);
+            return;
         }
-        
-        event* ev = nullptr;
-        if (type_enum_load == Webinar)
-            ev = new webinar(type_enum_load, title_load, host_load, description_load, dateAndTime_load, vPlatform_load, capacity_load);
-        else if (type_enum_load == Conference)
-            ev = new conference(type_enum_load, title_load, host_load, description_load, dateAndTime_load, vPlatform_load, capacity_load);
-        else if (type_enum_load == Workshop)
-            ev = new workshop(type_enum_load, title_load, host_load, description_load, dateAndTime_load, vPlatform_load, capacity_load);
-
-        if (!ev) {
-            cerr << "Error creating event object from event line " << lineNumber << ": " << eventLine << endl;
-            continue; // Skip to next event line
+        if (lengthRulesOutMatch(query.size(), r.title.size())) {
+            ++pruned;
+            return;
         }
+        ++compared;
+        size_t before = matched.size();
+        addIfAccurateEnough(matched, query, r.title); // Appends when the title is close enough
+        if (matched.size() != before) {
+            found.push_back(r.handle);
+        }
+    });
+    if (compared) gMetrics.levenshteinCalls.add(compared);
+    if (pruned) gMetrics.candidatesPruned.add(pruned);
+    return complete;
+}
 
-        // Try to read the next line for attendee data
-        string attendeeDataLine;
-        if (getline(eventFile, attendeeDataLine)) {
-            lineNumber++; // Account for the attendee line
-            if (!attendeeDataLine.empty() && attendeeDataLine.find('|') == string::npos) { // Basic check: attendee line shouldn't look like an event line
-                stringstream s_attendees(attendeeDataLine);
-                string numAttendeesStr;
-                getline(s_attendees, numAttendeesStr, ';'); // Get number of attendees
-                
-                try {
-                    int numAttendees = 0;
-                    if (!numAttendeesStr.empty()) {
-                         numAttendees = stoi(numAttendeesStr);
-                    }
-
-                    for (int i = 0; i < numAttendees; ++i) {
-                        string singleAttendeeData;
-                        if (!getline(s_attendees, singleAttendeeData, ';')) {
-                            cerr << "Warn: Could not read expected attendee data block " << (i+1) << " for event '" << title_load << "' on line " << lineNumber << endl;
-                            break; 
-                        }
-                        
-                        stringstream s_single_attendee(singleAttendeeData);
-                        string name_att, email_att, phone_att, company_att;
-                        char comma_del = ',';
-
-                        getline(s_single_attendee, name_att, comma_del);
-                        getline(s_single_attendee, email_att, comma_del);
-                        getline(s_single_attendee, phone_att, comma_del);
-                        getline(s_single_attendee, company_att); // Read rest for company
-
-                        if (name_att.empty() && email_att.empty() && phone_att.empty() && company_att.empty() && s_single_attendee.eof() && !s_single_attendee.fail()){
-                            // Potentially an empty attendee string from an extra semicolon, skip it
-                            continue;
-                        }
-                        if (s_single_attendee.fail() && !s_single_attendee.eof()){
-                             cerr << "Warn: Stream error reading attendee details for event '" << title_load << "' on line " << lineNumber << endl;
-                             continue;
-                        }
-
-
-                        name_att = cDecrypt(name_att, SHIFT);
-                        email_att = cDecrypt(email_att, SHIFT);
-                        phone_att = cDecrypt(phone_att, SHIFT);
-                        company_att = cDecrypt(company_att, SHIFT);
-                        
-                        ev->addAttendee(new attendee(name_att, email_att, phone_att, company_att));
-                    }
-                } catch (const std::exception& e) {
-                    cerr << "Warn: Error parsing attendee count or data for event '" << title_load << "' on line " << lineNumber << ". Details: " << e.what() << endl;
+// --- EventFileWriter Method Definitions ---
+EventFileWriter::EventFileWriter(const events& manager)
+    : snap(manager.snapshot()), people(manager.people), tracer(manager.traceRecorder()), tracedStartNs(tracer ? tracer->nowNs() : 0), path(manager.dataFilePath) {
+    if (path.empty() || manager.savingDisabled) { // In-memory or read-only manager
+        ok = done = true;
+        return;
+    }
+    if (!manager.isLoaded()) {
+        cerr << "Error: Not saving to " << path << ": its events were never loaded." << endl;
+        done = true;
+        return;
+    }
+    tempPath = path + ".tmp";
+    file.open(tempPath, ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << tempPath << " for writing." << endl;
+        done = true;
+        return;
+    }
+    file << "#format " << DATA_FILE_FORMAT << "\n";
+}
+
+EventFileWriter::~EventFileWriter() {
+    if (done || !file.is_open()) return;
+    file.close(); // Abandoned part-way: the data file was never touched
+    remove(tempPath.c_str());
+}
+
+bool EventFileWriter::step(size_t maxSlots) {
+    if (finished) return true;
+    uint64_t stepStart = metrics_now_ns();
+    finished = write(maxSlots);
+    stepNs += metrics_now_ns() - stepStart;
+    if (finished) {
+        gMetrics.saves.add();
+        if (ok) gMetrics.saveDuration.record(stepNs);
+        else gMetrics.saveFailures.add();
+        if (tracer) tracer->record(TRACE_SAVE, tracedStartNs, stepNs, ok ? TRACE_OK : TRACE_MISS, {});
+    }
+    return finished;
+}
+
+bool EventFileWriter::write(size_t maxSlots) {
+    if (done) return true;
+    bool complete = snap->forEachFrom(position, maxSlots, [&](const EventRecord& r) {
+        const event* e = r.ev;
+        const auto& eventAttendees = e->getAttendees();
+        size_t attendeeCount = eventAttendees.size(); // Read once: later sign-ups are left for the next save
+        attendeeLine.clear();
+        if (attendeeCount > 0) {
+            attendeeLine = to_string(attendeeCount); // Number of attendees
+            auto it = eventAttendees.begin();
+            for (size_t k = 0; k < attendeeCount; ++k, ++it) {
+                PersonId who = *it;
+                if (who >= fileNumbers.size()) fileNumbers.resize(who + 1, PersonTable::NO_PERSON);
+                if (fileNumbers[who] == PersonTable::NO_PERSON) { // First reference: write the person before the line that uses it
+                    const attendee& person = people.get(who);
+                    file << '@' << cEncrypt(person.getName(), SHIFT) << '|'
+                         << cEncrypt(person.getEmail(), SHIFT) << '|'
+                         << cEncrypt(person.getPhoneNum(), SHIFT) << '|'
+                         << cEncrypt(person.getcompanyOrSchool(), SHIFT) << "\n";
+                    fileNumbers[who] = peopleWritten++;
                 }
-            } else {
-                // This line was not attendee data, it's likely the next event or EOF.
-                // We need to "put it back" or handle it. The outer loop's getline will get it if it's a new event.
-                // If it was EOF, the outer loop will terminate.
-                // If it was an empty line, outer loop skips.
-                // If it was a new event line, the current getline has consumed it.
-                // This requires careful handling of the file stream position.
-                // A simpler way is to check if `attendeeDataLine` starts with a digit and `|`.
-                // If so, it's a new event, and we need to process `attendeeDataLine` as `eventLine` in the next iteration.
-                // This is complex with simple getline.
-                // The current implementation assumes if a line is read, and it's not attendee data, the outer loop's next getline will correctly pick up.
-                // This might lead to skipping an event if an event has no attendees and the next line is an event.
-                // The `eventFile.seekg(-attendeeDataLine.length() -1, ios_base::cur);` would be one way to "put back", but tricky with newlines.
-                // For now, this simplified logic might miss an event if an event with attendees is followed by an event with no attendees.
-                // The format `NumAttendees;data` on the attendee line helps. If NumAttendees is 0, the line might be "0\n".
-                 if (!attendeeDataLine.empty() && attendeeDataLine.find('|') != string::npos) {
-                    // It looks like the next event line, we need to process it in the next iteration
-                    // This requires the stream to be reset or the line to be processed now.
-                    // The simplest is to assume the outer loop will pick it up, but this means
-                    // the current `getline(eventFile, eventLine)` has already consumed it.
-                    // This is a known limitation of this simple line-by-line parsing for multi-line records.
-                    // A more robust parser would handle lookahead or a more structured format.
-                    // For now, we'll assume the format is strict: event line, then OPTIONAL attendee line.
-                    // If the attendee line read is actually the next event, the current logic will misinterpret.
-                    // The check `attendeeDataLine.find('|') == string::npos` tries to mitigate this.
-                    // If it *does* find '|', it means it's likely a new event, so we shouldn't parse it as attendees.
-                    // The problem is, `getline` has already advanced the stream.
-                    // This part of the loading is the most fragile.
-                    // Let's assume for now that if an attendee line is expected (next line exists), it IS the attendee line.
-                    // The `saveEventsToFile` writes `attendees.size()` first, so if 0, it writes "0\n".
-                    // If `attendeeDataLine` is "0", then numAttendees will be 0, and the inner loop won't run. This is correct.
-                 }
+                attendeeLine += ';';
+                attendeeLine += to_string(fileNumbers[who]);
             }
+            attendeeLine += '\n'; // Newline after all attendees for this event
         }
-        allEvents.push_back(ev);
+        file << to_string(e->getType()) << '|'
+             << cEncrypt(e->getTitle(), SHIFT) << '|'
+             << cEncrypt(e->getHost(), SHIFT) << '|'
+             << cEncrypt(e->getDescription(), SHIFT) << '|'
+             << cEncrypt(e->getdateAndTime(), SHIFT) << '|'
+             << cEncrypt(e->getvPlatform(), SHIFT) << '|'
+             << to_string(e->getcapacity()) << "\n" // End of event main line
+             << attendeeLine;
+    });
+    if (!complete) return false;
+
+    streamoff written = file.tellp();
+    file.close();
+    done = true;
+    ok = !file.fail();
+    if (!ok) {
+        cerr << "Error: Writing " << tempPath << " failed. " << path << " is unchanged." << endl;
+        remove(tempPath.c_str());
+        return true;
+    }
+    if (rename(tempPath.c_str(), path.c_str()) != 0) { // Atomic on POSIX and in Emscripten's FS
+        cerr << "Error: Could not replace " << path << " with " << tempPath << "." << endl;
+        remove(tempPath.c_str());
+        ok = false;
+        return true;
     }
-    eventFile.close();
-    cout << "Loaded " << allEvents.size() << " events from " << dataFilePath << endl;
+    if (written > 0) gMetrics.bytesSaved.add(static_cast<uint64_t>(written));
+    cout << "Saved " << snap->liveCount << " events to " << path << endl;
+    #ifdef __EMSCRIPTEN__
+    EM_ASM({ 
+        if (typeof FS !== 'undefined' && FS.syncfs) {
+            var savedPath = UTF8ToString($0); // Copied now: the writer, and its path, are gone before the callback runs
+            var syncStarted = performance.now();
+            FS.syncfs(false, function(err) { 
+                if (Module._metrics_record_sync) Module._metrics_record_sync(performance.now() - syncStarted, err ? 1 : 0);
+                if (err) {
+                    console.error("FS.syncfs error during save for " + savedPath + ": ", err);
+                } else {
+                    console.log("FS.syncfs save complete for " + savedPath);
+                }
+            });
+        } else {
+            console.warn("FS.syncfs not available for saveEventsToFile.");
+        }
+    }, path.c_str()); 
+    #endif
+    return true;
 }
@@ -4,14 +4,27 @@
 
 #include <string> 
 #include <vector> 
+#include <cstdint>
 #include <limits>    
 #include <algorithm> 
 #include <fstream>   
 #include <sstream>   
 #include <stdexcept> 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
+#include <list>
+#include <string_view>
+#include <unordered_map>
 
-// --- Enum Definitions ---
-enum eventType { Webinar, Conference, Workshop };
+#include "event_types.h" // eventType, EventHandle
+#include "event_index.h" // TimeIndex, AvailabilityIndex, EventListing
+#include "event_snapshot.h" // AttendeeList, EventSnapshot, EpochReclaimer
+#include "person_table.h" // attendee, PersonTable
+#include "op_trace.h" // OpTraceRecorder
+#include "metrics.h" // gMetrics
+#include "memory_accounting.h" // TrackedAllocator, memory_add
 
 // --- Class Declarations ---
 class User; 
@@ -21,7 +34,23 @@ std::string cEncrypt(const std::string& str, int shift);
 std::string cDecrypt(const std::string& str, int shift);
 int levenshteinDistance(const std::string& a, const std::string& b);
 void updateBestMatch(const std::string& query, const std::string& candidate, std::string& bestMatch, int& minDist);
-void addIfAccurateEnough(std::vector<std::string>& vec, const std::string& query, const std::string& current, double threshold = 0.75);
+const double TITLE_MATCH_THRESHOLD = 0.75; // Search accuracy: 1 - distance / longer length
+void addIfAccurateEnough(std::vector<std::string>& vec, const std::string& query, const std::string& current, double threshold = TITLE_MATCH_THRESHOLD);
+// True if the lengths alone keep `candidate` below `threshold` accuracy, since
+// the edit distance is at least the length difference: Levenshtein can be skipped.
+bool lengthRulesOutMatch(size_t queryLength, size_t candidateLength, double threshold = TITLE_MATCH_THRESHOLD);
+// Parses "DD/MM/YYYY HH:MM" into seconds since 1970-01-01 00:00 (wall-clock, no time zone).
+// Returns false and leaves epochOut untouched if the string is not a valid date and time.
+bool parseDateTime(const std::string& dt, int64_t& epochOut);
+std::string eventTypeName(eventType type); // "Webinar", "Conference", "Workshop"
+// The data file holds one record per line with fields split on '|', so a stored
+// field cannot contain a line break or '|', nor '\' (cEncrypt turns it into '|').
+bool fitsDataFile(const std::string& field);
+bool fitsDataFile(const attendee& who); // Every field
+// Checks the fields of a new event the way events::createEvent does (the host
+// is checked with fitsDataFile by the callers that take one). Returns an
+// "Error: ..." message, or an empty string with the parsed capacity in capacityOut.
+std::string validateEventFields(const std::string& title, const std::string& desc, const std::string& dt, const std::string& vp, const std::string& capStr, int& capacityOut);
 
 
 class User {
@@ -51,29 +80,39 @@ public:
     std::string getCompanyOrSchool() const;
 };
 
-class attendee {
-private:
-    std::string name;
-    std::string email;
-    std::string phoneNum;
-    std::string companyOrSchool;
-public:
-    attendee(std::string n, std::string e, std::string p, std::string cs);
-    std::string getName() const;      // Added const
-    std::string getEmail() const;     // Added const
-    std::string getPhoneNum() const;  // Added const
-    std::string getcompanyOrSchool() const; // Added const
-};
-
 class event {
+    friend class events;          // The only callers of the mutators below
+    friend class EventFileLoader;
 protected:
     std::string title;
     std::string host;
     std::string description;
     std::string dateAndTime;
     std::string vPlatform;
+    int64_t startTime; // dateAndTime parsed once; UNKNOWN_EVENT_TIME if it does not parse
     int capacity;
-    std::vector<attendee*> attendees;
+    AttendeeList attendees; // Append-only, by person; readable without a lock
+    // Seats claimed so far. Sign-ups reserve with an atomic fetch-add before
+    // touching `attendees`, so concurrent sign-ups can never overbook.
+    std::atomic<int> seatsTaken{0};
+    size_t accountedBytes = 0; // Charged to MEM_EVENTS: the object and its strings
+
+    bool tryReserveSeat(); // Lock-free; false (and nothing reserved) when full
+    void updateAccounting(); // After construction and whenever a string field changes
+
+private:
+    // Changing a filed event behind the manager's back would leave the title,
+    // time and availability indexes and its listing row stale: sign-ups go
+    // through events, and events::editEvent builds an edited copy and refiles it.
+    void addAttendee(PersonId who); // Add an attendee
+    bool tryAddAttendee(PersonId who); // Adds only if a seat is free
+    void reserveAttendees(size_t additional);
+    void setTitle(std::string t);
+    void setHost(std::string h);
+    void setDescription(std::string d);
+    void setDateAndTime(std::string dt);
+    void setvPlatform(std::string v);
+    void setCapacity(int c);
 
 public:
     event(std::string t, std::string h, std::string d, std::string dt, std::string v, int c);
@@ -81,29 +120,28 @@ public:
 
     virtual ~event();
 
-    virtual std::string signUp(User* user, std::string& message) = 0; 
-    virtual eventType getType() = 0; 
+    // Adds `who` (interned by the manager) if a seat is free and returns whether
+    // it did; message says which.
+    virtual bool signUp(PersonId who, std::string& message) = 0;
+    virtual eventType getType() const = 0; 
 
     std::string getTitle() const; // Added const
     std::string getHost() const; // Added const
     std::string getDescription() const; // Added const
     std::string getdateAndTime() const; // Added const
+    int64_t getStartTime() const;
     std::string getvPlatform() const; // Added const
     int getcapacity() const; // Added const
     int getAttendeeCount() const;
+    int getFreeSeats() const; // capacity minus attendees, never negative
+    bool isFull() const;
+    std::string fullMessage() const; // What signUp says when it refuses for lack of seats
 
     // New methods for attendee management
-    const std::vector<attendee*>& getAttendees() const; // Get a const ref to the vector
-    void addAttendee(attendee* a); // Add an attendee
-
-    void setTitle(std::string t);
-    void setHost(std::string h);
-    void setDescription(std::string d);
-    void setDateAndTime(std::string dt);
-    void setvPlatform(std::string v);
-    void setCapacity(int c);
+    const AttendeeList& getAttendees() const; // Safe to iterate while others sign up
 
     static event* createEvent(eventType type, User* user, const std::string& title, const std::string& desc, const std::string& dts, const std::string& vps, int capacity_val);
+    static event* createEvent(eventType type, const std::string& host, const std::string& title, const std::string& desc, const std::string& dts, const std::string& vps, int capacity_val);
 };
 
 class webinar : public event {
@@ -112,8 +150,8 @@ private:
 public:
     webinar(eventType ty_enum, std::string t, std::string h, std::string d, std::string dt, std::string v, int c);
     webinar(User* user, const std::string& t, const std::string& desc, const std::string& date, const std::string& vp, int cap);
-    std::string signUp(User* user, std::string& message) override;
-    eventType getType() override;
+    bool signUp(PersonId who, std::string& message) override;
+    eventType getType() const override;
 };
 
 class conference : public event {
@@ -122,8 +160,8 @@ private:
 public:
     conference(eventType ty_enum, std::string t, std::string h, std::string d, std::string dt, std::string v, int c);
     conference(User* user, const std::string& t, const std::string& desc, const std::string& date, const std::string& vp, int cap);
-    std::string signUp(User* user, std::string& message) override;
-    eventType getType() override;
+    bool signUp(PersonId who, std::string& message) override;
+    eventType getType() const override;
 };
 
 class workshop : public event {
@@ -132,32 +170,373 @@ private:
 public:
     workshop(eventType ty_enum, std::string t, std::string h, std::string d, std::string dt, std::string v, int c);
     workshop(User* user, const std::string& t, const std::string& desc, const std::string& date, const std::string& vp, int cap);
-    std::string signUp(User* user, std::string& message) override;
-    eventType getType() override;
+    bool signUp(PersonId who, std::string& message) override;
+    eventType getType() const override;
 };
 
+// Thread safety: every public member of `events` may be called concurrently.
+// - tableLock (reader-writer) guards the slot table. Create, delete and load
+//   take it exclusively; lookups, searches, sign-ups and saves share it.
+// - shardLocks guard the mutable contents of events (their attendee lists),
+//   striped by slot index, so sign-ups to different events do not contend.
+// - indexLock guards timeIndex, availabilityIndex, the listing rows and the
+//   slots' indexed* keys.
+// - The PersonTable's own locks guard its lookups and attendance lists; they
+//   are leaves, held only inside PersonTable calls.
+// Locks are always taken in that order. Seat counts are reserved atomically
+// in event::tryReserveSeat, so a full event is rejected without blocking.
+// Create, delete, import and load publish a new EventSnapshot before they
+// release tableLock. Searches, title lookups, visitEvents and saving read a
+// pinned snapshot and take no locks, so they never hold up writers; deleted
+// events and old snapshots are freed by epoch reclamation once no reader can
+// still see them. Sign-ups do not publish a version: attendee lists are
+// append-only and readers see a consistent prefix. Listing rows and summaries
+// are read from the materialized rows under indexLock.
+// get() hands out a raw pointer and is only safe while no other thread can
+// delete or edit that event; use snapshot() to read events that may be deleted.
+const size_t EVENT_LOCK_SHARDS = 16;
+
+// The "did you mean" scan: the closest title to a query, fed candidates one at
+// a time in slot order. events::findByTitle and SuggestionScan both use it, so
+// they agree on the answer (ties go to the lowest slot).
+struct TitleMatcher {
+    explicit TitleMatcher(const std::string& q) : query(q) {}
+    void consider(const std::string& title, EventHandle h); // Skips titles whose length rules them out
+    EventHandle suggestion() const; // Invalid unless the closest title is near enough to offer
+
+    std::string query;
+    std::string best;
+    int minDist = std::numeric_limits<int>::max();
+    EventHandle bestHandle;
+    uint64_t compared = 0, pruned = 0;
+};
+
+// Answers of the "did you mean" scan (events::findByTitle) by query, for the
+// catalog version they were computed against. Adding, deleting or retitling an
+// event moves the version and empties the cache, so a hit always returns what
+// a fresh scan would. Queries are keyed exactly as typed: the distance kernel
+// is case and whitespace sensitive, so folding them would change answers.
+// Holds at most CAPACITY queries, least recently used out first. Lookups run
+// under a shared tableLock, so it has its own (leaf) lock.
+class SuggestionCache {
+public:
+    static const size_t CAPACITY = 256;
+
+    SuggestionCache() = default;
+    SuggestionCache(const SuggestionCache&) = delete;
+    SuggestionCache& operator=(const SuggestionCache&) = delete;
+    ~SuggestionCache() { clear(); }
+
+    // True on a hit for this version, with the suggestion (invalid: nothing near enough).
+    bool lookup(const std::string& query, uint64_t catalogVersion, EventHandle& suggestion);
+    bool holds(const std::string& query, uint64_t catalogVersion); // lookup without counting a hit or miss
+    void store(const std::string& query, uint64_t catalogVersion, EventHandle suggestion, uint64_t scanNs);
+    void clear();
+
+private:
+    struct Entry {
+        std::string query;
+        EventHandle suggestion;
+        uint64_t scanNs; // What the scan cost: each hit saves about this much
+    };
+    typedef std::list<Entry, TrackedAllocator<Entry, MEM_INDEXES>> Entries;
+
+    std::mutex lock;
+    uint64_t version = 0; // Catalog version of every entry
+    Entries lru;          // Most recently used first
+    std::unordered_map<std::string_view, Entries::iterator, std::hash<std::string_view>, std::equal_to<std::string_view>,
+                       TrackedAllocator<std::pair<const std::string_view, Entries::iterator>, MEM_INDEXES>> byQuery; // Keys point into lru
+
+    void clearLocked();
+};
+
+// Fields events::editEvent can change.
+enum EventField { FIELD_TITLE, FIELD_HOST, FIELD_DESCRIPTION, FIELD_DATE_TIME, FIELD_PLATFORM, FIELD_CAPACITY };
+
 class events {
+    friend class EventFileWriter;
+    friend class EventFileLoader;
+    friend class SuggestionScan;
 private:
-    std::vector<event*> allEvents;
-    std::string dataFilePath; 
-    // Global suggestedMatch for "did you mean" functionality, accessed via extern in main.cpp
-    // This is not ideal; better to pass it around or make it a member of a UI state class.
-    // For now, keeping it as it was in the previous structure for minimal changes outside app_logic.
-    // extern std::string suggestedMatch; 
+    struct EventSlot {
+        event* ev = nullptr;
+        uint32_t generation = 1; // Bumped on delete; never 0
+        int64_t indexedTime = UNKNOWN_EVENT_TIME; // Key this event was filed under in timeIndex
+        int indexedFreeSeats = 0;                 // ...and in availabilityIndex
+        eventType type = Webinar;
+    };
 
+    std::vector<EventSlot, TrackedAllocator<EventSlot, MEM_EVENTS>> slots;  // Indexed by EventHandle::index
+    std::vector<uint32_t, TrackedAllocator<uint32_t, MEM_EVENTS>> freeSlots; // Recycled slot indices (LIFO)
+    size_t liveEventCount = 0;
+    // Exact title -> slot; guarded by tableLock. Key strings are charged to MEM_INDEXES by insertSlot and releaseEvent.
+    std::unordered_multimap<std::string, uint32_t, std::hash<std::string>, std::equal_to<std::string>,
+                            TrackedAllocator<std::pair<const std::string, uint32_t>, MEM_INDEXES>> titleIndex;
+    TimeIndex timeIndex;
+    AvailabilityIndex availabilityIndex;
+    EventListing listing; // Formatted row per live event, updated as events change
+    uint64_t titlesVersion = 0; // Moves whenever the set of titles does; guarded by tableLock
+    mutable SuggestionCache suggestions;
+    std::string dataFilePath; // Empty: in-memory only, nothing is loaded or saved
+    std::atomic<bool> fileLoaded{false}; // Until set, saving would overwrite the file with a partial table
+    bool fileLoading = false; // An EventFileLoader is part-way through the file; guarded by tableLock
+    std::atomic<bool> savingDisabled{false};
+    std::atomic<OpTraceRecorder*> tracer{nullptr};
+    PersonTable people; // Everyone who signed up for any event, once each
+
+    mutable std::shared_mutex tableLock;
+    mutable std::shared_mutex shardLocks[EVENT_LOCK_SHARDS];
+    mutable std::mutex indexLock;
+
+    mutable EpochReclaimer reclaimer;
+    std::atomic<const EventSnapshot*> published{nullptr};
+
+    std::shared_mutex& shardFor(EventHandle h) const { return shardLocks[h.index % EVENT_LOCK_SHARDS]; }
+
+    // The helpers below expect tableLock to be held (exclusively where they modify the table).
+    event* resolve(EventHandle h) const;
+    EventHandle insertEvent(event* e);
+    EventHandle insertSlot(event* e);  // Table and title index only; the caller files it in the other indexes
+    // Time, availability and listing; caller holds indexLock. With timeBatch, the
+    // time entry is appended there for one insertBatch instead.
+    void indexSlot(EventHandle h, std::vector<std::pair<int64_t, EventHandle>>* timeBatch = nullptr);
+    EventHandle findExactTitle(const std::string& title) const;
+    void eraseTitle(const std::string& title, uint32_t index); // That slot's title index entry
+    void titlesChanged(); // After adding, removing or renaming an event; tableLock exclusive
+    void releaseEvent(EventHandle h);
+    std::string removeEvent(EventHandle h); // deleteEvent without tracing
+    void refreshAvailability(EventHandle h); // Call after anything that changes an event's seat count; updates the listing row too
+    // Publishes a new version in which the chunks holding changedSlots (and any
+    // chunks for slots added since the last version) are rebuilt. tableLock exclusive.
+    void publishSnapshot(const std::vector<uint32_t>& changedSlots);
+    std::shared_ptr<const SnapshotChunk> buildChunk(size_t chunkIndex) const;
+    EventHandle findByTitle(const std::string& titleQuery, EventHandle& bestSuggestion) const;
+    PinnedSnapshot snapshotWithTitlesVersion(uint64_t& version) const; // The two as of one moment
+    // Signs up `who` if given, otherwise `user`; true if signed up. signUpMessage says what happened.
+    bool signUpLocked(User* user, const attendee* who, EventHandle h, std::string& signUpMessage);
+    std::string attemptSignUpImpl(User* user, const attendee* who, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage, EventHandle& suggestion, bool& signedUp);
 
 public:
+    static const char* const DEFAULT_DATA_FILE; // In the IDBFS mount of the web build
+
+    // Tag for a manager that starts empty and reads its file only when
+    // loadEventsFromFile() is called, e.g. once persistent storage is mounted.
+    struct DeferLoad {};
+
     events(); 
+    explicit events(const std::string& filePath);
+    events(const std::string& filePath, DeferLoad);
     ~events(); 
 
+    // Pins the current version of the event table. Reads through it take no
+    // locks; release it promptly (see PinnedSnapshot).
+    PinnedSnapshot snapshot() const;
+
+    // Handle lookups. get() returns nullptr for stale or invalid handles.
+    event* get(EventHandle h) const;
+    bool isLive(EventHandle h) const;
+    size_t size() const;
+    std::vector<EventHandle> getAllEventHandles() const;
+    std::string getEventTitle(EventHandle h) const;
+    std::string getEventSummary(EventHandle h) const; // "Title (Host: X, Cap: a/b)", from the listing rows
+
+    // Date queries, served from the time index in O(log n + k).
+    std::vector<EventHandle> getEventsChronological() const;
+    std::vector<EventHandle> getEventsBetween(int64_t from, int64_t to) const; // [from, to)
+    std::vector<EventHandle> getUpcomingEvents(int64_t from, size_t count) const;
+    std::vector<EventHandle> getEventsPage(size_t offset, size_t limit) const; // Window of the chronological listing
+    // The same window as formatted rows, read under one lock. Rows whose handle
+    // and version already match are left as they are (see EventListing::read),
+    // so keep `rows` between calls. Returns getListingVersion() as of the read.
+    uint64_t getListingPage(size_t offset, size_t limit, std::vector<ListingRow>& rows) const;
+    uint64_t getListingVersion() const { return listing.version(); } // Moves whenever any listing row changes
+
+    // Seat availability queries, served from the availability index. Results are
+    // ordered most free seats first; limit caps how many are returned.
+    std::vector<EventHandle> getEventsWithFreeSeats(int minFree = 1, size_t limit = std::numeric_limits<size_t>::max()) const;
+    std::vector<EventHandle> getOpenEventsOfType(eventType type, int minFree = 1, size_t limit = std::numeric_limits<size_t>::max()) const;
+    std::vector<EventHandle> getMostAvailable(eventType type, size_t count) const;
+    size_t getOpenEventCount() const;
+    // Window of the open events in that order, as getListingPage reads it.
+    uint64_t getOpenListingPage(size_t offset, size_t limit, std::vector<ListingRow>& rows) const;
+
     std::string createEvent(User* user, eventType type_enum, const std::string& title, const std::string& desc, const std::string& dt, const std::string& vp, const std::string& capStr);
+    std::string createEventForHost(const std::string& host, eventType type_enum, const std::string& title, const std::string& desc, const std::string& dt, const std::string& vp, const std::string& capStr);
     std::vector<std::string> getAllEventTitles() const;
-    std::string attemptDeleteEvent(const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion);
-    std::string confirmDeleteSuggestedEvent();
-    std::string attemptSignUp(User* user, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage);
-    std::string confirmSignUpSuggestedEvent(User* user, std::string& signUpMessage);
-    std::vector<std::string> searchEvents(const std::string& query);
+    // True if attemptDeleteEvent / attemptSignUp on this title would not scan:
+    // it is an exact title, or its "did you mean" answer is cached for the
+    // current titles. Otherwise run a SuggestionScan first to keep the scan off
+    // a thread that must not block.
+    bool answersTitleWithoutScan(const std::string& titleQuery) const;
+    // On a near miss, foundSuggestion is set and `suggestion` holds the closest event;
+    // pass it back to the matching confirm function to act on it without searching again.
+    std::string attemptDeleteEvent(const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, EventHandle& suggestion);
+    std::string deleteEvent(EventHandle h);
+    std::string confirmDeleteSuggestedEvent(EventHandle suggestion);
+    // Changes one field, validated as createEvent validates it; the capacity
+    // cannot drop below the seats taken. The event is replaced by an edited
+    // copy under the same handle (readers of older snapshots keep the
+    // original), and its indexes and listing row follow.
+    std::string editEvent(EventHandle h, EventField field, const std::string& value);
+    std::string attemptSignUp(User* user, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage, EventHandle& suggestion);
+    // Also sets signedUp, so callers need not match the message text.
+    std::string attemptSignUp(User* user, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage, EventHandle& suggestion, bool& signedUp);
+    std::string confirmSignUpSuggestedEvent(User* user, EventHandle suggestion, std::string& signUpMessage);
+    // Same as attemptSignUp, for an attendee who is not the current User.
+    std::string attemptSignUpAs(const attendee& who, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage, EventHandle& suggestion);
+    std::string attemptSignUpAs(const attendee& who, const std::string& titleQuery, bool& foundDirectly, bool& foundSuggestion, std::string& signUpMessage, EventHandle& suggestion, bool& signedUp);
+    std::vector<EventHandle> searchEvents(const std::string& query) const;
+
+    // People. Attendee lists hold PersonIds; getPerson resolves one without a
+    // lock, for any id read from an event this manager handed out.
+    const attendee& getPerson(PersonId id) const { return people.get(id); }
+    size_t getPersonCount() const { return people.size(); }
+    // Live events the person with this email (any case) is signed up for, in
+    // sign-up order; a direct lookup, not a scan of the attendee lists.
+    std::vector<EventHandle> getEventsAttendedBy(const std::string& email) const;
     
-    bool saveEventsToFile();
+    // Bulk ingest. Takes the table lock once, reserves room up front, and files
+    // the whole batch into the indexes in one pass. Ownership of every event in
+    // `newEvents` passes to the manager. Each attendee is matched to an event by
+    // exact title (existing events or ones in this batch) and kept only if a seat
+    // is free; the indices of rejected attendees are appended to rejectedAttendees.
+    struct ImportBatch {
+        std::vector<event*> newEvents;
+        std::vector<std::pair<std::string, attendee>> attendees; // (event title, attendee)
+    };
+    void importBatch(ImportBatch& batch, size_t& attendeesAdded, std::vector<size_t>& rejectedAttendees);
+
+    // Calls fn for every live event (slot order) in one pinned snapshot, without
+    // holding any lock: writers proceed meanwhile, and fn may call back into
+    // this manager.
+    void visitEvents(const std::function<void(EventHandle, const event&)>& fn) const;
+
+    bool saveEventsToFile(); // Runs an EventFileWriter to completion
+    // Makes every later save, including the one at destruction, leave the data
+    // file alone, for callers that only read it. Loading is unaffected.
+    void disableSaving() { savingDisabled = true; }
+    // Adds the file's events to the table; later calls do nothing. Safe to run
+    // on a worker thread while the UI reads and writes the manager. Runs an
+    // EventFileLoader to completion.
     void loadEventsFromFile();
+    bool isLoaded() const { return fileLoaded.load(); } // Saving is refused until then
+    // Frees deleted events and old snapshot versions no reader can still see
+    // (otherwise done as later writes retire more). The MEM_SNAPSHOTS evictor.
+    void reclaimRetired() const { reclaimer.collect(); }
+
+    // Records every create, sign-up, search, delete and save to `recorder`
+    // (see op_trace.h) until set back to nullptr. The recorder must outlive
+    // the calls in flight; nothing is recorded while it is null.
+    void setTraceRecorder(OpTraceRecorder* recorder) { tracer.store(recorder); }
+    OpTraceRecorder* traceRecorder() const { return tracer.load(); }
+};
+
+// The "did you mean" scan behind a delete or sign-up by title, over one pinned
+// snapshot and resumable like EventSearch, so the UI can spread it over
+// frames. The answer goes into the manager's suggestion cache, where the next
+// attemptDeleteEvent or attemptSignUp for that title finds it without a scan
+// (unless a title changed meanwhile; see events::answersTitleWithoutScan).
+class SuggestionScan {
+public:
+    SuggestionScan(const events& manager, const std::string& title);
+    bool step(size_t maxSlots); // True once the answer is cached
+
+private:
+    const events& manager;
+    uint64_t titlesVersion = 0; // Of snap
+    PinnedSnapshot snap;
+    TitleMatcher matcher;
+    size_t position = 0;
+    uint64_t scanNs = 0;
+    bool finished = false;
+};
+
+// Fuzzy title search over one pinned snapshot, resumable so a caller can bound
+// the time spent per call (see JobScheduler). An empty query matches every
+// event. events::searchEvents runs one to completion.
+class EventSearch {
+public:
+    EventSearch(const events& manager, const std::string& query);
+    bool step(size_t maxSlots); // Scans up to maxSlots more slots; true once the scan is complete
+    const std::vector<EventHandle>& results() const { return found; }
+    std::vector<EventHandle> takeResults() { return std::move(found); }
+
+private:
+    PinnedSnapshot snap;
+    OpTraceRecorder* tracer; // Records the search once the scan completes
+    uint64_t tracedStartNs;
+    uint64_t stepNs = 0;     // Time spent in step() so far: the search's latency
+    bool finished = false;
+    std::string query;
+    size_t position = 0;
+    std::vector<EventHandle> found;
+    std::vector<std::string> matched; // Scratch for addIfAccurateEnough
+
+    bool scan(size_t maxSlots);
+};
+
+// Writes the manager's data file from one pinned snapshot, a slice of slots
+// per step. Sign-ups and edits made while it runs are left for the next save.
+// The file is written beside the data file (".tmp") and renamed over it once
+// complete, so the data file is whole at every moment of a save that spans
+// many frames; a writer destroyed before finishing removes its temporary file.
+class EventFileWriter {
+public:
+    explicit EventFileWriter(const events& manager);
+    ~EventFileWriter();
+    bool step(size_t maxSlots); // True once the file is written (or writing failed)
+    bool succeeded() const { return ok; }
+
+private:
+    PinnedSnapshot snap;
+    const PersonTable& people;
+    OpTraceRecorder* tracer; // Records the save once it is written
+    uint64_t tracedStartNs;
+    uint64_t stepNs = 0;     // Time spent in step() so far
+    bool finished = false;
+    std::string path;
+    std::string tempPath;    // Written, then renamed to path
+    std::ofstream file;
+    size_t position = 0;
+    std::vector<uint32_t> fileNumbers; // PersonId -> person number in the file; NO_PERSON until written
+    uint32_t peopleWritten = 0;
+    std::string attendeeLine;          // Scratch for the current event
+    bool ok = false;
+    bool done = false;
+
+    bool write(size_t maxSlots);
+};
+
+// Reads the manager's data file into its table, a slice of lines per step, so
+// a large file holds tableLock (and, on the web, the frame) for one slice at a
+// time. Each step files the events it read in the table and indexes, with
+// their time index entries left unmerged; they are merged, and one snapshot
+// version published, once the last line is read. A loader destroyed before
+// then leaves the events filed so far and the manager still refusing to save.
+class EventFileLoader {
+public:
+    explicit EventFileLoader(events& manager);
+    ~EventFileLoader();
+    bool step(size_t maxLines); // True once the file is read (or there is none to read)
+
+private:
+    events& manager;
+    std::ifstream file;
+    std::streamoff fileBytes = 0;
+    uint64_t stepNs = 0; // Time spent in step() so far
+    bool finished = false;
+    std::string line;
+    int lineNumber = 0;
+    int format = 1;
+    std::vector<PersonId> filePeople; // Person number in the file -> id
+    event* pending = nullptr;         // Last event read, filed once its attendee line (if any) has been read
+    bool skippingEvent = false;       // The last event line was malformed: drop its attendees quietly
+    std::vector<PersonId> attending;
+    std::vector<uint32_t> loadedSlots;
+    std::vector<std::pair<int64_t, EventHandle>> timeEntries; // Read this step
+
+    // The helpers below expect the manager's tableLock to be held exclusively.
+    void readLine();
+    void filePending();
+    void finish();
 };
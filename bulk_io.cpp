@@ -0,0 +1,449 @@
+#include "bulk_io.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <thread>
+
+using namespace std;
+
+// --- Record Parsing ---
+namespace {
+
+const size_t MAX_CSV_RECORD_BYTES = 1024 * 1024; // A quoted field stops spanning lines here
+
+struct ParsedRecord {
+    enum Kind { SKIP, EVENT, ATTENDEE, INVALID } kind = SKIP;
+    size_t lineNumber = 0;
+    event* ev = nullptr;        // EVENT: built by the parser, handed to the manager on commit
+    string eventTitle;          // ATTENDEE
+    attendee who{"", "", "", ""};
+    string error;               // INVALID
+};
+
+bool splitCsvLine(const string& line, vector<string>& fields, string& error) {
+    fields.clear();
+    string field;
+    bool inQuotes = false, wasQuoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (inQuotes) {
+            if (c == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') { field += '"'; ++i; }
+                else inQuotes = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"' && field.empty() && !wasQuoted) {
+            inQuotes = wasQuoted = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+            wasQuoted = false;
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    if (inQuotes) {
+        error = "unterminated quoted field";
+        return false;
+    }
+    fields.push_back(field);
+    return true;
+}
+
+// True if `text` ends inside a quoted field, read the way splitCsvLine reads it:
+// the record continues on the next line (a quoted value with a line break).
+bool csvQuoteOpen(const string& text) {
+    bool inQuotes = false, fieldStart = true;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (inQuotes) {
+            if (c != '"') continue;
+            if (i + 1 < text.size() && text[i + 1] == '"') ++i;
+            else inQuotes = false;
+        } else if (c == '"' && fieldStart) {
+            inQuotes = true;
+            fieldStart = false;
+        } else {
+            fieldStart = c == ',';
+        }
+    }
+    return inQuotes;
+}
+
+void appendUtf8(string& out, unsigned cp) {
+    if (cp < 0x80) { out += static_cast<char>(cp); }
+    else if (cp < 0x800) { out += static_cast<char>(0xC0 | (cp >> 6)); out += static_cast<char>(0x80 | (cp & 0x3F)); }
+    else if (cp < 0x10000) { out += static_cast<char>(0xE0 | (cp >> 12)); out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); out += static_cast<char>(0x80 | (cp & 0x3F)); }
+    else {
+        out += static_cast<char>(0xF0 | (cp >> 18)); out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Parses a flat JSON object of string, number, boolean or null values. Numbers
+// and literals are kept as their source text.
+bool parseJsonObject(const string& s, vector<pair<string, string>>& members, string& error) {
+    members.clear();
+    size_t i = 0;
+    auto skipWs = [&]() { while (i < s.size() && isspace(static_cast<unsigned char>(s[i]))) ++i; };
+    auto parseHex4 = [&](unsigned& cp) -> bool {
+        if (i + 4 > s.size()) return false;
+        cp = 0;
+        for (int k = 0; k < 4; ++k) {
+            char h = s[i++];
+            cp <<= 4;
+            if (h >= '0' && h <= '9') cp |= h - '0';
+            else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+            else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+            else return false;
+        }
+        return true;
+    };
+    auto parseString = [&](string& out) -> bool {
+        if (i >= s.size() || s[i] != '"') return false;
+        ++i;
+        while (i < s.size() && s[i] != '"') {
+            char c = s[i++];
+            if (c != '\\') { out += c; continue; }
+            if (i >= s.size()) return false;
+            char esc = s[i++];
+            switch (esc) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned cp = 0;
+                    if (!parseHex4(cp)) return false;
+                    if (cp >= 0xD800 && cp <= 0xDFFF) { // A surrogate: only a high one followed by a low one is a code point
+                        size_t afterHigh = i;
+                        unsigned low = 0;
+                        bool paired = cp <= 0xDBFF && i + 1 < s.size() && s[i] == '\\' && s[i + 1] == 'u';
+                        if (paired) {
+                            i += 2;
+                            paired = parseHex4(low) && low >= 0xDC00 && low <= 0xDFFF;
+                        }
+                        if (paired) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            i = afterHigh; // The next escape is read on its own
+                            cp = 0xFFFD;   // Unpaired surrogates have no UTF-8 form
+                        }
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (i >= s.size()) return false;
+        ++i; // Closing quote
+        return true;
+    };
+
+    skipWs();
+    if (i >= s.size() || s[i] != '{') { error = "expected '{'"; return false; }
+    ++i;
+    skipWs();
+    if (i < s.size() && s[i] == '}') { ++i; }
+    else {
+        while (true) {
+            skipWs();
+            string key, value;
+            if (!parseString(key)) { error = "expected a quoted key"; return false; }
+            skipWs();
+            if (i >= s.size() || s[i] != ':') { error = "expected ':' after \"" + key + "\""; return false; }
+            ++i;
+            skipWs();
+            if (i < s.size() && s[i] == '"') {
+                if (!parseString(value)) { error = "bad string value for \"" + key + "\""; return false; }
+            } else {
+                size_t start = i;
+                while (i < s.size() && s[i] != ',' && s[i] != '}' && !isspace(static_cast<unsigned char>(s[i]))) ++i;
+                value = s.substr(start, i - start);
+                if (value.empty() || value[0] == '{' || value[0] == '[') { error = "unsupported value for \"" + key + "\""; return false; }
+            }
+            members.emplace_back(key, value);
+            skipWs();
+            if (i < s.size() && s[i] == ',') { ++i; continue; }
+            if (i < s.size() && s[i] == '}') { ++i; break; }
+            error = "expected ',' or '}'";
+            return false;
+        }
+    }
+    skipWs();
+    if (i != s.size()) { error = "trailing characters after object"; return false; }
+    return true;
+}
+
+const string* member(const vector<pair<string, string>>& members, const char* key) {
+    for (const auto& m : members) {
+        if (m.first == key) return &m.second;
+    }
+    return nullptr;
+}
+
+// Builds an event record from already-split fields, using the same validation as events::createEvent.
+void buildEventRecord(ParsedRecord& rec, const string& typeText, const string& host, const string& title, const string& desc, const string& dt, const string& platform, const string& capStr) {
+    eventType type;
+    if (!parseEventType(typeText, type)) {
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = "unknown event type '" + typeText + "'";
+        return;
+    }
+    int capacity = 0;
+    string error = validateEventFields(title, desc, dt, platform, capStr, capacity);
+    if (error.empty() && !fitsDataFile(host)) error = "Error: Event details cannot contain line breaks, '|' or '\\'.";
+    if (!error.empty()) {
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = error;
+        return;
+    }
+    rec.ev = event::createEvent(type, host, title, desc, dt, platform, capacity);
+    rec.kind = rec.ev ? ParsedRecord::EVENT : ParsedRecord::INVALID;
+    if (!rec.ev) rec.error = "could not create event";
+}
+
+void buildAttendeeRecord(ParsedRecord& rec, const string& eventTitle, const string& name, const string& email, const string& phone, const string& company) {
+    if (eventTitle.empty() || (name.empty() && email.empty())) {
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = "attendee needs an event title and a name or email";
+        return;
+    }
+    if (!fitsDataFile(name) || !fitsDataFile(email) || !fitsDataFile(phone) || !fitsDataFile(company)) {
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = "attendee details cannot contain line breaks, '|' or '\\'";
+        return;
+    }
+    rec.kind = ParsedRecord::ATTENDEE;
+    rec.eventTitle = eventTitle;
+    rec.who = attendee(name, email, phone, company);
+}
+
+void parseRecord(const string& line, BulkFormat format, ParsedRecord& rec) {
+    if (line.empty() || line.find_first_not_of(" \t\r") == string::npos || line[0] == '#') {
+        rec.kind = ParsedRecord::SKIP;
+        return;
+    }
+    string error;
+    if (format == BULK_CSV) {
+        vector<string> f;
+        if (!splitCsvLine(line, f, error)) { rec.kind = ParsedRecord::INVALID; rec.error = error; return; }
+        if (f[0] == "kind") { rec.kind = ParsedRecord::SKIP; return; } // Header row
+        if (f[0] == "event" && f.size() == 8) { buildEventRecord(rec, f[1], f[2], f[3], f[4], f[5], f[6], f[7]); return; }
+        if (f[0] == "attendee" && f.size() == 6) { buildAttendeeRecord(rec, f[1], f[2], f[3], f[4], f[5]); return; }
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = "expected an event row (8 fields) or attendee row (6 fields)";
+        return;
+    }
+
+    vector<pair<string, string>> m;
+    if (!parseJsonObject(line, m, error)) { rec.kind = ParsedRecord::INVALID; rec.error = "bad JSON: " + error; return; }
+    const string* kind = member(m, "kind");
+    auto field = [&](const char* key) { const string* v = member(m, key); return v ? *v : string(); };
+    if (kind && *kind == "event") {
+        buildEventRecord(rec, field("type"), field("host"), field("title"), field("description"), field("dateAndTime"), field("platform"), field("capacity"));
+    } else if (kind && *kind == "attendee") {
+        buildAttendeeRecord(rec, field("event"), field("name"), field("email"), field("phone"), field("company"));
+    } else {
+        rec.kind = ParsedRecord::INVALID;
+        rec.error = "\"kind\" must be \"event\" or \"attendee\"";
+    }
+}
+
+// --- Record Writing ---
+string csvField(const string& value) {
+    bool needsQuotes = value.find_first_of(",\"\r\n") != string::npos ||
+                       (!value.empty() && (value.front() == ' ' || value.back() == ' '));
+    if (!needsQuotes) return value;
+    string out = "\"";
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+string jsonString(const string& value) {
+    string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+void writeEventRecord(ostream& out, const event& e, BulkFormat format) {
+    if (format == BULK_CSV) {
+        out << "event," << eventTypeName(e.getType()) << ',' << csvField(e.getHost()) << ',' << csvField(e.getTitle()) << ','
+            << csvField(e.getDescription()) << ',' << csvField(e.getdateAndTime()) << ',' << csvField(e.getvPlatform()) << ','
+            << e.getcapacity() << '\n';
+    } else {
+        out << "{\"kind\":\"event\",\"type\":\"" << eventTypeName(e.getType()) << "\",\"host\":" << jsonString(e.getHost())
+            << ",\"title\":" << jsonString(e.getTitle()) << ",\"description\":" << jsonString(e.getDescription())
+            << ",\"dateAndTime\":" << jsonString(e.getdateAndTime()) << ",\"platform\":" << jsonString(e.getvPlatform())
+            << ",\"capacity\":" << e.getcapacity() << "}\n";
+    }
+}
+
+void writeAttendeeRecord(ostream& out, const string& eventTitle, const attendee& a, BulkFormat format) {
+    if (format == BULK_CSV) {
+        out << "attendee," << csvField(eventTitle) << ',' << csvField(a.getName()) << ',' << csvField(a.getEmail()) << ','
+            << csvField(a.getPhoneNum()) << ',' << csvField(a.getcompanyOrSchool()) << '\n';
+    } else {
+        out << "{\"kind\":\"attendee\",\"event\":" << jsonString(eventTitle) << ",\"name\":" << jsonString(a.getName())
+            << ",\"email\":" << jsonString(a.getEmail()) << ",\"phone\":" << jsonString(a.getPhoneNum())
+            << ",\"company\":" << jsonString(a.getcompanyOrSchool()) << "}\n";
+    }
+}
+
+} // namespace
+
+bool parseEventType(const string& text, eventType& typeOut) {
+    string t = text;
+    transform(t.begin(), t.end(), t.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    if (t == "0" || t == "webinar") { typeOut = Webinar; return true; }
+    if (t == "1" || t == "conference") { typeOut = Conference; return true; }
+    if (t == "2" || t == "workshop") { typeOut = Workshop; return true; }
+    return false;
+}
+
+// --- Import Pipeline ---
+BulkImportResult importRecords(events& manager, istream& in, const BulkImportOptions& options) {
+    BulkImportResult result;
+    auto started = chrono::steady_clock::now();
+    const size_t batchSize = max<size_t>(1, options.batchSize);
+    unsigned threads = options.workerThreads ? options.workerThreads : thread::hardware_concurrency();
+    threads = max(1u, threads);
+
+    auto reject = [&](size_t lineNumber, const string& reason) {
+        ++result.rejected;
+        if (result.errors.size() < options.maxReportedErrors) {
+            result.errors.push_back("line " + to_string(lineNumber) + ": " + reason);
+        }
+    };
+
+    vector<string> lines;       // One record each: a CSV record with a quoted line break spans several lines (and is rejected whole)
+    vector<size_t> firstLines;  // Line number each record starts on
+    vector<ParsedRecord> parsed;
+    lines.reserve(batchSize);
+    firstLines.reserve(batchSize);
+    size_t lineNumber = 0;
+    bool more = true;
+    while (more) {
+        // Read one batch of records.
+        lines.clear();
+        firstLines.clear();
+        string line, next;
+        while (lines.size() < batchSize && (more = static_cast<bool>(getline(in, line)))) {
+            firstLines.push_back(++lineNumber);
+            if (options.format == BULK_CSV) {
+                // An unterminated quote stops joining at the cap or the end of input and is rejected as before.
+                while (line.size() < MAX_CSV_RECORD_BYTES && csvQuoteOpen(line) && getline(in, next)) {
+                    ++lineNumber;
+                    line += '\n';
+                    line += next;
+                }
+            }
+            lines.push_back(move(line));
+        }
+        if (lines.empty()) break;
+
+        // Validate and build records in parallel; each worker owns a contiguous slice.
+        parsed.assign(lines.size(), ParsedRecord());
+        unsigned workers = static_cast<unsigned>(min<size_t>(threads, (lines.size() + 255) / 256)); // Small batches stay on this thread
+        auto parseSlice = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                parsed[i].lineNumber = firstLines[i];
+                parseRecord(lines[i], options.format, parsed[i]);
+            }
+        };
+        if (workers <= 1) {
+            parseSlice(0, lines.size());
+        } else {
+            vector<thread> pool;
+            size_t per = (lines.size() + workers - 1) / workers;
+            for (unsigned w = 0; w < workers; ++w) {
+                size_t begin = w * per, end = min(lines.size(), begin + per);
+                if (begin < end) pool.emplace_back(parseSlice, begin, end);
+            }
+            for (auto& t : pool) t.join();
+        }
+
+        // Commit the batch in one call so the manager locks and re-indexes once.
+        events::ImportBatch batch;
+        vector<size_t> attendeeLines;
+        for (ParsedRecord& rec : parsed) {
+            switch (rec.kind) {
+                case ParsedRecord::SKIP: break;
+                case ParsedRecord::INVALID: ++result.records; reject(rec.lineNumber, rec.error); break;
+                case ParsedRecord::EVENT: ++result.records; batch.newEvents.push_back(rec.ev); rec.ev = nullptr; break;
+                case ParsedRecord::ATTENDEE:
+                    ++result.records;
+                    batch.attendees.emplace_back(move(rec.eventTitle), move(rec.who));
+                    attendeeLines.push_back(rec.lineNumber);
+                    break;
+            }
+        }
+        size_t eventsInBatch = batch.newEvents.size();
+        size_t attendeesAdded = 0;
+        vector<size_t> rejectedAttendees;
+        manager.importBatch(batch, attendeesAdded, rejectedAttendees);
+        result.eventsImported += eventsInBatch;
+        result.attendeesImported += attendeesAdded;
+        for (size_t idx : rejectedAttendees) {
+            reject(attendeeLines[idx], "no event with that exact title, or it is full");
+        }
+    }
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+// --- Export ---
+size_t exportEvents(const events& manager, ostream& out, BulkFormat format) {
+    size_t written = 0;
+    if (format == BULK_CSV) out << "kind,type,host,title,description,dateAndTime,platform,capacity\n";
+    manager.visitEvents([&](EventHandle, const event& e) {
+        writeEventRecord(out, e, format);
+        ++written;
+    });
+    return written;
+}
+
+size_t exportAttendees(const events& manager, ostream& out, BulkFormat format) {
+    size_t written = 0;
+    if (format == BULK_CSV) out << "kind,event,name,email,phone,company\n";
+    manager.visitEvents([&](EventHandle, const event& e) {
+        const string title = e.getTitle();
+        for (PersonId who : e.getAttendees()) {
+            writeAttendeeRecord(out, title, manager.getPerson(who), format);
+            ++written;
+        }
+    });
+    return written;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "app_logic.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// --- Bulk import / export of events and attendees ---
+// Records are one per line (a CSV record continues across line breaks inside
+// quotes), in either format:
+//
+// CSV (RFC 4180 quoting; a header row starting with "kind," and lines starting with '#' are skipped):
+//   event,<type>,<host>,<title>,<description>,<DD/MM/YYYY HH:MM>,<platform>,<capacity>
+//   attendee,<event title>,<name>,<email>,<phone>,<company>
+// NDJSON:
+//   {"kind":"event","type":"Workshop","host":"...","title":"...","description":"...","dateAndTime":"...","platform":"...","capacity":50}
+//   {"kind":"attendee","event":"...","name":"...","email":"...","phone":"...","company":"..."}
+//
+// <type> is Webinar, Conference or Workshop (or 0, 1, 2). Attendee rows are
+// matched to events by exact title, and may refer to events earlier in the same
+// input or already in the manager. A quoted CSV field that spans lines is read
+// as one record and reported at the line it starts on. Fields holding a line
+// break, '|' or '\' are rejected: the data file cannot store them (see
+// fitsDataFile). JSON \u escapes of surrogate pairs are combined into one code point.
+
+enum BulkFormat { BULK_CSV, BULK_NDJSON };
+
+struct BulkImportOptions {
+    BulkFormat format = BULK_CSV;
+    size_t batchSize = 8192;        // Records parsed and committed together
+    unsigned workerThreads = 0;     // Parallel validators per batch; 0 = hardware concurrency
+    size_t maxReportedErrors = 20;  // Further rejections are only counted
+};
+
+struct BulkImportResult {
+    size_t records = 0;             // Non-blank, non-comment lines read
+    size_t eventsImported = 0;
+    size_t attendeesImported = 0;
+    size_t rejected = 0;
+    std::vector<std::string> errors; // "line N: reason", at most maxReportedErrors
+    double seconds = 0;
+};
+
+// Streams records from `in` in batches: each batch is validated in parallel,
+// then committed with a single events::importBatch call.
+BulkImportResult importRecords(events& manager, std::istream& in, const BulkImportOptions& options = BulkImportOptions());
+
+// Stream every event / every attendee straight to `out` in the import format,
+// without building the list in memory. Return the number of records written.
+size_t exportEvents(const events& manager, std::ostream& out, BulkFormat format);
+size_t exportAttendees(const events& manager, std::ostream& out, BulkFormat format);
+
+// Parses "Webinar"/"Conference"/"Workshop" (any case) or "0"/"1"/"2".
+bool parseEventType(const std::string& text, eventType& typeOut);
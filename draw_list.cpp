@@ -0,0 +1,145 @@
+#include "draw_list.h"
+
+#include <algorithm>
+
+using namespace std;
+
+DrawList gDrawList;
+
+void DrawList::fillRect(const SDL_Rect& r, SDL_Color color) {
+    if (r.w <= 0 || r.h <= 0) return;
+    add({float(r.x), float(r.y), float(r.x + r.w), float(r.y + r.h), 0, 0, 0, 0, color, nullptr, 0, 0, 0, 0});
+}
+
+void DrawList::outlineRect(const SDL_Rect& r, SDL_Color color) {
+    fillRect({r.x, r.y, r.w, 1}, color);
+    fillRect({r.x, r.y + r.h - 1, r.w, 1}, color);
+    fillRect({r.x, r.y + 1, 1, r.h - 2}, color);
+    fillRect({r.x + r.w - 1, r.y + 1, 1, r.h - 2}, color);
+}
+
+void DrawList::texturedQuad(SDL_Texture* texture, int texW, int texH, const SDL_Rect& src, const SDL_Rect& dst, SDL_Color color) {
+    if (!texture || texW <= 0 || texH <= 0 || dst.w <= 0 || dst.h <= 0) return;
+    const float invW = 1.0f / texW, invH = 1.0f / texH;
+    add({float(dst.x), float(dst.y), float(dst.x + dst.w), float(dst.y + dst.h),
+         src.x * invW, src.y * invH, (src.x + src.w) * invW, (src.y + src.h) * invH,
+         color, texture, 0, 0, texW, texH});
+}
+
+void DrawList::setClip(const SDL_Rect* r) {
+    clipping = r != nullptr;
+    if (r) clip = *r;
+}
+
+void DrawList::add(Quad q) {
+    if (clipping) { // Trim to the clip rect, moving texture coordinates in proportion
+        const float cx0 = float(clip.x), cy0 = float(clip.y), cx1 = float(clip.x + clip.w), cy1 = float(clip.y + clip.h);
+        if (q.x1 <= cx0 || q.x0 >= cx1 || q.y1 <= cy0 || q.y0 >= cy1) return;
+        const float du = (q.u1 - q.u0) / (q.x1 - q.x0), dv = (q.v1 - q.v0) / (q.y1 - q.y0);
+        if (q.x0 < cx0) { q.u0 += (cx0 - q.x0) * du; q.x0 = cx0; }
+        if (q.x1 > cx1) { q.u1 -= (q.x1 - cx1) * du; q.x1 = cx1; }
+        if (q.y0 < cy0) { q.v0 += (cy0 - q.y0) * dv; q.y0 = cy0; }
+        if (q.y1 > cy1) { q.v1 -= (q.y1 - cy1) * dv; q.y1 = cy1; }
+    }
+    q.order = static_cast<uint32_t>(quads.size());
+    q.layer = currentLayer;
+    quads.push_back(q);
+}
+
+bool DrawList::geometrySupported() const {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    return !geometryFailed;
+#else
+    return false;
+#endif
+}
+
+void DrawList::flush(SDL_Renderer* renderer) {
+    lastStats = DrawStats();
+    lastStats.quads = static_cast<uint32_t>(quads.size());
+    currentLayer = 0;
+    if (!renderer || quads.empty()) { quads.clear(); return; }
+
+    // By layer; within one, shapes first, then one group per texture; recording order within each.
+    sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) {
+            if (!a.texture || !b.texture) return !a.texture;
+            return less<SDL_Texture*>()(a.texture, b.texture);
+        }
+        return a.order < b.order;
+    });
+
+    size_t begin = 0;
+    while (begin < quads.size()) {
+        size_t end = begin;
+        while (end < quads.size() && quads[end].texture == quads[begin].texture && quads[end].layer == quads[begin].layer) ++end;
+        bool drawn = false;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (!geometryFailed) {
+            vertices.clear();
+            indices.clear();
+            for (size_t i = begin; i < end; ++i) {
+                const Quad& q = quads[i];
+                const int base = static_cast<int>(vertices.size());
+                vertices.push_back({{q.x0, q.y0}, q.color, {q.u0, q.v0}});
+                vertices.push_back({{q.x1, q.y0}, q.color, {q.u1, q.v0}});
+                vertices.push_back({{q.x1, q.y1}, q.color, {q.u1, q.v1}});
+                vertices.push_back({{q.x0, q.y1}, q.color, {q.u0, q.v1}});
+                const int quad[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+            ++lastStats.drawCalls;
+            drawn = SDL_RenderGeometry(renderer, quads[begin].texture, vertices.data(), static_cast<int>(vertices.size()),
+                                       indices.data(), static_cast<int>(indices.size())) == 0;
+            if (!drawn) geometryFailed = true; // This renderer backend cannot draw geometry: fall back from now on
+        }
+#endif
+        if (!drawn) drawFallback(renderer, begin, end);
+        begin = end;
+    }
+    quads.clear();
+}
+
+// One texture group (or the shapes) without SDL_RenderGeometry: runs of
+// same-coloured fills go out as one SDL_RenderFillRects call, textured quads
+// as one SDL_RenderCopy each.
+void DrawList::drawFallback(SDL_Renderer* renderer, size_t begin, size_t end) {
+    auto toRect = [](float x0, float y0, float x1, float y1) {
+        return SDL_Rect{int(x0 + 0.5f), int(y0 + 0.5f), int(x1 - x0 + 0.5f), int(y1 - y0 + 0.5f)};
+    };
+    size_t i = begin;
+    while (i < end) {
+        const Quad& first = quads[i];
+        if (!first.texture) {
+            rects.clear();
+            size_t j = i;
+            for (; j < end && quads[j].color.r == first.color.r && quads[j].color.g == first.color.g &&
+                   quads[j].color.b == first.color.b && quads[j].color.a == first.color.a; ++j) {
+                rects.push_back(toRect(quads[j].x0, quads[j].y0, quads[j].x1, quads[j].y1));
+            }
+            SDL_SetRenderDrawColor(renderer, first.color.r, first.color.g, first.color.b, first.color.a);
+            SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+            ++lastStats.drawCalls;
+            i = j;
+            continue;
+        }
+        SDL_Color tint = first.color;
+        SDL_SetTextureColorMod(first.texture, tint.r, tint.g, tint.b);
+        SDL_SetTextureAlphaMod(first.texture, tint.a);
+        for (; i < end; ++i) {
+            const Quad& q = quads[i];
+            if (q.color.r != tint.r || q.color.g != tint.g || q.color.b != tint.b || q.color.a != tint.a) {
+                tint = q.color;
+                SDL_SetTextureColorMod(q.texture, tint.r, tint.g, tint.b);
+                SDL_SetTextureAlphaMod(q.texture, tint.a);
+            }
+            SDL_Rect src = toRect(q.u0 * q.texW, q.v0 * q.texH, q.u1 * q.texW, q.v1 * q.texH);
+            SDL_Rect dst = toRect(q.x0, q.y0, q.x1, q.y1);
+            SDL_RenderCopy(renderer, q.texture, &src, &dst);
+            ++lastStats.drawCalls;
+        }
+        SDL_SetTextureColorMod(first.texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(first.texture, 255);
+    }
+}
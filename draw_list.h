@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+
+// --- DrawList ---
+// Collects the frame's 2D primitives (filled rects and textured quads) instead
+// of issuing one SDL call per widget, then submits them in flush(): sorted so
+// that all solid shapes come first and textured quads follow grouped by
+// texture, each group going out as one SDL_RenderGeometry call. Text is always
+// drawn above shapes of the same layer, and every layer above the ones below it
+// (overlays use a higher layer than the screen); within a texture, primitives
+// keep the order they were recorded in. Renderers without geometry support (or SDL older than 2.0.18)
+// get the same primitives as SDL_RenderFillRects / SDL_RenderCopy calls.
+struct DrawStats {
+    uint32_t drawCalls = 0; // SDL draw calls issued by flush()
+    uint32_t quads = 0;     // Primitives submitted
+};
+
+class DrawList {
+public:
+    void fillRect(const SDL_Rect& r, SDL_Color color);
+    void outlineRect(const SDL_Rect& r, SDL_Color color); // One-pixel border, like SDL_RenderDrawRect
+    // `src` is in texels of a texW x texH texture; the quad is tinted by `color`.
+    void texturedQuad(SDL_Texture* texture, int texW, int texH, const SDL_Rect& src, const SDL_Rect& dst, SDL_Color color);
+    // Primitives recorded while a clip rect is set are cut to it (on the CPU, so
+    // clipping never splits a batch). Pass nullptr to stop clipping.
+    void setClip(const SDL_Rect* clip);
+    // Primitives recorded from now on draw above everything on lower layers.
+    // flush() returns to layer 0.
+    void setLayer(uint8_t layer) { currentLayer = layer; }
+
+    void flush(SDL_Renderer* renderer); // Submits everything recorded, then starts over
+    const DrawStats& lastFrameStats() const { return lastStats; }
+    bool geometrySupported() const;     // False once the renderer has rejected SDL_RenderGeometry
+
+private:
+    struct Quad {
+        float x0, y0, x1, y1; // Destination, in pixels
+        float u0, v0, u1, v1; // Normalized texture coordinates
+        SDL_Color color;
+        SDL_Texture* texture; // nullptr: solid colour
+        uint32_t order;       // Recording order, to keep the sort stable
+        uint8_t layer;
+        int texW, texH;       // For the SDL_RenderCopy fallback
+    };
+
+    std::vector<Quad> quads;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    std::vector<SDL_Rect> rects; // Fallback batch of same-coloured fills
+    bool clipping = false;
+    SDL_Rect clip = {0, 0, 0, 0};
+    uint8_t currentLayer = 0;
+    bool geometryFailed = false;
+    DrawStats lastStats;
+
+    void add(Quad q);
+    void drawFallback(SDL_Renderer* renderer, size_t begin, size_t end);
+};
+
+extern DrawList gDrawList; // The frame's draw list; main_loop_iteration flushes it before presenting
@@ -0,0 +1,278 @@
+#include "event_index.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+// --- TimeIndex Method Definitions ---
+void TimeIndex::insert(int64_t startTime, EventHandle h) {
+    pending.push_back(Entry{startTime, h});
+    if (pending.size() >= MERGE_THRESHOLD) {
+        mergePending();
+    }
+}
+
+void TimeIndex::insertBatch(const vector<pair<int64_t, EventHandle>>& entries) {
+    pending.reserve(pending.size() + entries.size());
+    insertDeferred(entries);
+    mergePending();
+}
+
+void TimeIndex::insertDeferred(const vector<pair<int64_t, EventHandle>>& entries) {
+    for (const auto& e : entries) pending.push_back(Entry{e.first, e.second});
+}
+
+void TimeIndex::erase(int64_t startTime, EventHandle h) {
+    auto p = find_if(pending.begin(), pending.end(), [&](const Entry& e) { return e.handle == h; });
+    if (p != pending.end()) { // Unsorted and short: swap with the last
+        *p = pending.back();
+        pending.pop_back();
+        return;
+    }
+    Entry key{startTime, h};
+    // A reused slot can hold a tombstone and a live entry under the same key.
+    for (auto it = lower_bound(sorted.begin(), sorted.end(), key); it != sorted.end() && !(key < *it); ++it) {
+        if (it->handle != h) continue;
+        it->handle.generation = 0;
+        ++erased;
+        for (size_t i = static_cast<size_t>(it - sorted.begin()) + 1; i < liveTree.size(); i += i & (~i + 1)) --liveTree[i];
+        return;
+    }
+}
+
+void TimeIndex::clear() {
+    sorted.clear();
+    pending.clear();
+    liveTree.clear();
+    erased = 0;
+}
+
+void TimeIndex::reserve(size_t n) {
+    sorted.reserve(n);
+    liveTree.reserve(n + 1);
+}
+
+size_t TimeIndex::size() const { return sorted.size() - erased + pending.size(); }
+
+void TimeIndex::mergePending() const {
+    bool compact = erased > 0 && erased * 4 >= sorted.size();
+    if (pending.empty() && !compact) return;
+    if (erased > 0) { // The merge is O(n) anyway
+        sorted.erase(remove_if(sorted.begin(), sorted.end(), [](const Entry& e) { return !e.handle.isValid(); }), sorted.end());
+        erased = 0;
+    }
+    sort(pending.begin(), pending.end());
+    size_t mid = sorted.size();
+    sorted.insert(sorted.end(), pending.begin(), pending.end());
+    inplace_merge(sorted.begin(), sorted.begin() + mid, sorted.end());
+    pending.clear();
+    rebuildTree();
+}
+
+void TimeIndex::rebuildTree() const {
+    const size_t n = sorted.size();
+    liveTree.assign(n + 1, 0);
+    for (size_t i = 1; i <= n; ++i) {
+        liveTree[i] += sorted[i - 1].handle.isValid() ? 1 : 0;
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= n) liveTree[parent] += liveTree[i];
+    }
+}
+
+size_t TimeIndex::positionOfLive(size_t n) const {
+    if (n >= sorted.size() - erased) return sorted.size();
+    size_t position = 0, remaining = n + 1, step = 1;
+    while (step * 2 < liveTree.size()) step *= 2;
+    for (; step > 0; step /= 2) {
+        if (position + step < liveTree.size() && liveTree[position + step] < remaining) {
+            position += step;
+            remaining -= liveTree[position];
+        }
+    }
+    return position; // The entry at 1-based position + 1
+}
+
+vector<EventHandle> TimeIndex::range(int64_t from, int64_t to, size_t limit) const {
+    mergePending();
+    vector<EventHandle> out;
+    auto it = lower_bound(sorted.begin(), sorted.end(), Entry{from, EventHandle{0, 0}});
+    for (; it != sorted.end() && it->time < to && out.size() < limit; ++it) {
+        if (it->handle.isValid()) out.push_back(it->handle);
+    }
+    return out;
+}
+
+vector<EventHandle> TimeIndex::upcoming(int64_t from, size_t count) const {
+    return range(from, UNKNOWN_EVENT_TIME, count);
+}
+
+vector<EventHandle> TimeIndex::slice(size_t offset, size_t limit) const {
+    mergePending();
+    vector<EventHandle> out;
+    size_t live = sorted.size() - erased;
+    if (offset >= live) return out;
+    out.reserve(min(limit, live - offset));
+    for (size_t i = positionOfLive(offset); i < sorted.size() && out.size() < limit; ++i) {
+        if (sorted[i].handle.isValid()) out.push_back(sorted[i].handle);
+    }
+    return out;
+}
+
+vector<EventHandle> TimeIndex::all() const {
+    mergePending();
+    vector<EventHandle> out;
+    out.reserve(sorted.size() - erased);
+    for (const Entry& e : sorted) {
+        if (e.handle.isValid()) out.push_back(e.handle);
+    }
+    return out;
+}
+
+// --- AvailabilityIndex Method Definitions ---
+void AvailabilityIndex::insert(EventHandle h, eventType type, int freeSeats) {
+    byType[type].insert(Entry{freeSeats, h});
+    overall.insert(Entry{freeSeats, h});
+    if (freeSeats > 0) ++open;
+}
+
+void AvailabilityIndex::update(EventHandle h, eventType type, int oldFreeSeats, int newFreeSeats) {
+    if (oldFreeSeats == newFreeSeats) return;
+    erase(h, type, oldFreeSeats);
+    insert(h, type, newFreeSeats);
+}
+
+void AvailabilityIndex::erase(EventHandle h, eventType type, int freeSeats) {
+    size_t removed = byType[type].erase(Entry{freeSeats, h});
+    overall.erase(Entry{freeSeats, h});
+    if (removed && freeSeats > 0) --open;
+}
+
+void AvailabilityIndex::clear() {
+    for (auto& entries : byType) entries.clear();
+    overall.clear();
+    open = 0;
+}
+
+vector<EventHandle> AvailabilityIndex::collect(const Entries& entries, int minFree, size_t limit) {
+    vector<EventHandle> out;
+    for (auto it = entries.rbegin(); it != entries.rend() && it->freeSeats >= minFree && out.size() < limit; ++it) {
+        out.push_back(it->handle);
+    }
+    return out;
+}
+
+vector<EventHandle> AvailabilityIndex::withFreeSeats(int minFree, size_t limit) const {
+    vector<EventHandle> out;
+    if (limit == 0) return out;
+    overall.forEachDescending(overall.size() - 1, [&](const Entry& e) {
+        if (e.freeSeats < minFree) return false;
+        out.push_back(e.handle);
+        return out.size() < limit;
+    });
+    return out;
+}
+
+vector<EventHandle> AvailabilityIndex::withFreeSeats(eventType type, int minFree, size_t limit) const {
+    return collect(byType[type], minFree, limit);
+}
+
+vector<EventHandle> AvailabilityIndex::openPage(size_t offset, size_t limit) const {
+    vector<EventHandle> out;
+    if (offset >= open || limit == 0) return out;
+    out.reserve(min(limit, open - offset));
+    overall.forEachDescending(overall.size() - 1 - offset, [&](const Entry& e) {
+        if (e.freeSeats <= 0) return false;
+        out.push_back(e.handle);
+        return out.size() < limit;
+    });
+    return out;
+}
+
+size_t AvailabilityIndex::openCount() const { return open; }
+
+// --- EventListing Method Definitions ---
+EventListing::Row* EventListing::find(EventHandle h) {
+    if (!h.isValid() || h.index >= rows.size() || rows[h.index].generation != h.generation) return nullptr;
+    return &rows[h.index];
+}
+
+const EventListing::Row* EventListing::find(EventHandle h) const {
+    return const_cast<EventListing*>(this)->find(h);
+}
+
+void EventListing::writeCount(Row& row, int attendees) {
+    row.text.resize(row.countAt);
+    row.text += to_string(attendees);
+    row.text += '/';
+    row.text += to_string(row.capacity);
+    row.text += ')';
+}
+
+void EventListing::set(EventHandle h, const string& title, const string& host, int attendees, int capacity) {
+    if (h.index >= rows.size()) rows.resize(h.index + 1);
+    Row& row = rows[h.index];
+    Row updated;
+    updated.generation = h.generation;
+    updated.text.reserve(title.size() + host.size() + 32);
+    updated.text = title;
+    updated.text += " (Host: ";
+    updated.text += host.empty() ? "N/A" : host;
+    updated.text += ", Cap: ";
+    updated.countAt = static_cast<uint32_t>(updated.text.size());
+    updated.capacity = capacity;
+    writeCount(updated, attendees);
+    if (row.generation == h.generation && row.text == updated.text) return; // An edit the listing does not show
+    updated.version = latest.fetch_add(1, memory_order_acq_rel) + 1;
+    memory_release(MEM_INDEXES, string_heap_bytes(row.text));
+    row = move(updated);
+    memory_add(MEM_INDEXES, string_heap_bytes(row.text)); // Measured after the move, which may keep row's old buffer
+}
+
+void EventListing::setCount(EventHandle h, int attendees) {
+    Row* row = find(h);
+    if (!row) return;
+    string count = to_string(attendees); // Fits the small-string buffer
+    size_t slash = row->text.find('/', row->countAt); // Title and host are before countAt
+    if (row->text.compare(row->countAt, slash - row->countAt, count) == 0) return;
+    size_t before = string_heap_bytes(row->text);
+    writeCount(*row, attendees);
+    memory_release(MEM_INDEXES, before);
+    memory_add(MEM_INDEXES, string_heap_bytes(row->text));
+    row->version = latest.fetch_add(1, memory_order_acq_rel) + 1;
+}
+
+void EventListing::erase(EventHandle h) {
+    Row* row = find(h);
+    if (!row) return;
+    memory_release(MEM_INDEXES, string_heap_bytes(row->text));
+    string().swap(row->text); // Frees the buffer; assigning an empty string would keep it
+    row->generation = 0;
+    row->version = 0;
+    latest.fetch_add(1, memory_order_acq_rel);
+}
+
+void EventListing::clear() {
+    for (const Row& row : rows) memory_release(MEM_INDEXES, string_heap_bytes(row.text));
+    Rows().swap(rows);
+    latest.fetch_add(1, memory_order_acq_rel);
+}
+
+const string* EventListing::text(EventHandle h) const {
+    const Row* row = find(h);
+    return row ? &row->text : nullptr;
+}
+
+void EventListing::read(const vector<EventHandle>& handles, vector<ListingRow>& out) const {
+    out.resize(handles.size());
+    for (size_t i = 0; i < handles.size(); ++i) {
+        const Row* row = find(handles[i]);
+        ListingRow& r = out[i];
+        uint64_t version = row ? row->version : 0;
+        if (r.handle == handles[i] && r.version == version) continue;
+        r.handle = handles[i];
+        r.version = version;
+        if (row) r.text = row->text;
+        else r.text.clear();
+    }
+}
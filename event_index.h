@@ -0,0 +1,255 @@
+#pragma once
+
+#include "event_types.h"
+#include "memory_accounting.h" // TrackedAllocator
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --- Secondary indexes maintained by `events` ---
+// These only hold handles; `events` owns the event objects and keeps every
+// index in step on create, delete and load.
+
+// Start time used for events whose date string could not be parsed. It sorts
+// after every real timestamp, so undated events list last and never fall
+// inside a bounded range query.
+const int64_t UNKNOWN_EVENT_TIME = std::numeric_limits<int64_t>::max();
+
+// Events ordered by start time. Inserts land in a small unsorted buffer that is
+// sorted and merged into the main run in one pass once it fills up (or before
+// the next query). A merge is O(n), so single inserts cost O(n / 64) amortized;
+// loads and imports pass all their events to insertBatch, one O(n log n) merge
+// (a load read over many steps defers each step's entries with insertDeferred).
+// Erase leaves a tombstone, found by binary search, and a Fenwick tree of live
+// entries keeps positional slices O(log n) to find; tombstones are dropped at
+// the next merge, or once they are a quarter of the run. Queries are a binary
+// search plus a walk over the k results.
+class TimeIndex {
+public:
+    void insert(int64_t startTime, EventHandle h);
+    void insertBatch(const std::vector<std::pair<int64_t, EventHandle>>& entries); // Merged in one pass
+    // Left unsorted until the next query, insert or insertBatch merges them.
+    void insertDeferred(const std::vector<std::pair<int64_t, EventHandle>>& entries);
+    void erase(int64_t startTime, EventHandle h); // O(log n)
+    void clear();
+    void reserve(size_t n);
+    size_t size() const;
+
+    // Events starting in [from, to), earliest first, at most `limit` of them.
+    std::vector<EventHandle> range(int64_t from, int64_t to, size_t limit = std::numeric_limits<size_t>::max()) const;
+    // The next `count` events starting at or after `from`.
+    std::vector<EventHandle> upcoming(int64_t from, size_t count) const;
+    // Every indexed event in chronological order (undated events last).
+    std::vector<EventHandle> all() const;
+    // `limit` events starting at position `offset` of the chronological order.
+    std::vector<EventHandle> slice(size_t offset, size_t limit) const;
+
+private:
+    struct Entry {
+        int64_t time;
+        EventHandle handle; // Generation 0: erased
+        bool operator<(const Entry& o) const {
+            if (time != o.time) return time < o.time;
+            return handle.index < o.handle.index; // Slot index breaks ties: each live slot appears once
+        }
+    };
+    static const size_t MERGE_THRESHOLD = 64;
+
+    // Merging is an internal reorganisation, so it is allowed from const queries.
+    typedef std::vector<Entry, TrackedAllocator<Entry, MEM_INDEXES>> Entries;
+    mutable Entries sorted;
+    mutable Entries pending;
+    mutable std::vector<uint32_t, TrackedAllocator<uint32_t, MEM_INDEXES>> liveTree; // Fenwick tree over sorted, 1-based: live entries
+    mutable size_t erased = 0; // Tombstones in sorted
+
+    void mergePending() const; // Also drops tombstones
+    void rebuildTree() const;
+    size_t positionOfLive(size_t n) const; // Position in sorted of the n-th live entry (from 0); sorted.size() if none
+};
+
+// A sorted sequence with positional access, kept as sorted blocks of at most
+// BLOCK entries. Insert and erase binary-search for the block and shift within
+// it, O(log n + BLOCK); reaching position p walks the block sizes from the
+// nearer end, O(n / BLOCK), then reads entries in order. Blocks below a quarter
+// full are merged into a neighbour. Storage is charged to Tag.
+template <typename T, MemoryTag Tag>
+class RankedList {
+public:
+    static const size_t BLOCK = 512;
+
+    size_t size() const { return count; }
+    void clear() { blocks.clear(); count = 0; }
+    void insert(const T& value);
+    bool erase(const T& value); // False if absent
+    // Calls fn(entry) from position `from` towards the front until fn returns false.
+    template <typename Fn> void forEachDescending(size_t from, Fn fn) const;
+
+private:
+    typedef std::vector<T, TrackedAllocator<T, Tag>> Block;
+    std::vector<Block, TrackedAllocator<Block, Tag>> blocks; // None empty
+    size_t count = 0;
+
+    size_t blockFor(const T& value) const; // First block whose last entry is not below value
+};
+
+template <typename T, MemoryTag Tag>
+size_t RankedList<T, Tag>::blockFor(const T& value) const {
+    return static_cast<size_t>(std::partition_point(blocks.begin(), blocks.end(),
+                                                    [&](const Block& b) { return b.back() < value; }) - blocks.begin());
+}
+
+template <typename T, MemoryTag Tag>
+void RankedList<T, Tag>::insert(const T& value) {
+    ++count;
+    if (blocks.empty()) {
+        blocks.emplace_back(1, value);
+        return;
+    }
+    size_t b = std::min(blockFor(value), blocks.size() - 1);
+    Block& block = blocks[b];
+    block.insert(std::lower_bound(block.begin(), block.end(), value), value);
+    if (block.size() > BLOCK) {
+        Block upper(block.begin() + block.size() / 2, block.end());
+        block.resize(block.size() / 2);
+        blocks.insert(blocks.begin() + b + 1, std::move(upper));
+    }
+}
+
+template <typename T, MemoryTag Tag>
+bool RankedList<T, Tag>::erase(const T& value) {
+    size_t b = blockFor(value);
+    if (b == blocks.size()) return false;
+    Block& block = blocks[b];
+    auto it = std::lower_bound(block.begin(), block.end(), value);
+    if (it == block.end() || value < *it) return false;
+    block.erase(it);
+    --count;
+    if (block.empty()) {
+        blocks.erase(blocks.begin() + b);
+    } else if (block.size() < BLOCK / 4 && blocks.size() > 1) {
+        size_t lo = b + 1 < blocks.size() ? b : b - 1;
+        if (blocks[lo].size() + blocks[lo + 1].size() <= BLOCK) {
+            blocks[lo].insert(blocks[lo].end(), blocks[lo + 1].begin(), blocks[lo + 1].end());
+            blocks.erase(blocks.begin() + lo + 1);
+        }
+    }
+    return true;
+}
+
+template <typename T, MemoryTag Tag>
+template <typename Fn>
+void RankedList<T, Tag>::forEachDescending(size_t from, Fn fn) const {
+    if (from >= count) return;
+    size_t b = 0, first = 0; // Block holding `from`, and the position of its first entry
+    if (from < count / 2) {
+        while (first + blocks[b].size() <= from) first += blocks[b++].size();
+    } else {
+        b = blocks.size() - 1;
+        first = count - blocks[b].size();
+        while (first > from) first -= blocks[--b].size();
+    }
+    size_t i = from - first;
+    for (;;) {
+        if (!fn(blocks[b][i])) return;
+        if (i > 0) {
+            --i;
+        } else if (b > 0) {
+            i = blocks[--b].size() - 1;
+        } else {
+            return;
+        }
+    }
+}
+
+// Events keyed by remaining seats, one ordered set per event type plus one
+// ranked list across all types. Updating an event's seat count is an erase and
+// re-insert; "events with at least m free seats" and "most available" queries
+// start at the top and walk only the k results they return, and openPage()
+// reaches any window of the open events without walking the ones before it.
+class AvailabilityIndex {
+public:
+    void insert(EventHandle h, eventType type, int freeSeats);
+    void update(EventHandle h, eventType type, int oldFreeSeats, int newFreeSeats);
+    void erase(EventHandle h, eventType type, int freeSeats);
+    void clear();
+
+    // Most free seats first. Pass limit to stop early.
+    std::vector<EventHandle> withFreeSeats(int minFree, size_t limit = std::numeric_limits<size_t>::max()) const;
+    std::vector<EventHandle> withFreeSeats(eventType type, int minFree, size_t limit = std::numeric_limits<size_t>::max()) const;
+    // Open events, most free seats first, positions [offset, offset + limit).
+    std::vector<EventHandle> openPage(size_t offset, size_t limit) const;
+    size_t openCount() const; // Events with at least one free seat
+
+private:
+    struct Entry {
+        int freeSeats;
+        EventHandle handle;
+        bool operator<(const Entry& o) const {
+            if (freeSeats != o.freeSeats) return freeSeats < o.freeSeats;
+            return handle.index < o.handle.index;
+        }
+    };
+
+    typedef std::set<Entry, std::less<Entry>, TrackedAllocator<Entry, MEM_INDEXES>> Entries;
+    Entries byType[EVENT_TYPE_COUNT];
+    RankedList<Entry, MEM_INDEXES> overall;
+    size_t open = 0;
+
+    static std::vector<EventHandle> collect(const Entries& entries, int minFree, size_t limit);
+};
+
+// One row of the event listing as shown: "Title (Host: X, Cap: a/b)".
+struct ListingRow {
+    EventHandle handle;
+    uint64_t version = 0; // Changes whenever the text does
+    std::string text;
+};
+
+// The listing row of every live event, by slot, kept formatted as events change
+// instead of rebuilt on every read: create and load add a row, delete removes
+// it, a sign-up rewrites only the count at its end, and an edit rebuilds it if
+// the text changed. Each change stamps the row with the next value of one
+// counter, so a (handle, version) pair identifies a row's text exactly and
+// version() moves whenever any row changes. Row text is charged to MEM_INDEXES.
+class EventListing {
+public:
+    EventListing() = default;
+    EventListing(const EventListing&) = delete;
+    EventListing& operator=(const EventListing&) = delete;
+    ~EventListing() { clear(); }
+
+    void set(EventHandle h, const std::string& title, const std::string& host, int attendees, int capacity); // Keeps the version if the text is unchanged
+    void setCount(EventHandle h, int attendees);
+    void erase(EventHandle h);
+    void clear();
+
+    uint64_t version() const { return latest.load(std::memory_order_acquire); } // Readable without the owner's lock
+    const std::string* text(EventHandle h) const; // nullptr if h has no row
+    // Row i of `out` becomes the row of handles[i] (empty text if it has none).
+    // Rows whose handle and version already match are left alone, so a caller
+    // that keeps `out` between reads copies only the text that changed.
+    void read(const std::vector<EventHandle>& handles, std::vector<ListingRow>& out) const;
+
+private:
+    struct Row {
+        uint32_t generation = 0; // 0: no row
+        uint32_t countAt = 0;    // Where the attendee count starts in text
+        int capacity = 0;
+        uint64_t version = 0;
+        std::string text;
+    };
+    typedef std::vector<Row, TrackedAllocator<Row, MEM_INDEXES>> Rows;
+    Rows rows;
+    std::atomic<uint64_t> latest{0};
+
+    Row* find(EventHandle h);
+    const Row* find(EventHandle h) const;
+    void writeCount(Row& row, int attendees); // Replaces text from countAt on
+};
@@ -0,0 +1,80 @@
+#include "event_snapshot.h"
+
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+// --- EpochReclaimer ---
+EpochReclaimer::~EpochReclaimer() {
+    for (auto& entry : retired) entry.second();
+    retired.clear();
+}
+
+EpochReclaimer::Guard EpochReclaimer::pin() {
+    // Start from a per-thread slot so threads rarely contend for the same one.
+    static thread_local size_t hint = hash<thread::id>()(this_thread::get_id());
+    while (true) {
+        for (size_t i = 0; i < READER_SLOTS; ++i) {
+            size_t s = (hint + i) % READER_SLOTS;
+            uint64_t expected = 0;
+            // Publishing an epoch that is already stale is harmless: it only holds back more.
+            if (readers[s].epoch.compare_exchange_strong(expected, globalEpoch.load())) {
+                return Guard(this, s);
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+EpochReclaimer::Guard::~Guard() {
+    if (owner) owner->readers[slot].epoch.store(0);
+}
+
+void EpochReclaimer::retire(function<void()> release) {
+    {
+        lock_guard<mutex> guard(retiredLock);
+        // Readers that pin from now on see the epoch after this one, and so can
+        // only have loaded what the writer published after unlinking.
+        retired.emplace_back(globalEpoch.fetch_add(1), move(release));
+    }
+    collect();
+}
+
+void EpochReclaimer::collect() {
+    vector<function<void()>> ready;
+    {
+        lock_guard<mutex> guard(retiredLock);
+        // Scan the readers only after the entries below were retired: a reader this
+        // scan misses pinned a later epoch, after those objects were unlinked.
+        uint64_t oldestPinned = numeric_limits<uint64_t>::max();
+        for (const ReaderSlot& r : readers) {
+            uint64_t e = r.epoch.load();
+            if (e != 0 && e < oldestPinned) oldestPinned = e;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); ++i) {
+            if (retired[i].first < oldestPinned) ready.push_back(move(retired[i].second));
+            else if (kept++ != i) retired[kept - 1] = move(retired[i]);
+        }
+        retired.resize(kept);
+    }
+    for (auto& release : ready) release(); // Outside the lock: releases may be slow
+}
+
+size_t EpochReclaimer::pendingCount() const {
+    lock_guard<mutex> guard(retiredLock);
+    return retired.size();
+}
+
+// --- EventSnapshot ---
+const EventRecord* EventSnapshot::find(EventHandle h) const {
+    if (!h.isValid()) return nullptr;
+    size_t chunk = h.index / SNAPSHOT_CHUNK_SIZE;
+    if (chunk >= chunks.size()) return nullptr;
+    const EventRecord& r = chunks[chunk]->records[h.index % SNAPSHOT_CHUNK_SIZE];
+    return (r.ev && r.handle == h) ? &r : nullptr;
+}
+
+PinnedSnapshot::PinnedSnapshot(EpochReclaimer& reclaimer, const atomic<const EventSnapshot*>& source) :
+    guard(reclaimer.pin()), snapshot(source.load()) {}
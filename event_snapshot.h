@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event_types.h" // eventType, EventHandle
+#include "memory_accounting.h" // TrackedAllocator, memory_release
+
+class event;
+
+// --- AppendOnlyList ---
+// Append-only list whose entries never move. Blocks double in size (8, 16, 32,
+// ...) and are never reallocated, so readers may walk the first size() entries
+// without a lock while one writer at a time appends. size() is published with
+// release ordering after the entry is written. Blocks are charged to
+// MEM_ATTENDEES: the lists hold event attendees and the person table.
+template <typename T>
+class AppendOnlyList {
+public:
+    class const_iterator {
+    public:
+        T operator*() const { return list->blocks[block][offset]; }
+        const_iterator& operator++() {
+            ++index;
+            if (++offset == blockSize) {
+                ++block;
+                offset = 0;
+                blockSize <<= 1;
+            }
+            return *this;
+        }
+        bool operator==(const const_iterator& o) const { return index == o.index; }
+        bool operator!=(const const_iterator& o) const { return index != o.index; }
+    private:
+        friend class AppendOnlyList;
+        const AppendOnlyList* list = nullptr;
+        size_t index = 0, block = 0, offset = 0, blockSize = 0;
+    };
+
+    AppendOnlyList() = default;
+    AppendOnlyList(const AppendOnlyList&) = delete;
+    AppendOnlyList& operator=(const AppendOnlyList&) = delete;
+    ~AppendOnlyList() { // Frees the blocks, not what the entries point to
+        for (size_t b = 0; b < MAX_BLOCKS; ++b) {
+            if (!blocks[b]) continue;
+            delete[] blocks[b];
+            memory_release(MEM_ATTENDEES, blockSize(b) * sizeof(T));
+        }
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    T operator[](size_t i) const {
+        size_t offset;
+        size_t block = blockOf(i, offset);
+        return blocks[block][offset];
+    }
+    const_iterator begin() const {
+        const_iterator it;
+        it.list = this;
+        it.blockSize = FIRST_BLOCK;
+        return it;
+    }
+    const_iterator end() const { // Entries appended after end() is taken are not visited
+        const_iterator it;
+        it.list = this;
+        it.index = size();
+        return it;
+    }
+
+    // Writers must be serialized by the caller (the event's shard lock).
+    void push_back(T value) {
+        size_t n = count.load(std::memory_order_relaxed);
+        size_t offset;
+        size_t block = blockOf(n, offset);
+        if (!blocks[block]) allocateBlock(block);
+        blocks[block][offset] = value;
+        count.store(n + 1, std::memory_order_release); // Publishes the entry (and its block) to readers
+    }
+    void reserve(size_t n) { // Allocates blocks so the first n entries need no allocation
+        if (n == 0) return;
+        size_t offset;
+        size_t last = blockOf(n - 1, offset);
+        for (size_t b = 0; b <= last; ++b) {
+            if (!blocks[b]) allocateBlock(b);
+        }
+    }
+
+private:
+    static const size_t FIRST_BLOCK = 8;
+    static const size_t MAX_BLOCKS = 28; // ~2 billion entries
+    T* blocks[MAX_BLOCKS] = {};
+    std::atomic<size_t> count{0};
+
+    // Block b holds entries [FIRST_BLOCK * (2^b - 1), FIRST_BLOCK * (2^(b+1) - 1)).
+    static size_t blockOf(size_t i, size_t& offset) {
+        unsigned long long q = i / FIRST_BLOCK + 1;
+        size_t block = 63 - __builtin_clzll(q); // floor(log2(q)); q >= 1
+        offset = i - FIRST_BLOCK * ((size_t(1) << block) - 1);
+        return block;
+    }
+    static size_t blockSize(size_t block) { return FIRST_BLOCK << block; }
+    void allocateBlock(size_t block) {
+        blocks[block] = new T[blockSize(block)];
+        memory_add(MEM_ATTENDEES, blockSize(block) * sizeof(T));
+    }
+};
+
+// An event's attendees, by person (4 bytes each). Appended under the event's shard lock.
+typedef AppendOnlyList<PersonId> AttendeeList;
+
+// --- Epoch-based reclamation ---
+// Readers pin the current epoch for the duration of a read. Writers unlink an
+// object, then retire it; it is freed once every reader that pinned at or
+// before the retiring epoch has unpinned. Pinning is one CAS on a reader slot.
+class EpochReclaimer {
+public:
+    class Guard {
+    public:
+        Guard(Guard&& other) noexcept : owner(other.owner), slot(other.slot) { other.owner = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+        ~Guard();
+    private:
+        friend class EpochReclaimer;
+        Guard(EpochReclaimer* o, size_t s) : owner(o), slot(s) {}
+        EpochReclaimer* owner;
+        size_t slot;
+    };
+
+    EpochReclaimer() = default;
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+    ~EpochReclaimer(); // Runs every pending free; no reader may still be pinned
+
+    Guard pin();
+    // `release` runs once no pinned reader can still reach the retired object.
+    void retire(std::function<void()> release);
+    void collect();           // Frees whatever is no longer reachable
+    size_t pendingCount() const;
+
+private:
+    static const size_t READER_SLOTS = 64; // Concurrent pins beyond this wait for a free slot
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0}; // 0: unused
+    };
+
+    ReaderSlot readers[READER_SLOTS];
+    std::atomic<uint64_t> globalEpoch{1};
+    mutable std::mutex retiredLock;
+    std::vector<std::pair<uint64_t, std::function<void()>>> retired; // (epoch retired in, release)
+};
+
+// --- Event snapshots ---
+// One immutable version of the event table. Records are grouped into
+// copy-on-write chunks of SNAPSHOT_CHUNK_SIZE slots: publishing a new version
+// rebuilds only the chunks whose slots changed and shares the rest with the
+// previous version. An event's own fields are never modified after it is
+// published, so records point at the event for everything but the title;
+// its attendee list is append-only, so a reader sees a consistent prefix.
+const size_t SNAPSHOT_CHUNK_SIZE = 64;
+
+struct EventRecord {
+    EventHandle handle;
+    const event* ev = nullptr; // nullptr: empty slot in this version
+    std::string title;         // Copied so title scans stay within the chunk
+    int64_t startTime = 0;
+    eventType type = Webinar;
+};
+
+// Chunks are allocated with TrackedAllocator<SnapshotChunk, MEM_SNAPSHOTS>;
+// the heap bytes of their title copies are charged by whoever fills them in.
+struct SnapshotChunk {
+    EventRecord records[SNAPSHOT_CHUNK_SIZE];
+    size_t titleBytes = 0; // Charged to MEM_SNAPSHOTS, released with the chunk
+    ~SnapshotChunk() { memory_release(MEM_SNAPSHOTS, titleBytes); }
+};
+
+struct EventSnapshot {
+    uint64_t version = 0;
+    size_t liveCount = 0;
+    // Chunk i covers slots [i*64, i*64+64)
+    std::vector<std::shared_ptr<const SnapshotChunk>, TrackedAllocator<std::shared_ptr<const SnapshotChunk>, MEM_SNAPSHOTS>> chunks;
+
+    EventSnapshot() { memory_add(MEM_SNAPSHOTS, sizeof(EventSnapshot)); }
+    ~EventSnapshot() { memory_release(MEM_SNAPSHOTS, sizeof(EventSnapshot)); }
+    EventSnapshot(const EventSnapshot&) = delete;
+    EventSnapshot& operator=(const EventSnapshot&) = delete;
+
+    const EventRecord* find(EventHandle h) const; // nullptr if h is not live in this version
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const { // Live records in slot order
+        for (const auto& chunk : chunks) {
+            for (const EventRecord& r : chunk->records) {
+                if (r.ev) fn(r);
+            }
+        }
+    }
+
+    // Resumable form of forEach for callers that bound the work per call: visits
+    // the live records in the next maxSlots slots from `position` and advances it.
+    // Returns true once every slot has been visited.
+    template <typename Fn>
+    bool forEachFrom(size_t& position, size_t maxSlots, Fn&& fn) const {
+        const size_t slotCount = chunks.size() * SNAPSHOT_CHUNK_SIZE;
+        const size_t end = maxSlots < slotCount - std::min(position, slotCount) ? position + maxSlots : slotCount;
+        for (; position < end; ++position) {
+            const EventRecord& r = chunks[position / SNAPSHOT_CHUNK_SIZE]->records[position % SNAPSHOT_CHUNK_SIZE];
+            if (r.ev) fn(r);
+        }
+        return position >= slotCount;
+    }
+};
+
+// A pinned snapshot. The version it points at, and every event it references,
+// stay valid until it is destroyed. Hold it only for the length of a read:
+// memory retired by writers meanwhile is not freed until it is released.
+class PinnedSnapshot {
+public:
+    PinnedSnapshot(EpochReclaimer& reclaimer, const std::atomic<const EventSnapshot*>& source);
+    PinnedSnapshot(PinnedSnapshot&&) = default;
+
+    const EventSnapshot& operator*() const { return *snapshot; }
+    const EventSnapshot* operator->() const { return snapshot; }
+
+private:
+    EpochReclaimer::Guard guard;
+    const EventSnapshot* snapshot;
+};
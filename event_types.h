@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Enum Definitions ---
+enum eventType { Webinar, Conference, Workshop };
+const int EVENT_TYPE_COUNT = 3;
+
+// --- Event Handles ---
+// Stable reference to an event owned by `events`: a slot index plus the slot's
+// generation. Deleting an event bumps its slot's generation, so a stale handle
+// never resolves to whatever event later reuses the slot.
+struct EventHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; // Generation 0 is never issued: a default handle is invalid
+
+    bool isValid() const { return generation != 0; }
+    bool operator==(const EventHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const EventHandle& o) const { return !(*this == o); }
+};
+
+// --- People ---
+// Index of a person in the manager's PersonTable (see person_table.h). Events
+// list their attendees by PersonId, so each person's details are kept once.
+typedef uint32_t PersonId;
@@ -0,0 +1,213 @@
+#include "events_api.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app_logic.h"
+#include "memory_accounting.h" // TrackedAllocator
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#define EVENTS_API_EXPORT EMSCRIPTEN_KEEPALIVE
+#else
+#define EVENTS_API_EXPORT
+#endif
+
+using namespace std;
+
+namespace {
+
+template <typename T> using Column = vector<T, TrackedAllocator<T, MEM_API_RESULTS>>;
+
+events* attachedManager = nullptr;
+unique_ptr<events> ownManager; // Until a manager is attached
+
+events& manager() {
+    if (attachedManager) return *attachedManager;
+    if (!ownManager) ownManager.reset(new events("")); // In memory: nothing loaded or saved
+    return *ownManager;
+}
+
+string lastMessage;
+
+// --- Result columns ---
+// Cleared, not freed, between results: a page that lists the same window
+// repeatedly does not reallocate.
+struct ResultColumns {
+    Column<uint32_t> handleIndex, handleGeneration;
+    Column<int32_t> type, capacity, attendees;
+    Column<double> startTime;
+    Column<uint32_t> titleStart, titleLength, titleByte, hostStart, hostLength, hostByte;
+    Column<char> strings;
+    uint32_t stringUnits = 0; // UTF-16 length of `strings` decoded
+    EventColumns header = {};
+
+    void clear() {
+        handleIndex.clear(); handleGeneration.clear();
+        type.clear(); capacity.clear(); attendees.clear();
+        startTime.clear();
+        titleStart.clear(); titleLength.clear(); titleByte.clear();
+        hostStart.clear(); hostLength.clear(); hostByte.clear();
+        strings.clear();
+        stringUnits = 0;
+    }
+    void reserve(size_t rows) {
+        handleIndex.reserve(rows); handleGeneration.reserve(rows);
+        type.reserve(rows); capacity.reserve(rows); attendees.reserve(rows);
+        startTime.reserve(rows);
+        titleStart.reserve(rows); titleLength.reserve(rows); titleByte.reserve(rows);
+        hostStart.reserve(rows); hostLength.reserve(rows); hostByte.reserve(rows);
+    }
+    void appendString(const string& s, Column<uint32_t>& start, Column<uint32_t>& length, Column<uint32_t>& byte);
+    void fill(const vector<EventHandle>& handles);
+};
+
+ResultColumns results;
+
+// Length of the UTF-8 sequence starting at s[i], or 0 if it is not valid UTF-8
+// (truncated, overlong, a surrogate or beyond U+10FFFF).
+size_t utf8SequenceLength(const string& s, size_t i) {
+    unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c < 0x80) return 1;
+    size_t length = (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+    if (length == 0 || i + length > s.size()) return 0;
+    uint32_t codePoint = c & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k) {
+        unsigned char next = static_cast<unsigned char>(s[i + k]);
+        if ((next & 0xC0) != 0x80) return 0;
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    static const uint32_t SMALLEST[5] = {0, 0, 0x80, 0x800, 0x10000};
+    if (codePoint < SMALLEST[length] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) return 0;
+    return length;
+}
+
+// Appends s and a NUL. Invalid bytes become U+FFFD here rather than in the
+// page's TextDecoder, so the UTF-16 offsets counted here match its output.
+void ResultColumns::appendString(const string& s, Column<uint32_t>& start, Column<uint32_t>& length, Column<uint32_t>& byte) {
+    byte.push_back(static_cast<uint32_t>(strings.size()));
+    start.push_back(stringUnits);
+    uint32_t units = 0;
+    for (size_t i = 0; i < s.size();) {
+        size_t n = utf8SequenceLength(s, i);
+        if (n == 0) {
+            static const char REPLACEMENT[] = "\xEF\xBF\xBD";
+            strings.insert(strings.end(), REPLACEMENT, REPLACEMENT + 3);
+            units += 1;
+            i += 1;
+            continue;
+        }
+        strings.insert(strings.end(), s.begin() + i, s.begin() + i + n);
+        units += n == 4 ? 2 : 1; // Beyond the BMP: a surrogate pair
+        i += n;
+    }
+    strings.push_back('\0');
+    length.push_back(units);
+    stringUnits += units + 1;
+}
+
+// Rows for `handles` from one pinned snapshot; handles deleted meanwhile are skipped.
+void ResultColumns::fill(const vector<EventHandle>& handles) {
+    clear();
+    reserve(handles.size());
+    events& m = manager();
+    {
+        PinnedSnapshot snap = m.snapshot();
+        for (const EventHandle& h : handles) {
+            const EventRecord* r = snap->find(h);
+            if (!r) continue;
+            const event& e = *r->ev;
+            handleIndex.push_back(h.index);
+            handleGeneration.push_back(h.generation);
+            type.push_back(r->type);
+            capacity.push_back(e.getcapacity());
+            attendees.push_back(e.getAttendeeCount());
+            startTime.push_back(r->startTime == UNKNOWN_EVENT_TIME ? NAN : static_cast<double>(r->startTime));
+            appendString(r->title, titleStart, titleLength, titleByte);
+            appendString(e.getHost(), hostStart, hostLength, hostByte);
+        }
+    }
+    header.rows = static_cast<uint32_t>(handleIndex.size());
+    header.totalEvents = static_cast<uint32_t>(m.size());
+    header.handleIndex = handleIndex.data();
+    header.handleGeneration = handleGeneration.data();
+    header.type = type.data();
+    header.capacity = capacity.data();
+    header.attendees = attendees.data();
+    header.startTime = startTime.data();
+    header.titleStart = titleStart.data();
+    header.titleLength = titleLength.data();
+    header.titleByte = titleByte.data();
+    header.hostStart = hostStart.data();
+    header.hostLength = hostLength.data();
+    header.hostByte = hostByte.data();
+    header.strings = strings.data();
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+}
+
+string text(const char* s) { return s ? string(s) : string(); }
+
+// JavaScript numbers to a row count, clamped: NaN and negatives are 0.
+size_t rowCount(double n) {
+    if (!(n > 0)) return 0;
+    return n >= 4294967295.0 ? 4294967295u : static_cast<size_t>(n);
+}
+
+} // namespace
+
+void events_api_attach(events* m) {
+    attachedManager = m;
+    results = ResultColumns(); // Frees the previous manager's rows
+}
+
+// --- Exported functions ---
+extern "C" {
+
+EVENTS_API_EXPORT const char* events_api_create(int type, const char* host, const char* title, const char* description,
+                                                const char* dateTime, const char* platform, const char* capacity) {
+    if (type < 0 || type >= EVENT_TYPE_COUNT) {
+        lastMessage = "Error: Unknown event type " + to_string(type) + ".";
+        return lastMessage.c_str();
+    }
+    lastMessage = manager().createEventForHost(text(host), static_cast<eventType>(type), text(title), text(description),
+                                               text(dateTime), text(platform), text(capacity));
+    return lastMessage.c_str();
+}
+
+EVENTS_API_EXPORT const char* events_api_sign_up(const char* title, const char* name, const char* email, const char* phone, const char* company) {
+    bool foundDirectly = false, foundSuggestion = false;
+    string message;
+    EventHandle suggestion;
+    if (text(name).empty() && text(email).empty()) {
+        lastMessage = manager().attemptSignUp(User::getInstance(), text(title), foundDirectly, foundSuggestion, message, suggestion);
+    } else {
+        lastMessage = manager().attemptSignUpAs(attendee(text(name), text(email), text(phone), text(company)), text(title),
+                                                foundDirectly, foundSuggestion, message, suggestion);
+    }
+    return lastMessage.c_str();
+}
+
+EVENTS_API_EXPORT const char* events_api_delete(const char* title) {
+    bool foundDirectly = false, foundSuggestion = false;
+    EventHandle suggestion;
+    lastMessage = manager().attemptDeleteEvent(text(title), foundDirectly, foundSuggestion, suggestion);
+    return lastMessage.c_str();
+}
+
+EVENTS_API_EXPORT int events_api_search(const char* query) {
+    results.fill(manager().searchEvents(text(query)));
+    return static_cast<int>(results.header.rows);
+}
+
+EVENTS_API_EXPORT int events_api_list(double offset, double limit) {
+    results.fill(manager().getEventsPage(rowCount(offset), rowCount(limit)));
+    return static_cast<int>(results.header.rows);
+}
+
+EVENTS_API_EXPORT const EventColumns* events_api_columns() {
+    return &results.header;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+class events;
+
+// --- JavaScript API ---
+// Lets the page drive the events core directly, next to the SDL canvas:
+// create, sign up, delete, search and list. Searches and listings do not return
+// rows one call at a time. They fill columns in WASM memory, one array per
+// field plus one UTF-8 string table, and the page reads them through typed-array
+// views: reading any number of rows costs one call into the module and one
+// TextDecoder pass. events_api.js (linked with --post-js) wraps this as
+// Module.eventsApi; tools/api_bench.js measures rows per second through it.
+//
+// The columns belong to the module. They stay valid until the next search or
+// list. Views over them are invalidated whenever the heap grows, which any call
+// into the module may do, so build fresh views after each search or list.
+// Everything here is called from the page's main thread.
+
+// The manager the API works on; main() attaches the GUI's. Until one is
+// attached (builds without the GUI, such as the benchmark), the API uses an
+// in-memory manager of its own. Pass nullptr before deleting the manager.
+void events_api_attach(events* manager);
+
+// Header of the last search or list result. On wasm32 every field is 32 bits
+// wide, so the page reads it as HEAPU32 words in this order (events_api.js
+// names the offsets). Every column holds `rows` entries.
+struct EventColumns {
+    uint32_t rows;
+    uint32_t totalEvents;              // Live events, for paging through the listing
+    const uint32_t* handleIndex;       // EventHandle of each row
+    const uint32_t* handleGeneration;
+    const int32_t* type;               // eventType: 0 Webinar, 1 Conference, 2 Workshop
+    const int32_t* capacity;
+    const int32_t* attendees;          // Seats taken
+    const double* startTime;           // Seconds since 1970-01-01 00:00 (wall clock); NaN if the date did not parse
+    // Strings are in `strings`, each followed by a NUL. *Start and *Length
+    // count UTF-16 code units of the whole table decoded at once, so
+    // text.substr(start, length) yields the field. *Byte is the field's byte
+    // offset, for UTF8ToString(strings + byte) when only a few rows are needed.
+    const uint32_t* titleStart;
+    const uint32_t* titleLength;
+    const uint32_t* titleByte;
+    const uint32_t* hostStart;
+    const uint32_t* hostLength;
+    const uint32_t* hostByte;
+    const char* strings;               // Valid UTF-8: invalid input bytes are stored as U+FFFD
+    uint32_t stringBytes;
+};
+
+// Exported to JavaScript (add each to EXPORTED_FUNCTIONS). The returned
+// messages are the ones the GUI shows ("Error: ..." on failure). They stay
+// valid until the next call.
+extern "C" {
+const char* events_api_create(int type, const char* host, const char* title, const char* description,
+                              const char* dateTime, const char* platform, const char* capacity);
+// By exact title. With no name and no email, signs up the user entered on the canvas.
+const char* events_api_sign_up(const char* title, const char* name, const char* email, const char* phone, const char* company);
+const char* events_api_delete(const char* title); // Exact title only; a near miss returns the "Did you mean" message and deletes nothing
+int events_api_search(const char* query);         // Fills the columns; returns the row count
+int events_api_list(double offset, double limit); // Rows [offset, offset + limit) of the chronological listing
+const EventColumns* events_api_columns();
+}
@@ -0,0 +1,79 @@
+// Module.eventsApi: the events core for the page, over the extern "C"
+// functions in events_api.h. Link with --post-js events_api.js; the code runs
+// inside the module, so HEAPU8 / HEAPU32 are always the current views.
+//
+//   const api = Module.eventsApi;
+//   api.create(0, 'Ada', 'Compilers 101', 'Intro', '01/10/2025 18:00', 'Zoom', 50);
+//   const page = api.list(0, 100);
+//   for (let i = 0; i < page.rows; ++i) console.log(page.title(i), page.attendees[i]);
+//
+// search() and list() return typed-array views straight over the module's
+// result columns: no per-row calls and no copies. A result is valid until the
+// next search() or list(), and only until then.
+Module['eventsApi'] = (function () {
+  // Field order of struct EventColumns, in 32-bit words.
+  const ROWS = 0, TOTAL = 1, HANDLE_INDEX = 2, HANDLE_GENERATION = 3, TYPE = 4, CAPACITY = 5, ATTENDEES = 6,
+        START_TIME = 7, TITLE_START = 8, TITLE_LENGTH = 9, TITLE_BYTE = 10, HOST_START = 11, HOST_LENGTH = 12,
+        HOST_BYTE = 13, STRINGS = 14, STRING_BYTES = 15;
+  const decoder = typeof TextDecoder !== 'undefined' ? new TextDecoder('utf-8', {ignoreBOM: true}) : null;
+
+  function message(name, types, args) {
+    return Module.ccall(name, 'string', types, args);
+  }
+
+  // Views over the columns the last search or list filled.
+  function result() {
+    const header = Module.ccall('events_api_columns', 'number', [], []) >>> 2;
+    const words = HEAPU32;
+    const rows = words[header + ROWS];
+    const buffer = HEAPU8.buffer;
+    const u32 = (field) => new Uint32Array(buffer, words[header + field], rows);
+    const i32 = (field) => new Int32Array(buffer, words[header + field], rows);
+    const stringsPtr = words[header + STRINGS], stringBytes = words[header + STRING_BYTES];
+    let text = null; // The whole string table, decoded on first use
+    const strings = () => {
+      if (text === null) {
+        let bytes = HEAPU8.subarray(stringsPtr, stringsPtr + stringBytes);
+        if (typeof SharedArrayBuffer !== 'undefined' && bytes.buffer instanceof SharedArrayBuffer) bytes = bytes.slice(); // TextDecoder refuses shared memory
+        text = decoder.decode(bytes);
+      }
+      return text;
+    };
+    const titleStart = u32(TITLE_START), titleLength = u32(TITLE_LENGTH), titleByte = u32(TITLE_BYTE);
+    const hostStart = u32(HOST_START), hostLength = u32(HOST_LENGTH), hostByte = u32(HOST_BYTE);
+    return {
+      rows: rows,
+      totalEvents: words[header + TOTAL],
+      handleIndex: u32(HANDLE_INDEX),
+      handleGeneration: u32(HANDLE_GENERATION),
+      type: i32(TYPE),
+      capacity: i32(CAPACITY),
+      attendees: i32(ATTENDEES),
+      startTime: new Float64Array(buffer, words[header + START_TIME], rows), // Seconds; NaN if unknown
+      titleStart: titleStart, titleLength: titleLength, titleByte: titleByte,
+      hostStart: hostStart, hostLength: hostLength, hostByte: hostByte,
+      stringsPtr: stringsPtr,
+      // Without TextDecoder, one UTF8ToString per field.
+      title: decoder ? (i) => strings().substr(titleStart[i], titleLength[i]) : (i) => UTF8ToString(stringsPtr + titleByte[i]),
+      host: decoder ? (i) => strings().substr(hostStart[i], hostLength[i]) : (i) => UTF8ToString(stringsPtr + hostByte[i]),
+    };
+  }
+
+  return {
+    create: (type, host, title, description, dateTime, platform, capacity) =>
+      message('events_api_create', ['number', 'string', 'string', 'string', 'string', 'string', 'string'],
+              [type, host, title, description, dateTime, platform, String(capacity)]),
+    signUp: (title, name, email, phone, company) => // No name and email: the user entered on the canvas
+      message('events_api_sign_up', ['string', 'string', 'string', 'string', 'string'],
+              [title, name || '', email || '', phone || '', company || '']),
+    remove: (title) => message('events_api_delete', ['string'], [title]),
+    search: (query) => {
+      Module.ccall('events_api_search', 'number', ['string'], [query]);
+      return result();
+    },
+    list: (offset, limit) => {
+      Module.ccall('events_api_list', 'number', ['number', 'number'], [offset, limit]);
+      return result();
+    },
+  };
+})();
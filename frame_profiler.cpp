@@ -0,0 +1,288 @@
+#include "frame_profiler.h"
+
+#ifdef FRAME_PROFILER
+
+#include "draw_list.h"
+#include "gui_utils.h"
+#include "text_renderer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// --- Ring buffer ---
+// Writers claim a slot with one fetch_add and publish it seqlock-style: the
+// sequence is zeroed, the fields written, then the sequence set to index + 1.
+// A reader accepts a slot only if it sees the same sequence before and after
+// copying it, so a slot being overwritten is skipped rather than torn.
+const size_t RING_SLOTS = 1 << 15; // Power of two
+const uint8_t SLOT_ZONE = 0, SLOT_COUNTER = 1;
+
+struct Slot {
+    atomic<uint64_t> sequence{0};
+    atomic<const char*> name{nullptr};
+    atomic<uint64_t> startNs{0};
+    atomic<uint64_t> endNs{0}; // Counter slots: the value
+    atomic<uint32_t> thread{0};
+    atomic<uint8_t> depth{0};
+    atomic<uint8_t> kind{SLOT_ZONE};
+};
+
+struct SlotCopy {
+    const char* name;
+    uint64_t startNs, endNs;
+    uint32_t thread;
+    uint8_t depth, kind;
+};
+
+Slot ring[RING_SLOTS];
+atomic<uint64_t> nextSlot{0};
+
+void writeSlot(const char* name, uint64_t startNs, uint64_t endNs, uint32_t thread, int depth, uint8_t kind) {
+    uint64_t index = nextSlot.fetch_add(1, memory_order_relaxed);
+    Slot& s = ring[index & (RING_SLOTS - 1)];
+    s.sequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s.name.store(name, memory_order_relaxed);
+    s.startNs.store(startNs, memory_order_relaxed);
+    s.endNs.store(endNs, memory_order_relaxed);
+    s.thread.store(thread, memory_order_relaxed);
+    s.depth.store(static_cast<uint8_t>(depth < 255 ? depth : 255), memory_order_relaxed);
+    s.kind.store(kind, memory_order_relaxed);
+    s.sequence.store(index + 1, memory_order_release);
+}
+
+bool readSlot(uint64_t index, SlotCopy& out) {
+    const Slot& s = ring[index & (RING_SLOTS - 1)];
+    if (s.sequence.load(memory_order_acquire) != index + 1) return false;
+    out.name = s.name.load(memory_order_relaxed);
+    out.startNs = s.startNs.load(memory_order_relaxed);
+    out.endNs = s.endNs.load(memory_order_relaxed);
+    out.thread = s.thread.load(memory_order_relaxed);
+    out.depth = s.depth.load(memory_order_relaxed);
+    out.kind = s.kind.load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return s.sequence.load(memory_order_relaxed) == index + 1;
+}
+
+atomic<uint32_t> nextThreadNumber{0};
+thread_local uint32_t threadNumber = nextThreadNumber.fetch_add(1) + 1; // 1 is the first thread to record
+thread_local int zoneDepth = 0;
+
+atomic<uint32_t> frameCounters[PROFILE_COUNTER_COUNT];
+const char* const COUNTER_NAMES[PROFILE_COUNTER_COUNT] = {"render_text calls", "texture uploads"};
+
+// --- Overlay figures ---
+// Taken from the last drawn frame; zones are summed by name (pointer), in the
+// order they were first seen.
+const size_t MAX_OVERLAY_ZONES = 16;
+const size_t FRAME_HISTORY = 120;
+
+struct ZoneTotal {
+    const char* name;
+    uint64_t ns;
+    uint32_t calls;
+};
+
+struct OverlayState {
+    bool shown = false;
+    bool drawnThisFrame = false;
+    uint64_t frameFirstSlot = 0;
+    double frameMs = 0;
+    uint32_t counters[PROFILE_COUNTER_COUNT] = {};
+    ZoneTotal zones[MAX_OVERLAY_ZONES] = {};
+    size_t zoneCount = 0;
+    double history[FRAME_HISTORY] = {}; // Drawn frame times, circular
+    size_t historyCount = 0;
+};
+OverlayState overlay;
+
+void summarizeFrame(uint64_t firstSlot, uint64_t endSlot, uint32_t thread) {
+    overlay.zoneCount = 0;
+    if (endSlot - firstSlot > RING_SLOTS) firstSlot = endSlot - RING_SLOTS;
+    SlotCopy slot;
+    for (uint64_t i = firstSlot; i < endSlot; ++i) {
+        if (!readSlot(i, slot) || slot.kind != SLOT_ZONE || slot.thread != thread) continue;
+        size_t z = 0;
+        while (z < overlay.zoneCount && overlay.zones[z].name != slot.name) ++z;
+        if (z == overlay.zoneCount) {
+            if (z == MAX_OVERLAY_ZONES) continue;
+            overlay.zones[z] = {slot.name, 0, 0};
+            ++overlay.zoneCount;
+        }
+        overlay.zones[z].ns += slot.endNs - slot.startNs;
+        ++overlay.zones[z].calls;
+    }
+}
+
+void appendJsonString(string& json, const char* text) {
+    json += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') json += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20) json += *c;
+    }
+    json += '"';
+}
+
+} // namespace
+
+// --- Recording ---
+uint64_t profiler_now_ns() {
+    static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count());
+}
+
+void profiler_record_zone(const char* name, uint64_t startNs, uint64_t endNs, int depth) {
+    writeSlot(name, startNs, endNs, threadNumber, depth, SLOT_ZONE);
+}
+
+void profiler_count(ProfileCounter counter) {
+    frameCounters[counter].fetch_add(1, memory_order_relaxed);
+}
+
+ProfileZone::ProfileZone(const char* zoneName) : name(zoneName), startNs(profiler_now_ns()) {
+    ++zoneDepth;
+}
+
+ProfileZone::~ProfileZone() {
+    --zoneDepth;
+    profiler_record_zone(name, startNs, profiler_now_ns(), zoneDepth);
+}
+
+ProfileFrame::ProfileFrame() : startNs(profiler_now_ns()) {
+    overlay.drawnThisFrame = false;
+    overlay.frameFirstSlot = nextSlot.load(memory_order_relaxed);
+    for (atomic<uint32_t>& c : frameCounters) c.store(0, memory_order_relaxed);
+    ++zoneDepth;
+}
+
+ProfileFrame::~ProfileFrame() {
+    --zoneDepth;
+    uint64_t endNs = profiler_now_ns();
+    if (!overlay.drawnThisFrame) return; // Idle iterations keep their zones in the ring, but not the overlay
+    profiler_record_zone("frame", startNs, endNs, zoneDepth);
+    summarizeFrame(overlay.frameFirstSlot, nextSlot.load(memory_order_relaxed), threadNumber);
+    overlay.frameMs = (endNs - startNs) / 1e6;
+    overlay.history[overlay.historyCount++ % FRAME_HISTORY] = overlay.frameMs;
+    for (int c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+        overlay.counters[c] = frameCounters[c].load(memory_order_relaxed);
+        writeSlot(COUNTER_NAMES[c], endNs, overlay.counters[c], threadNumber, 0, SLOT_COUNTER);
+    }
+}
+
+void profiler_frame_drawn() {
+    overlay.drawnThisFrame = true;
+}
+
+// --- Overlay ---
+void profiler_render_overlay() {
+    if (!overlay.shown) return;
+    PROFILE_ZONE("profiler_overlay");
+    const int LINE_HEIGHT = 20, WIDTH = 330, MAX_LINES = 3 + MAX_OVERLAY_ZONES;
+    static string lines[MAX_LINES];
+    static bool reserved = false;
+    if (!reserved) { // Once, so that drawing the overlay does not allocate afterwards
+        for (string& line : lines) line.reserve(96);
+        reserved = true;
+    }
+    char buffer[96];
+    size_t count = 0;
+    double avg = 0, worst = 0;
+    size_t frames = overlay.historyCount < FRAME_HISTORY ? overlay.historyCount : FRAME_HISTORY;
+    for (size_t i = 0; i < frames; ++i) {
+        avg += overlay.history[i];
+        if (overlay.history[i] > worst) worst = overlay.history[i];
+    }
+    if (frames > 0) avg /= frames;
+    snprintf(buffer, sizeof(buffer), "frame %.2f ms (avg %.2f, max %.2f of %zu)", overlay.frameMs, avg, worst, frames);
+    lines[count++].assign(buffer);
+    snprintf(buffer, sizeof(buffer), "render_text %u, texture uploads %u",
+             overlay.counters[PROFILE_RENDER_TEXT_CALLS], overlay.counters[PROFILE_TEXTURE_UPLOADS]);
+    lines[count++].assign(buffer);
+    for (size_t z = 0; z < overlay.zoneCount && count < MAX_LINES; ++z) {
+        snprintf(buffer, sizeof(buffer), "  %-22s %7.3f ms x%u", overlay.zones[z].name, overlay.zones[z].ns / 1e6, overlay.zones[z].calls);
+        lines[count++].assign(buffer);
+    }
+    lines[count++].assign("F3 hide, F4 export trace");
+
+    SDL_Rect box = {SCREEN_WIDTH - WIDTH - 10, 10, WIDTH, static_cast<int>(count) * LINE_HEIGHT + 10};
+    gDrawList.setLayer(1); // Above the screen's labels and rows
+    gDrawList.fillRect(box, {255, 255, 225, 255});
+    gDrawList.outlineRect(box, {TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, 255});
+    for (size_t i = 0; i < count; ++i) { // Not through render_text, so the overlay is not in its own call count
+        int y = box.y + 5 + static_cast<int>(i) * LINE_HEIGHT;
+        if (!render_text_atlas(lines[i], box.x + 8, y, TEXT_COLOR, false, 0)) render_text_cached(lines[i], box.x + 8, y, TEXT_COLOR, false, 0);
+    }
+    gDrawList.setLayer(0);
+}
+
+// --- Export ---
+bool profiler_export_chrome_trace(string& json) {
+    uint64_t end = nextSlot.load(memory_order_acquire);
+    uint64_t begin = end > RING_SLOTS ? end - RING_SLOTS : 0;
+    json.clear();
+    json.reserve(static_cast<size_t>(end - begin) * 96 + 64);
+    json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char buffer[128];
+    SlotCopy slot;
+    for (uint64_t i = begin; i < end; ++i) {
+        if (!readSlot(i, slot) || !slot.name) continue;
+        json += first ? "\n{\"name\":" : ",\n{\"name\":";
+        appendJsonString(json, slot.name);
+        if (slot.kind == SLOT_ZONE) {
+            snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                     slot.startNs / 1e3, (slot.endNs - slot.startNs) / 1e3, slot.thread);
+        } else {
+            snprintf(buffer, sizeof(buffer), ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%llu}}",
+                     slot.startNs / 1e3, static_cast<unsigned long long>(slot.endNs));
+        }
+        json += buffer;
+        first = false;
+    }
+    json += "\n]}\n";
+    return !first;
+}
+
+static void export_trace() {
+    string json;
+    if (!profiler_export_chrome_trace(json)) { cout << "Profiler: nothing recorded yet." << endl; return; }
+#ifdef __EMSCRIPTEN__
+    EM_ASM({
+        var blob = new Blob([UTF8ToString($0, $1)], {type: 'application/json'});
+        var link = document.createElement('a');
+        link.href = URL.createObjectURL(blob); link.download = UTF8ToString($2);
+        document.body.appendChild(link); link.click(); document.body.removeChild(link);
+        setTimeout(function() { URL.revokeObjectURL(link.href); }, 0);
+    }, json.c_str(), json.size(), PROFILE_TRACE_FILE);
+    cout << "Profiler: trace offered as " << PROFILE_TRACE_FILE << " (" << json.size() << " bytes)." << endl;
+#else
+    ofstream out(PROFILE_TRACE_FILE, ios::trunc);
+    if (!(out << json)) { cerr << "Error: Could not write " << PROFILE_TRACE_FILE << "." << endl; return; }
+    cout << "Profiler: wrote " << PROFILE_TRACE_FILE << " (" << json.size() << " bytes)." << endl;
+#endif
+}
+
+bool profiler_handle_key(SDL_Keycode key) {
+    if (key == SDLK_F3) {
+        overlay.shown = !overlay.shown;
+        return true;
+    }
+    if (key == SDLK_F4) {
+        export_trace();
+        return true;
+    }
+    return false;
+}
+
+#endif // FRAME_PROFILER
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+
+// --- Frame profiler ---
+// Scoped timing zones and per-frame counters for the GUI, built only when
+// FRAME_PROFILER is defined (add -DFRAME_PROFILER to the build line). Without
+// it every macro below expands to nothing and every function is an empty
+// inline, so instrumented code compiles exactly as if it were not there.
+//
+// Zones are recorded into a fixed lock-free ring buffer (any thread may record;
+// a slot is claimed with one atomic increment), so a frame costs no heap
+// allocation. F3 toggles an overlay with the last drawn frame's time, the cost
+// of each zone in it, render_text calls and texture uploads. F4 exports the
+// ring as Chrome trace-event JSON (chrome://tracing, Perfetto): written to
+// PROFILE_TRACE_FILE natively, offered as a download in the browser.
+//
+//   void render_thing() {
+//       PROFILE_ZONE("render_thing"); // Until the end of the scope
+//       ...
+//       PROFILE_COUNT(PROFILE_TEXTURE_UPLOADS);
+//   }
+enum ProfileCounter {
+    PROFILE_RENDER_TEXT_CALLS,
+    PROFILE_TEXTURE_UPLOADS,
+    PROFILE_COUNTER_COUNT
+};
+
+#ifdef FRAME_PROFILER
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() ProfileFrame PROFILE_CONCAT(profileFrame, __LINE__)
+#define PROFILE_COUNT(counter) profiler_count(counter)
+
+const char* const PROFILE_TRACE_FILE = "profile_trace.json";
+
+uint64_t profiler_now_ns();
+// `name` must outlive the profiler (a string literal): only the pointer is stored.
+void profiler_record_zone(const char* name, uint64_t startNs, uint64_t endNs, int depth);
+void profiler_count(ProfileCounter counter);
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* zoneName);
+    ~ProfileZone();
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+// One main loop iteration. The overlay's figures are taken from the last
+// iteration that drew (profiler_frame_drawn() was called in it).
+class ProfileFrame {
+public:
+    ProfileFrame();
+    ~ProfileFrame();
+    ProfileFrame(const ProfileFrame&) = delete;
+    ProfileFrame& operator=(const ProfileFrame&) = delete;
+
+private:
+    uint64_t startNs;
+};
+
+void profiler_frame_drawn();
+bool profiler_handle_key(SDL_Keycode key); // F3 / F4; true if the key was the profiler's
+void profiler_render_overlay();            // Records the overlay into gDrawList if it is shown
+bool profiler_export_chrome_trace(std::string& json); // The ring's zones and counters, oldest first
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_COUNT(counter) ((void)0)
+
+inline void profiler_frame_drawn() {}
+inline bool profiler_handle_key(SDL_Keycode) { return false; }
+inline void profiler_render_overlay() {}
+inline bool profiler_export_chrome_trace(std::string&) { return false; }
+
+#endif
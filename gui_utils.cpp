@@ -1,4 +1,8 @@
 #include "gui_utils.h" // This now brings in the extern declarations
+#include "text_renderer.h"
+#include "draw_list.h"
+#include "frame_profiler.h"
+#include <algorithm>
 #include <iostream> 
 
 // The extern declarations for gRenderer, gFont, SCREEN_WIDTH, colors etc.,
@@ -16,52 +20,105 @@ InputField::InputField(int x, int y, int w, int h, std::string p)
     rect = {x, y, w, h};
 }
 
+Label::Label(std::string t, int x_, int y_, SDL_Color c, bool ctr, int wrap)
+    : text(std::move(t)), x(x_), y(y_), color(c), center(ctr), wrapWidth(wrap) {}
 
-// --- GUI Function Definitions ---
-void render_text(const std::string& text, int x, int y, SDL_Color color, bool center, int wrapWidth) { 
-    if (!gRenderer) { return; }
-    if (!gFont) { std::cerr << "render_text: gFont is null! Cannot render: " << text.substr(0,50) << std::endl; return; }
-    if (text.empty()) { return; }
+void Screen::clear() {
+    labels.clear();
+    fields.clear();
+    buttons.clear();
+    list = nullptr;
+}
 
-    SDL_Surface* textSurface = nullptr;
-    if (wrapWidth > 0) {
-        textSurface = TTF_RenderText_Blended_Wrapped(gFont, text.c_str(), color, wrapWidth);
-    } else {
-        textSurface = TTF_RenderText_Blended(gFont, text.c_str(), color);
-    }
-    
-    if (!textSurface) {
-        std::cerr << "Unable to render text surface! SDL_ttf Error: " << TTF_GetError() << " for text: " << text.substr(0,50) << std::endl;
-        return;
-    }
+VirtualList::VirtualList(int x, int y, int w, int h, int rowH) : rowHeight(rowH) {
+    rect = {x, y, w, h};
+}
+
+size_t VirtualList::visibleRows() const {
+    return rowHeight > 0 ? static_cast<size_t>(rect.h / rowHeight) : 0;
+}
 
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(gRenderer, textSurface);
-    if (!textTexture) {
-        std::cerr << "Unable to create texture from rendered text! SDL Error: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(textSurface);
-        return;
+void VirtualList::reset(size_t count) {
+    rowCount = count;
+    firstRow = 0;
+    invalidateRows();
+}
+
+void VirtualList::invalidateRows() {
+    cachedRows.clear();
+    cacheValid = false;
+}
+
+void VirtualList::refresh(size_t count) {
+    rowCount = count;
+    scrollTo(firstRow); // Clamps to the new end
+    invalidateRows();
+}
+
+bool VirtualList::scrollTo(size_t row) {
+    size_t visible = visibleRows();
+    size_t lastFirst = rowCount > visible ? rowCount - visible : 0;
+    if (row > lastFirst) row = lastFirst;
+    if (row == firstRow) return false;
+    firstRow = row;
+    return true;
+}
+
+bool VirtualList::scrollBy(long rows) {
+    if (rows < 0 && static_cast<size_t>(-rows) > firstRow) return scrollTo(0);
+    return scrollTo(firstRow + rows);
+}
+
+bool VirtualList::handleKey(SDL_Keycode key) {
+    long page = static_cast<long>(visibleRows() > 1 ? visibleRows() - 1 : 1);
+    switch (key) {
+        case SDLK_UP: return scrollBy(-1);
+        case SDLK_DOWN: return scrollBy(1);
+        case SDLK_PAGEUP: return scrollBy(-page);
+        case SDLK_PAGEDOWN: return scrollBy(page);
+        case SDLK_HOME: return scrollTo(0);
+        case SDLK_END: return scrollTo(rowCount);
+        default: return false;
     }
+}
 
-    int textW = textSurface->w;
-    int textH = textSurface->h;
-    
-    SDL_Rect renderQuad = {x, y, textW, textH};
-    if (center) {
-        renderQuad.x = (SCREEN_WIDTH - textW) / 2; 
+const std::string* VirtualList::row(size_t index) {
+    if (index >= rowCount) return nullptr;
+    if (!cacheValid || index < cacheBegin || index >= cacheBegin + cachedRows.size()) {
+        if (!fetchRows) return nullptr;
+        size_t begin = firstRow > PREFETCH_ROWS ? firstRow - PREFETCH_ROWS : 0;
+        if (index < begin) begin = index;
+        size_t limit = visibleRows() + 2 * PREFETCH_ROWS;
+        fetchRows(begin, limit, cachedRows);
+        cacheBegin = begin;
+        cacheValid = true;
+        if (index >= cacheBegin + cachedRows.size()) return nullptr; // The data shrank since rowCount was set
     }
+    return &cachedRows[index - cacheBegin];
+}
+
 
-    SDL_FreeSurface(textSurface); 
+// --- GUI Function Definitions ---
+void render_text(const std::string& text, int x, int y, SDL_Color color, bool center, int wrapWidth) { 
+    PROFILE_ZONE("render_text");
+    PROFILE_COUNT(PROFILE_RENDER_TEXT_CALLS);
+    if (!gRenderer) { return; }
+    if (!gFont) { std::cerr << "render_text: gFont is null! Cannot render: " << text.substr(0,50) << std::endl; return; }
+    if (text.empty()) { return; }
+    if (render_text_atlas(text, x, y, color, center, wrapWidth)) { return; }
+    render_text_cached(text, x, y, color, center, wrapWidth); // Older SDL or no geometry support
+}
 
-    SDL_RenderCopy(gRenderer, textTexture, nullptr, &renderQuad);
-    SDL_DestroyTexture(textTexture);
+void render_label(const Label& label) {
+    render_text(label.text, label.x, label.y, label.color, label.center, label.wrapWidth);
 }
 
 void render_button(Button& button) {
+    PROFILE_ZONE("render_button");
     if (!gRenderer) return;
 
     SDL_Color colorToUse = button.hovered ? BUTTON_HOVER_COLOR : BUTTON_COLOR;
-    SDL_SetRenderDrawColor(gRenderer, colorToUse.r, colorToUse.g, colorToUse.b, colorToUse.a);
-    SDL_RenderFillRect(gRenderer, &button.rect);
+    gDrawList.fillRect(button.rect, colorToUse);
 
     if (gFont && !button.text.empty()) {
       int text_h = TTF_FontHeight(gFont);
@@ -75,33 +132,88 @@ void render_button(Button& button) {
 }
 
 void render_input_field(const InputField& field) {
+    PROFILE_ZONE("render_input_field");
     if (!gRenderer) return;
 
-    SDL_SetRenderDrawColor(gRenderer, INPUT_BG_COLOR.r, INPUT_BG_COLOR.g, INPUT_BG_COLOR.b, INPUT_BG_COLOR.a);
-    SDL_RenderFillRect(gRenderer, &field.rect);
+    gDrawList.fillRect(field.rect, INPUT_BG_COLOR);
 
     if (field.isActive) {
-        SDL_SetRenderDrawColor(gRenderer, TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, 255); 
-        SDL_RenderDrawRect(gRenderer, &field.rect);
+        gDrawList.outlineRect(field.rect, {TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, 255});
     }
 
     if (gFont) {
-        std::string displayText = field.text; 
         int text_h = TTF_FontHeight(gFont);
         int text_y = field.rect.y + (field.rect.h - text_h) / 2; 
 
         if (field.text.empty() && !field.isActive && !field.placeholder.empty()) {
-            displayText = field.placeholder;
-            render_text(displayText, field.rect.x + 5, text_y, {128, 128, 128, 255}); 
+            render_text(field.placeholder, field.rect.x + 5, text_y, {128, 128, 128, 255}, false, 0); 
         } else {
-             render_text(displayText + (field.isActive ? "_" : ""), field.rect.x + 5, text_y, TEXT_COLOR); 
+            // The cursor is drawn after the text rather than appended to a copy of it.
+            static const std::string cursor = "_";
+            int text_w = 0, text_line_h = 0;
+            if (measure_text_atlas(field.text, 0, text_w, text_line_h) &&
+                render_text_atlas(field.text, field.rect.x + 5, text_y, TEXT_COLOR, false, 0)) {
+                if (field.isActive) render_text_atlas(cursor, field.rect.x + 5 + text_w, text_y, TEXT_COLOR, false, 0);
+            } else {
+                text_w = render_text_cached(field.text, field.rect.x + 5, text_y, TEXT_COLOR, false, 0);
+                if (field.isActive) render_text_cached(cursor, field.rect.x + 5 + text_w, text_y, TEXT_COLOR, false, 0);
+            }
         }
     }
 }
 
+void render_virtual_list(VirtualList& list) {
+    PROFILE_ZONE("render_virtual_list");
+    if (!gRenderer) return;
+    gDrawList.setClip(&list.rect); // Long rows are cut at the list's edge rather than wrapped
+    size_t end = std::min(list.rowCount, list.firstRow + list.visibleRows());
+    for (size_t i = list.firstRow; i < end; ++i) {
+        const std::string* text = list.row(i);
+        if (!text) break;
+        render_text(*text, list.rect.x, list.rect.y + static_cast<int>(i - list.firstRow) * list.rowHeight, TEXT_COLOR);
+    }
+    gDrawList.setClip(nullptr);
+
+    size_t visible = list.visibleRows();
+    if (list.rowCount > visible && list.rowCount > 0) { // Scrollbar along the right edge
+        SDL_Rect track = {list.rect.x + list.rect.w - 6, list.rect.y, 6, list.rect.h};
+        int thumbH = std::max(20, static_cast<int>(static_cast<double>(list.rect.h) * visible / list.rowCount));
+        int thumbY = track.y + static_cast<int>(static_cast<double>(track.h - thumbH) * list.firstRow / (list.rowCount - visible));
+        SDL_Rect thumb = {track.x, thumbY, track.w, thumbH};
+        gDrawList.fillRect(track, INPUT_BG_COLOR);
+        gDrawList.fillRect(thumb, BUTTON_COLOR);
+    }
+}
+
 void update_button_hover(int mouseX, int mouseY, std::vector<Button>& buttons) { 
     for (auto& button : buttons) { 
         button.hovered = (mouseX >= button.rect.x && mouseX <= button.rect.x + button.rect.w &&
                           mouseY >= button.rect.y && mouseY <= button.rect.y + button.rect.h);
     }
 }
+
+bool button_hover_would_change(int mouseX, int mouseY, const std::vector<Button>& buttons) {
+    for (const auto& button : buttons) {
+        bool over = (mouseX >= button.rect.x && mouseX <= button.rect.x + button.rect.w &&
+                     mouseY >= button.rect.y && mouseY <= button.rect.y + button.rect.h);
+        if (over != button.hovered) return true;
+    }
+    return false;
+}
+
+// --- Redraw scheduling ---
+static bool redrawRequested = true; // The first frame always draws
+
+void request_redraw() {
+    redrawRequested = true;
+}
+
+bool redraw_requested() {
+    return redrawRequested;
+}
+
+bool take_redraw_request() {
+    bool requested = redrawRequested;
+    redrawRequested = false;
+    return requested;
+}
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -41,12 +43,80 @@ struct InputField {
     InputField(int x, int y, int w, int h, std::string p);
 };
 
+struct Label {
+    std::string text;
+    int x, y;
+    SDL_Color color;
+    bool center;
+    int wrapWidth;
+
+    Label(std::string t, int x, int y, SDL_Color c, bool center = false, int wrapWidth = 0);
+};
+
+// --- VirtualList ---
+// A scrollable list of fixed-height text rows over a data set of any size.
+// Only the visible rows plus PREFETCH_ROWS on either side are ever fetched
+// and formatted, through fetchRows(offset, limit, out); they are kept until
+// scrolling moves the visible rows outside them. Memory and per-frame work
+// depend on the size of the view, not on rowCount.
+struct VirtualList {
+    static const size_t PREFETCH_ROWS = 32;
+    static const int WHEEL_ROWS = 3; // Rows scrolled per mouse wheel notch
+
+    SDL_Rect rect;
+    int rowHeight;
+    size_t rowCount = 0;
+    size_t firstRow = 0;    // Top visible row
+    std::function<void(size_t offset, size_t limit, std::vector<std::string>& out)> fetchRows;
+
+    VirtualList(int x, int y, int w, int h, int rowH);
+
+    size_t visibleRows() const; // Rows that fit in rect
+    void reset(size_t count);   // New data: back to the top, cached rows dropped
+    void invalidateRows();      // Same rows, new content: refetched on next draw
+    void refresh(size_t count); // Rows changed, maybe in number: refetched, keeping the scroll position where possible
+    bool scrollBy(long rows);   // False if already at that end
+    bool scrollTo(size_t row);
+    // Up/Down, PageUp/PageDown, Home/End. False if the key is not a list key or did not move the list.
+    bool handleKey(SDL_Keycode key);
+    const std::string* row(size_t index); // Fetches the window around index if needed; nullptr past the end
+
+private:
+    size_t cacheBegin = 0;
+    std::vector<std::string> cachedRows; // Rows [cacheBegin, cacheBegin + size)
+    bool cacheValid = false;
+};
+
+// --- Screen ---
+// The widgets of one screen, retained between frames. A screen is built once
+// when it is entered (or its content changes) and then only read and mutated
+// in place by the frames that draw it. Input fields are owned elsewhere.
+struct Screen {
+    std::vector<Label> labels;
+    std::vector<InputField*> fields;
+    std::vector<Button> buttons;
+    VirtualList* list = nullptr; // Scrollable rows, if the screen has them
+
+    void clear(); // Keeps the vectors' capacity for the next build
+};
+
 
 // --- GUI Function Declarations ---
 void render_text(const std::string& text, int x, int y, SDL_Color color, bool center = false, int wrapWidth = 0);
+void render_label(const Label& label);
 void render_button(Button& button); 
 void render_input_field(const InputField& field);
+void render_virtual_list(VirtualList& list);
 void update_button_hover(int mouseX, int mouseY, std::vector<Button>& buttons);
+bool button_hover_would_change(int mouseX, int mouseY, const std::vector<Button>& buttons);
+
+// --- Redraw scheduling ---
+// The screen is redrawn only when something on it may have changed. Input,
+// state transitions, message changes and finished background jobs request a
+// redraw; a frame with no request skips layout and rendering entirely.
+void request_redraw();
+bool redraw_requested();
+bool take_redraw_request(); // Returns whether a redraw was requested, and clears the request
 
 // --- Extern declarations for Global GUI Constants (defined in main.cpp) ---
 extern const int SCREEN_WIDTH;
@@ -0,0 +1,330 @@
+#include "input_replay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static const char* const RECORDING_HEADER = "# events input recording v1";
+
+// --- Text escaping ---
+static string escape_text(const char* text) {
+    string out;
+    for (const char* c = text; *c; ++c) {
+        switch (*c) {
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case ' ': out += "\\s"; break;
+            default: out += *c;
+        }
+    }
+    return out;
+}
+
+static bool unescape_text(const string& in, string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '\\') { out += in[i]; continue; }
+        if (++i == in.size()) return false;
+        switch (in[i]) {
+            case '\\': out += '\\'; break;
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 's': out += ' '; break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+// --- InputRecorder ---
+bool InputRecorder::open(const string& path) {
+    if (file.is_open()) file.close();
+    file.open(path, ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open input recording " << path << " for writing." << endl;
+        return false;
+    }
+    file << RECORDING_HEADER << '\n';
+    return true;
+}
+
+void InputRecorder::close() {
+    if (file.is_open()) file.close();
+}
+
+void InputRecorder::record(uint64_t frame, const SDL_Event& e) {
+    if (!file.is_open()) return;
+    file << frame << ' ';
+    switch (e.type) {
+        case SDL_MOUSEMOTION: file << "motion " << e.motion.x << ' ' << e.motion.y; break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            file << (e.type == SDL_MOUSEBUTTONDOWN ? "down " : "up ") << static_cast<int>(e.button.button) << ' ' << e.button.x << ' ' << e.button.y;
+            break;
+        case SDL_MOUSEWHEEL: file << "wheel " << e.wheel.y; break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP: {
+            file << (e.type == SDL_KEYDOWN ? "keydown " : "keyup ");
+            const char* name = SDL_GetKeyName(e.key.keysym.sym);
+            if (name && *name) file << name;
+            else file << "0x" << hex << e.key.keysym.sym << dec;
+            break;
+        }
+        case SDL_TEXTINPUT: file << "text " << escape_text(e.text.text); break;
+        case SDL_WINDOWEVENT: file << "window " << static_cast<int>(e.window.event) << ' ' << e.window.data1 << ' ' << e.window.data2; break;
+        case SDL_QUIT: file << "quit"; break;
+        default: file << "other " << e.type; break; // The loop only redraws for these
+    }
+    file << '\n';
+}
+
+// --- InputScript ---
+struct ScriptLine {
+    size_t number; // 1-based, for errors
+    string text;
+};
+
+static string trim(const string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+static string substitute_index(const string& line, long index) {
+    string out;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '%' && i + 1 < line.size() && line[i + 1] == 'i') { out += to_string(index); ++i; }
+        else out += line[i];
+    }
+    return out;
+}
+
+// Flattens repeat blocks from lines[pos] until the matching "end" (depth > 0)
+// or the end of the script; pos is left on that "end".
+static bool expand_repeats(const vector<ScriptLine>& lines, size_t& pos, int depth, long index, vector<ScriptLine>& out, string& error) {
+    for (; pos < lines.size(); ++pos) {
+        const string& text = lines[pos].text;
+        if (text == "end") {
+            if (depth == 0) { error = "'end' without 'repeat'"; return false; }
+            return true;
+        }
+        if (text.compare(0, 7, "repeat ") == 0) {
+            char* endPtr = nullptr;
+            long count = strtol(text.c_str() + 7, &endPtr, 10);
+            if (count < 0 || endPtr == text.c_str() + 7 || !trim(endPtr).empty()) { error = "bad repeat count"; return false; }
+            size_t bodyStart = pos + 1, bodyEnd = bodyStart;
+            vector<ScriptLine> discarded;
+            for (long k = 0; k < max(count, 1L); ++k) { // A zero count still walks the body to find its end
+                bodyEnd = bodyStart;
+                if (!expand_repeats(lines, bodyEnd, depth + 1, k, count ? out : discarded, error)) return false;
+            }
+            if (bodyEnd >= lines.size()) { error = "'repeat' without 'end'"; return false; }
+            pos = bodyEnd;
+            continue;
+        }
+        out.push_back({lines[pos].number, depth > 0 ? substitute_index(text, index) : text});
+    }
+    if (depth > 0) { error = "'repeat' without 'end'"; return false; }
+    return true;
+}
+
+bool InputScript::load(const string& path) {
+    ifstream in(path);
+    if (!in.is_open()) {
+        cerr << "Error: Could not open input script " << path << "." << endl;
+        return false;
+    }
+    vector<ScriptLine> lines;
+    string line;
+    for (size_t number = 1; getline(in, line); ++number) {
+        string content = trim(line); // Trailing spaces in text must be written as \s
+        if (content.empty() || content[0] == '#') continue;
+        lines.push_back({number, content});
+    }
+    vector<ScriptLine> flat;
+    string error;
+    size_t pos = 0;
+    if (!expand_repeats(lines, pos, 0, 0, flat, error)) {
+        cerr << "Error: " << path << ":" << (pos < lines.size() ? lines[pos].number : lines.empty() ? 0 : lines.back().number) << ": " << error << "." << endl;
+        return false;
+    }
+    scripted.clear();
+    next = 0;
+    containsQuit = false;
+    uint64_t frame = 0;
+    for (const ScriptLine& l : flat) {
+        if (!parseEvent(l.text, frame, error)) {
+            cerr << "Error: " << path << ":" << l.number << ": " << error << ": " << l.text << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InputScript::parseEvent(const string& line, uint64_t& frame, string& error) {
+    istringstream in(line);
+    string frameField, command;
+    if (!(in >> frameField >> command)) { error = "expected a frame and an event"; return false; }
+    char* endPtr = nullptr;
+    bool relative = frameField[0] == '+';
+    unsigned long long value = strtoull(frameField.c_str() + (relative ? 1 : 0), &endPtr, 10);
+    if (*endPtr != '\0' || frameField == "+" || frameField[relative ? 1 : 0] == '-') { error = "bad frame number"; return false; }
+    uint64_t at = relative ? frame + value : value;
+    if (at < frame) { error = "frame goes backwards"; return false; }
+    frame = at;
+
+    string rest;
+    getline(in, rest);
+    if (!rest.empty() && rest[0] == ' ') rest.erase(0, 1); // The separator; text keeps any further spaces
+    istringstream args(rest);
+    SDL_Event e;
+    memset(&e, 0, sizeof(e));
+    auto add = [&](const SDL_Event& ev) { scripted.push_back({frame, ev}); };
+    auto onlyArgs = [&](istringstream& a) { string extra; return !(a >> extra); };
+
+    if (command == "motion" || command == "click") {
+        int x, y;
+        if (!(args >> x >> y) || !onlyArgs(args)) { error = "expected X Y"; return false; }
+        e.type = SDL_MOUSEMOTION; e.motion.x = x; e.motion.y = y;
+        add(e);
+        if (command == "click") {
+            memset(&e, 0, sizeof(e));
+            e.type = SDL_MOUSEBUTTONDOWN; e.button.button = SDL_BUTTON_LEFT; e.button.state = 1; e.button.clicks = 1; e.button.x = x; e.button.y = y;
+            add(e);
+            e.type = SDL_MOUSEBUTTONUP; e.button.state = 0;
+            add(e);
+        }
+    } else if (command == "down" || command == "up") {
+        int button, x, y;
+        if (!(args >> button >> x >> y) || !onlyArgs(args) || button < 1 || button > 255) { error = "expected BUTTON X Y"; return false; }
+        e.type = command == "down" ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        e.button.button = static_cast<Uint8>(button); e.button.state = command == "down"; e.button.clicks = 1; e.button.x = x; e.button.y = y;
+        add(e);
+    } else if (command == "wheel") {
+        int dy;
+        if (!(args >> dy) || !onlyArgs(args)) { error = "expected DY"; return false; }
+        e.type = SDL_MOUSEWHEEL; e.wheel.y = dy;
+        add(e);
+    } else if (command == "keydown" || command == "keyup") {
+        string name = trim(rest);
+        SDL_Keycode key = 0;
+        if (name.compare(0, 2, "0x") == 0) key = static_cast<SDL_Keycode>(strtol(name.c_str() + 2, nullptr, 16));
+        else key = SDL_GetKeyFromName(name.c_str());
+        if (key == 0) { error = "unknown key"; return false; }
+        e.type = command == "keydown" ? SDL_KEYDOWN : SDL_KEYUP;
+        e.key.state = command == "keydown"; e.key.keysym.sym = key;
+        add(e);
+    } else if (command == "text") {
+        string text;
+        if (!unescape_text(rest, text) || text.empty()) { error = "bad text"; return false; }
+        const size_t chunk = SDL_TEXTINPUTEVENT_TEXT_SIZE - 1;
+        for (size_t i = 0; i < text.size();) {
+            size_t n = min(chunk, text.size() - i);
+            while (n > 1 && i + n < text.size() && (static_cast<unsigned char>(text[i + n]) & 0xC0) == 0x80) --n; // Keep UTF-8 sequences whole
+            memset(&e, 0, sizeof(e));
+            e.type = SDL_TEXTINPUT;
+            memcpy(e.text.text, text.data() + i, n);
+            add(e);
+            i += n;
+        }
+    } else if (command == "window") {
+        int event, data1, data2;
+        if (!(args >> event >> data1 >> data2) || !onlyArgs(args)) { error = "expected EVENT DATA1 DATA2"; return false; }
+        e.type = SDL_WINDOWEVENT; e.window.event = static_cast<Uint8>(event); e.window.data1 = data1; e.window.data2 = data2;
+        add(e);
+    } else if (command == "quit") {
+        if (!onlyArgs(args)) { error = "unexpected arguments"; return false; }
+        e.type = SDL_QUIT;
+        add(e);
+        containsQuit = true;
+    } else if (command == "other") {
+        unsigned long type;
+        if (!(args >> type) || !onlyArgs(args)) { error = "expected TYPE"; return false; }
+        e.type = static_cast<Uint32>(type);
+        add(e);
+    } else {
+        error = "unknown event '" + command + "'";
+        return false;
+    }
+    return true;
+}
+
+void InputScript::pushEventsFor(uint64_t frame) {
+    while (next < scripted.size() && scripted[next].frame <= frame) {
+        SDL_Event e = scripted[next++].event;
+        if (SDL_PushEvent(&e) < 0) cerr << "Error: SDL_PushEvent failed: " << SDL_GetError() << endl;
+    }
+}
+
+bool InputScript::finishedAfter(uint64_t frame) const {
+    return next >= scripted.size() || scripted.back().frame <= frame;
+}
+
+// --- FrameTimeLog ---
+void FrameTimeLog::add(uint64_t frame, const FrameTiming& timing) {
+    if (!timing.drawn) { ++skipped; return; }
+    frames.push_back({frame, timing});
+}
+
+bool FrameTimeLog::writeCsv(const string& path) const {
+    ofstream out(path, ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: Could not open " << path << " for writing." << endl;
+        return false;
+    }
+    out << "frame,logic_ms,layout_ms,render_ms,submit_ms,total_ms,allocations,draw_calls\n";
+    char row[192];
+    for (const Row& r : frames) {
+        const FrameTiming& t = r.timing;
+        snprintf(row, sizeof(row), "%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%llu,%u\n", static_cast<unsigned long long>(r.frame), t.logicMs,
+                 t.layoutMs, t.renderMs, t.submitMs, t.totalMs(), static_cast<unsigned long long>(t.allocations), t.drawCalls);
+        out << row;
+    }
+    return static_cast<bool>(out);
+}
+
+// Nearest-rank percentile of an unsorted copy.
+static double percentile(vector<double> values, double p) {
+    if (values.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * values.size() + 0.999999);
+    rank = min(max(rank, size_t(1)), values.size());
+    nth_element(values.begin(), values.begin() + (rank - 1), values.end());
+    return values[rank - 1];
+}
+
+double FrameTimeLog::percentileTotalMs(double p) const {
+    vector<double> totals;
+    totals.reserve(frames.size());
+    for (const Row& r : frames) totals.push_back(r.timing.totalMs());
+    return percentile(totals, p);
+}
+
+void FrameTimeLog::printSummary(ostream& out) const {
+    out << "Replay: " << frames.size() << " frames drawn, " << skipped << " skipped." << endl;
+    if (frames.empty()) return;
+    struct Phase { const char* name; double (*get)(const FrameTiming&); };
+    const Phase phases[] = {
+        {"logic", [](const FrameTiming& t) { return t.logicMs; }},
+        {"layout", [](const FrameTiming& t) { return t.layoutMs; }},
+        {"render", [](const FrameTiming& t) { return t.renderMs; }},
+        {"submit", [](const FrameTiming& t) { return t.submitMs; }},
+        {"total", [](const FrameTiming& t) { return t.totalMs(); }},
+    };
+    char line[160];
+    snprintf(line, sizeof(line), "  %-7s %10s %10s %10s %10s  (ms)", "phase", "p50", "p95", "p99", "max");
+    out << line << endl;
+    vector<double> values(frames.size());
+    for (const Phase& phase : phases) {
+        for (size_t i = 0; i < frames.size(); ++i) values[i] = phase.get(frames[i].timing);
+        snprintf(line, sizeof(line), "  %-7s %10.3f %10.3f %10.3f %10.3f", phase.name, percentile(values, 50), percentile(values, 95),
+                 percentile(values, 99), *max_element(values.begin(), values.end()));
+        out << line << endl;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// --- Input recording and replay ---
+// Input scripts are text, one event per line, keyed by the main loop iteration
+// ("frame") whose SDL_PollEvent loop saw it:
+//
+//   FRAME motion X Y          FRAME down BUTTON X Y    FRAME up BUTTON X Y
+//   FRAME wheel DY            FRAME keydown KEY        FRAME keyup KEY
+//   FRAME text TEXT           FRAME window EVENT DATA1 DATA2
+//   FRAME quit                FRAME other TYPE         (any other event, by number)
+//   FRAME click X Y           (script shorthand: motion, down 1, up 1)
+//
+// FRAME is an absolute frame number, or +N for N frames after the previous
+// line. KEY is the rest of the line: an SDL key name ("Backspace", "Down",
+// "F3") or a 0x-prefixed keycode. TEXT is the rest of the line, with \\, \n,
+// \t and \s (space; recordings escape every space) escaped; longer texts are
+// split into several SDL_TEXTINPUT events. Lines starting with # are comments.
+// Hand-written scripts can repeat a block, with %i in it replaced by the
+// iteration (0-based, innermost block):
+//
+//   repeat 500
+//   +2 click 200 165
+//   +1 text Event %i
+//   end
+class InputRecorder {
+public:
+    bool open(const std::string& path); // Truncates; false (and cerr) on failure
+    void close();
+    bool isOpen() const { return file.is_open(); }
+    void record(uint64_t frame, const SDL_Event& e);
+
+private:
+    std::ofstream file;
+};
+
+class InputScript {
+public:
+    bool load(const std::string& path); // False (and cerr, with the line) on a parse error
+    // Pushes the events of `frame` onto SDL's queue, in script order.
+    void pushEventsFor(uint64_t frame);
+    bool finishedAfter(uint64_t frame) const; // No events after `frame`
+    size_t eventCount() const { return scripted.size(); }
+    bool hasQuit() const { return containsQuit; }
+
+private:
+    struct ScriptedEvent {
+        uint64_t frame;
+        SDL_Event event;
+    };
+    std::vector<ScriptedEvent> scripted; // By frame, stable
+    size_t next = 0;
+    bool containsQuit = false;
+
+    bool parseEvent(const std::string& line, uint64_t& frame, std::string& error);
+};
+
+// --- Frame times ---
+// CPU time of one main loop iteration, by phase: logic (jobs, input handling
+// and the click's business logic), layout (building the screen), render
+// (recording widgets and text into the draw list) and submit (flushing it
+// and presenting).
+struct FrameTiming {
+    bool drawn = false;
+    double logicMs = 0, layoutMs = 0, renderMs = 0, submitMs = 0;
+    uint64_t allocations = 0; // In the UI path, as counted for lastFrameAllocations
+    uint32_t drawCalls = 0;
+    double totalMs() const { return logicMs + layoutMs + renderMs + submitMs; }
+};
+
+class FrameTimeLog {
+public:
+    void add(uint64_t frame, const FrameTiming& timing); // Skipped frames are counted, not kept
+    bool writeCsv(const std::string& path) const;
+    void printSummary(std::ostream& out) const; // p50/p95/p99/max per phase over drawn frames
+    double percentileTotalMs(double p) const;
+    size_t drawnFrames() const { return frames.size(); }
+
+private:
+    struct Row {
+        uint64_t frame;
+        FrameTiming timing;
+    };
+    std::vector<Row> frames;
+    uint64_t skipped = 0;
+};
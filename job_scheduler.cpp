@@ -0,0 +1,126 @@
+#include "job_scheduler.h"
+
+#include <chrono>
+
+using namespace std;
+
+JobScheduler::JobScheduler() {
+#ifndef JOB_SCHEDULER_COOPERATIVE
+    worker = thread(&JobScheduler::workerLoop, this);
+#endif
+}
+
+JobScheduler::~JobScheduler() {
+#ifdef JOB_SCHEDULER_COOPERATIVE
+    while (runOneStep()) {}
+#else
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join(); // The worker drains the queue before it exits
+#endif
+}
+
+JobId JobScheduler::submit(function<bool()> step, function<void()> onComplete) {
+    auto job = make_shared<Job>();
+    job->step = move(step);
+    job->onComplete = move(onComplete);
+    {
+        lock_guard<mutex> guard(lock);
+        job->id = nextId++;
+        queue.push_back(job);
+        live[job->id] = job;
+    }
+    wake.notify_one();
+    return job->id;
+}
+
+JobId JobScheduler::submitTask(function<void()> work, function<void()> onComplete) {
+    return submit([work]() { work(); return true; }, move(onComplete));
+}
+
+void JobScheduler::cancel(JobId id) {
+    lock_guard<mutex> guard(lock);
+    auto it = live.find(id);
+    if (it != live.end()) it->second->cancelled = true;
+}
+
+bool JobScheduler::isPending(JobId id) const {
+    lock_guard<mutex> guard(lock);
+    return live.count(id) != 0;
+}
+
+size_t JobScheduler::pendingCount() const {
+    lock_guard<mutex> guard(lock);
+    return live.size();
+}
+
+bool JobScheduler::usesWorkerThread() const {
+#ifdef JOB_SCHEDULER_COOPERATIVE
+    return false;
+#else
+    return true;
+#endif
+}
+
+bool JobScheduler::runOneStep() {
+    shared_ptr<Job> job;
+    {
+        lock_guard<mutex> guard(lock);
+        if (queue.empty()) return false;
+        job = queue.front();
+        queue.pop_front();
+    }
+    bool done = job->cancelled || job->step();
+    {
+        lock_guard<mutex> guard(lock);
+        if (done) finished.push_back(job);
+        else queue.push_back(job); // Take turns with the other queued jobs
+    }
+    if (done) idle.notify_all();
+    return true;
+}
+
+void JobScheduler::waitUntilIdle() {
+#ifdef JOB_SCHEDULER_COOPERATIVE
+    while (runOneStep()) {}
+#else
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this] { return finished.size() == live.size(); }); // Nothing queued or mid-step
+#endif
+}
+
+void JobScheduler::runFrame(double budgetMs) {
+#ifdef JOB_SCHEDULER_COOPERATIVE
+    auto start = chrono::steady_clock::now();
+    while (runOneStep()) {
+        if (chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() >= budgetMs) break;
+    }
+#else
+    (void)budgetMs; // Steps run on the worker
+#endif
+    vector<shared_ptr<Job>> ready;
+    {
+        lock_guard<mutex> guard(lock);
+        ready.swap(finished);
+        for (const auto& job : ready) live.erase(job->id);
+    }
+    for (const auto& job : ready) {
+        if (!job->cancelled && job->onComplete) job->onComplete();
+    }
+}
+
+#ifndef JOB_SCHEDULER_COOPERATIVE
+void JobScheduler::workerLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) return; // Stopping, and every job has run
+        guard.unlock();
+        runOneStep();
+        guard.lock();
+    }
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Web builds without -pthread have no worker threads: jobs then run on the
+// main thread, a few steps per frame, within the budget given to runFrame().
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define JOB_SCHEDULER_COOPERATIVE 1
+#else
+#include <thread>
+#endif
+
+typedef uint64_t JobId; // 0 is never a valid job
+
+// --- JobScheduler ---
+// Runs work off the frame callback. A job is a step function that does a
+// bounded slice of work and returns true when the job is finished, plus a
+// completion callback. Steps run on one worker thread (native, or web builds
+// with pthreads); jobs take turns a step at a time, so a long save does not
+// hold up a search queued behind it. Completion callbacks always run on the
+// thread that calls runFrame(), so they may touch UI state freely.
+class JobScheduler {
+public:
+    JobScheduler();
+    ~JobScheduler(); // Runs every queued job to completion (their callbacks are dropped), then stops
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    JobId submit(std::function<bool()> step, std::function<void()> onComplete);
+    // Single-step job: `work` runs in one go, then onComplete on the UI thread.
+    JobId submitTask(std::function<void()> work, std::function<void()> onComplete);
+    // Stops the job before its next step; its onComplete is never called.
+    void cancel(JobId id);
+    bool isPending(JobId id) const; // Queued, running, or finished with its callback not yet delivered
+    size_t pendingCount() const;
+
+    // Call once per frame from the UI thread. In cooperative mode this runs job
+    // steps until budgetMs has elapsed; in either mode it then delivers the
+    // completion callbacks of finished jobs.
+    void runFrame(double budgetMs);
+    bool usesWorkerThread() const;
+    // Blocks until every job has finished its last step (in cooperative mode,
+    // runs them to completion), so the next runFrame() delivers all of their
+    // callbacks. For headless replays, where results must land on the same
+    // frame every run.
+    void waitUntilIdle();
+
+private:
+    struct Job {
+        JobId id;
+        std::function<bool()> step;
+        std::function<void()> onComplete;
+        std::atomic<bool> cancelled{false};
+    };
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;                      // Signalled whenever a job finishes
+    std::deque<std::shared_ptr<Job>> queue;            // Runnable, in turn order
+    std::vector<std::shared_ptr<Job>> finished;        // Awaiting runFrame()
+    std::unordered_map<JobId, std::shared_ptr<Job>> live; // Every job not yet delivered
+    JobId nextId = 1;
+    bool stopping = false;
+
+    // Runs one step of the job at the front of the queue; false if the queue was empty.
+    bool runOneStep();
+#ifndef JOB_SCHEDULER_COOPERATIVE
+    std::thread worker;
+    void workerLoop();
+#endif
+};
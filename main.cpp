@@ -4,6 +4,9 @@
 #include <limits>
 #include <algorithm>
 #include <stdexcept> 
+#include <memory>
+#include <chrono>
+#include <cstdlib>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
@@ -15,6 +18,14 @@
 // Include the new header files
 #include "gui_utils.h" // Defines AppState, Button, InputField, render functions, extern consts
 #include "app_logic.h" // Defines eventType, User, events etc.
+#include "job_scheduler.h" // Runs search, listing and save work off the frame callback
+#include "text_renderer.h" // Glyph atlas behind render_text
+#include "alloc_counter.h" // Verifies that steady frames allocate nothing
+#include "draw_list.h" // Batches the frame's rects and text into few draw calls
+#include "frame_profiler.h" // Timing zones and the F3 overlay when built with -DFRAME_PROFILER
+#include "input_replay.h" // Input recording, headless replay and per-phase frame times
+#include "memory_accounting.h" // Per-subsystem memory and the budgets that evict caches
+#include "events_api.h" // Lets the page call into the same event manager
 
 // Using std namespace for convenience in this main file
 using namespace std;
@@ -41,12 +52,57 @@ AppState currentState = STATE_USER_DETAILS;
 
 User* currentUser = nullptr; 
 events* eventManager = nullptr; 
+JobScheduler* jobScheduler = nullptr;
+
+// Background jobs: at most one fills displayedEventList at a time, and one save runs at a time.
+JobId listJob = 0; // Nonzero while a listing or search is pending
+JobId saveJob = 0; // Nonzero while a save is pending
+JobId titleJob = 0; // Nonzero while a delete or sign-up waits on its "did you mean" scan
+const double JOB_FRAME_BUDGET_MS = 6.0; // Main-thread time per frame for jobs when there is no worker thread
+const size_t JOB_STEP_SLOTS = 2048;     // Event slots scanned per job step
+const size_t JOB_STEP_LINES = 4096;     // Data file lines read per load step
+
+// Redraw scheduling: the message the last drawn frame showed, to detect changes that need a new one.
+string renderedMessage = "";
+SDL_Color messageColor = TEXT_COLOR;
+uint64_t framesDrawn = 0, framesSkipped = 0;
+uint64_t lastFrameAllocations = 0, framesAllocating = 0; // Heap allocations in the UI path of drawn frames
+FrameTiming lastFrameTiming; // CPU time of the last main_loop_iteration, by phase
+int pointerX = -1, pointerY = -1; // From the last mouse event, so replays hover exactly as recorded
+
+// Retained widgets of the current screen, rebuilt only on entering a screen or when its content changes.
+Screen currentScreen;
+AppState screenState = STATE_EXITED;
+bool screenStale = true;
+const Uint32 IDLE_WAIT_MS = 1000; // Native loop: longest sleep while waiting for input with nothing pending
+
+// Staged startup: the first frame is drawn with a small startup font while the
+// full font downloads and the events load once persistent storage is mounted.
+const char* const STARTUP_FONT_FILE = "arial_subset.ttf"; // Printable ASCII and Latin-1 only; preloaded
+const char* const FULL_FONT_FILE = "arial.ttf";
+const int FONT_SIZE = 18;
+struct StartupTimings { double firstFrameMs = -1, fontReadyMs = -1, dataReadyMs = -1; }; // Since page/process start
+StartupTimings startupTimings;
+JobId loadJob = 0; // Nonzero while the events file is being read
+#ifndef __EMSCRIPTEN__
+OpTraceRecorder guiTraceRecorder; // Set EVENTS_TRACE=FILE to record this session for tools/trace_replay
+InputRecorder inputRecorder; // --record FILE
+uint64_t loopIteration = 0; // Index of the running main_loop_iteration; input recordings are keyed by it
+#endif
+Uint32 rendererFlags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC; // Replays drop vsync, so present time is CPU time
 
 // UI Interaction Globals
 string currentMessage = ""; 
-vector<string> displayedEventList; 
+vector<EventHandle> displayedEventList; // Handles into eventManager; rows are formatted at render time
+bool listFromIndex = false; // Show All: rows are paged straight from the time index (Open Only: the availability index)
+vector<ListingRow> listingRows;   // Last page read from the listing; rows whose version is unchanged are not copied again
+vector<ListingRow> listingLines;  // listingRows as shown ("- " + text), reformatted only when a row's (handle, version) changes
+uint64_t shownListingVersion = 0; // Listing version the rows on screen were read at
+VirtualList eventListView(50, 100, SCREEN_WIDTH - 100, SCREEN_HEIGHT - 200, 25); // Rows of Show All and Search Results
+string lastSearchQuery = ""; 
+bool showOpenEventsOnly = false; // Show-all filter: only events with free seats (served from the availability index)
 string inputBuffer_generic = ""; 
-string suggestedMatch; 
+EventHandle suggestedEvent; // "Did you mean" target, acted on directly by the confirm flows
 int actionToConfirm = -1; 
 eventType pendingEventType; 
 
@@ -64,13 +120,23 @@ InputField userCompanyInput(250, 300, 300, 30, "Company/School");
 
 InputField sharedInputField(SCREEN_WIDTH/2 - 150, 150, 300, 30, "Enter text here"); 
 
-vector<InputField*> activeInputFieldsOnScreen; 
 InputField* focusedInputField = nullptr;     
 
 // --- Forward declarations for helper functions defined in this file ---
 void clear_input_fields_for_create_event();
 void clear_generic_input_buffer();
 void reset_confirmation_state();
+void invalidate_screen();
+void build_screen();
+void refresh_event_listing();
+void fetch_list_rows(size_t offset, size_t limit, vector<string>& out);
+size_t indexed_row_count();
+void follow_listing_changes();
+void start_search(const string& query);
+void start_title_action(AppState screen, const string& title);
+void start_save();
+void start_loading_events();
+void record_startup_milestone(const char* name, double& slot);
 void handle_mouse_click(int mouseX, int mouseY, vector<Button>& buttons, vector<InputField*>& currentScreenInputFields);
 void main_loop_iteration();
 bool init_sdl();
@@ -132,24 +198,22 @@ void handle_mouse_click(int mouseX, int mouseY, vector<Button>& buttons, vector<
                 if (currentMessage.find("successfully") != string::npos) { clear_input_fields_for_create_event(); } 
                 return;
             }
-            else if (currentState == STATE_DELETE_EVENT && button.actionId == 0) { 
-                bool fd, fs; if(eventManager) currentMessage = eventManager->attemptDeleteEvent(inputBuffer_generic, fd, fs); else { currentMessage = "Error: System not initialized."; fd=false; fs=false;}
-                if (fd) clear_generic_input_buffer(); else if (fs) { actionToConfirm = 0; currentState = STATE_CONFIRM_ACTION;} return; 
-            }
-            else if (currentState == STATE_SIGN_UP_FOR_EVENT && button.actionId == 0) { 
-                bool fd, fs; string sMsg; if(eventManager && currentUser) currentMessage = eventManager->attemptSignUp(currentUser, inputBuffer_generic, fd, fs, sMsg); else { currentMessage = "Error: System not initialized for sign up."; fd=false; fs=false;}
-                if (fd) { currentMessage = sMsg; clear_generic_input_buffer();} else if (fs) { actionToConfirm = 1; currentState = STATE_CONFIRM_ACTION;} return; 
+            else if ((currentState == STATE_DELETE_EVENT || currentState == STATE_SIGN_UP_FOR_EVENT) && button.actionId == 0) { 
+                start_title_action(currentState, inputBuffer_generic); return; 
             }
             else if (currentState == STATE_SEARCH_EVENT && button.actionId == 0) { 
-                if(eventManager) displayedEventList = eventManager->searchEvents(inputBuffer_generic); else displayedEventList.assign(1,"Error: Sys init.");
+                lastSearchQuery = inputBuffer_generic; start_search(inputBuffer_generic);
                 currentState = STATE_SEARCH_RESULTS; currentMessage = ""; return;
             }
+            else if (currentState == STATE_SHOW_ALL_EVENTS && button.actionId == 20) { 
+                showOpenEventsOnly = !showOpenEventsOnly; refresh_event_listing(); return;
+            }
             else if (currentState == STATE_CONFIRM_ACTION) {
                 if (button.actionId == 10) { 
-                    if (actionToConfirm == 0) { if(eventManager) currentMessage = eventManager->confirmDeleteSuggestedEvent(); else currentMessage = "Err: Sys init."; } 
-                    else if (actionToConfirm == 1) { string sMsg; if(eventManager && currentUser) currentMessage = eventManager->confirmSignUpSuggestedEvent(currentUser, sMsg); else currentMessage = "Err: Sys init."; if (!sMsg.empty() && currentMessage.find("Did you mean") == string::npos && currentMessage.find("Error:") == string::npos) currentMessage = sMsg; }
+                    if (actionToConfirm == 0) { if(eventManager) currentMessage = eventManager->confirmDeleteSuggestedEvent(suggestedEvent); else currentMessage = "Err: Sys init."; } 
+                    else if (actionToConfirm == 1) { string sMsg; if(eventManager && currentUser) currentMessage = eventManager->confirmSignUpSuggestedEvent(currentUser, suggestedEvent, sMsg); else currentMessage = "Err: Sys init."; }
                     clear_generic_input_buffer(); reset_confirmation_state(); 
-                } else if (button.actionId == 11) { currentMessage = "Action cancelled for '" + suggestedMatch +"'."; clear_generic_input_buffer(); reset_confirmation_state(); 
+                } else if (button.actionId == 11) { currentMessage = "Action cancelled for '" + (eventManager ? eventManager->getEventTitle(suggestedEvent) : string()) +"'."; clear_generic_input_buffer(); reset_confirmation_state(); 
                 } else if (button.actionId == 99) { currentState = STATE_MAIN_MENU; currentMessage = "Confirmation cancelled."; clear_generic_input_buffer(); reset_confirmation_state(); } 
                 return;
             }
@@ -167,7 +231,7 @@ void handle_mouse_click(int mouseX, int mouseY, vector<Button>& buttons, vector<
             }
             else if (button.actionId == 100) { // Exit button
                 std::cout << "Exit button. Transitioning to EXITED state." << std::endl;
-                if (eventManager) { bool saved = eventManager->saveEventsToFile(); std::cout << "Events save on exit: " << (saved ? "OK" : "FAIL") << std::endl; }
+                start_save();
                 currentState = STATE_EXITED; currentMessage = "";  return;
             }
 
@@ -178,7 +242,7 @@ void handle_mouse_click(int mouseX, int mouseY, vector<Button>& buttons, vector<
                  reset_confirmation_state(); 
                  clear_generic_input_buffer(); 
                  
-                 if (currentState == STATE_SHOW_ALL_EVENTS) { if(eventManager) displayedEventList = eventManager->getAllEventTitles();}
+                 if (currentState == STATE_SHOW_ALL_EVENTS) { refresh_event_listing(); }
                  else if (currentState == STATE_CREATE_EVENT_TYPE || currentState == STATE_CREATE_EVENT_DETAILS){ clear_input_fields_for_create_event();}
                  else if (currentState == STATE_SEARCH_EVENT || currentState == STATE_SIGN_UP_FOR_EVENT || currentState == STATE_DELETE_EVENT) {
                     std::cout << "Setting focus to sharedInputField for state: " << currentState << std::endl;
@@ -191,151 +255,212 @@ void handle_mouse_click(int mouseX, int mouseY, vector<Button>& buttons, vector<
     }
 }
 
+static double ms_between(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+    return chrono::duration<double, milli>(to - from).count();
+}
+
 void main_loop_iteration() {
-    SDL_Event e; vector<Button> currentButtonsOnScreen; activeInputFieldsOnScreen.clear(); 
+    PROFILE_FRAME();
+    const auto frameStart = chrono::steady_clock::now();
+    lastFrameTiming = FrameTiming();
+    SDL_Event e; 
     int mX_poll=0, mY_poll=0; bool mouseClickedThisFrame = false;
-
-    while (SDL_PollEvent(&e) != 0) {
-        if (currentState == STATE_EXITED) { if (e.type == SDL_QUIT) {
-            #ifdef __EMSCRIPTEN__
-            emscripten_cancel_main_loop(); 
+    if (jobScheduler) { PROFILE_ZONE("jobs"); jobScheduler->runFrame(JOB_FRAME_BUDGET_MS); } // Picks up finished searches, listings and saves
+    memory_enforce_budgets(); // Trims caches over budget, or all of them when the heap is about to grow
+    follow_listing_changes();
+
+    { // Input
+        PROFILE_ZONE("input");
+        while (SDL_PollEvent(&e) != 0) {
+            #ifndef __EMSCRIPTEN__
+            inputRecorder.record(loopIteration, e);
             #endif
-        } continue; }
+            if (e.type == SDL_MOUSEMOTION) { pointerX = e.motion.x; pointerY = e.motion.y; }
+            else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) { pointerX = e.button.x; pointerY = e.button.y; }
+            if (e.type == SDL_KEYDOWN && profiler_handle_key(e.key.keysym.sym)) { request_redraw(); continue; } // F3 overlay, F4 trace export
+            if (e.type == SDL_MOUSEMOTION) { if (button_hover_would_change(e.motion.x, e.motion.y, currentScreen.buttons)) request_redraw(); continue; }
+            if (e.type == SDL_MOUSEWHEEL) { if (currentScreen.list && currentScreen.list->scrollBy(-static_cast<long>(e.wheel.y) * VirtualList::WHEEL_ROWS)) request_redraw(); continue; }
+            if (e.type == SDL_KEYDOWN && currentScreen.list && currentScreen.fields.empty()) { if (currentScreen.list->handleKey(e.key.keysym.sym)) request_redraw(); continue; }
+            request_redraw(); // Any other input may change what is shown
+            if (currentState == STATE_EXITED) { if (e.type == SDL_QUIT) {
+                #ifdef __EMSCRIPTEN__
+                emscripten_cancel_main_loop(); 
+                #endif
+            } continue; }
+
+            if (e.type == SDL_QUIT) {
+                std::cout << "SDL_QUIT. Saving and exiting." << std::endl; start_save();
+                currentState = STATE_EXITED; currentMessage = ""; continue; 
+            }
+            if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) { mX_poll = e.button.x; mY_poll = e.button.y; mouseClickedThisFrame = true; }
 
-        if (e.type == SDL_QUIT) {
-            std::cout << "SDL_QUIT. Saving and exiting." << std::endl; if (eventManager) eventManager->saveEventsToFile();
-            currentState = STATE_EXITED; currentMessage = ""; continue; 
-        }
-        if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) { mX_poll = e.button.x; mY_poll = e.button.y; mouseClickedThisFrame = true; }
-
-        if (focusedInputField && focusedInputField->isActive) { 
-             if (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) {
-                 std::cout << "Key/Text Event. Focused field: " << focusedInputField->placeholder 
-                           << ", Active: " << focusedInputField->isActive 
-                           << ", Text BEFORE: '" << focusedInputField->text; 
-             }
-            if (e.type == SDL_TEXTINPUT) { 
-                string new_text_input = e.text.text;
-                if (!new_text_input.empty()) { 
-                    if (focusedInputField->text.length() + new_text_input.length() <= (size_t)focusedInputField->maxLength) {
-                        focusedInputField->text += new_text_input; 
+            if (focusedInputField && focusedInputField->isActive) { 
+                 if (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) {
+                     std::cout << "Key/Text Event. Focused field: " << focusedInputField->placeholder 
+                               << ", Active: " << focusedInputField->isActive 
+                               << ", Text BEFORE: '" << focusedInputField->text; 
+                 }
+                if (e.type == SDL_TEXTINPUT) { 
+                    string new_text_input = e.text.text;
+                    if (!new_text_input.empty()) { 
+                        if (focusedInputField->text.length() + new_text_input.length() <= (size_t)focusedInputField->maxLength) {
+                            focusedInputField->text += new_text_input; 
+                        }
                     }
+                } 
+                else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE && !focusedInputField->text.empty()) { 
+                    focusedInputField->text.pop_back(); 
                 }
-            } 
-            else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE && !focusedInputField->text.empty()) { 
-                focusedInputField->text.pop_back(); 
-            }
-            if (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) {
-                 std::cout << "', Text AFTER: '" << focusedInputField->text 
-                           << "', AppState: " << currentState << std::endl;
-                 if (focusedInputField == &sharedInputField) {
-                     inputBuffer_generic = sharedInputField.text;
-                     std::cout << "   Synced sharedInputField.text to inputBuffer_generic: '" << inputBuffer_generic << "'" << std::endl;
+                if (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) {
+                     std::cout << "', Text AFTER: '" << focusedInputField->text 
+                               << "', AppState: " << currentState << std::endl;
+                     if (focusedInputField == &sharedInputField) {
+                         inputBuffer_generic = sharedInputField.text;
+                         std::cout << "   Synced sharedInputField.text to inputBuffer_generic: '" << inputBuffer_generic << "'" << std::endl;
+                     }
                  }
-             }
-        } else if ( (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) && 
-                    (currentState == STATE_SEARCH_EVENT || currentState == STATE_SIGN_UP_FOR_EVENT || currentState == STATE_DELETE_EVENT || 
-                     currentState == STATE_USER_DETAILS || currentState == STATE_CREATE_EVENT_DETAILS) ) 
-        { 
-            std::cout << "Key/Text Event occurred BUT ";
-            if (!focusedInputField) std::cout << "focusedInputField is NULL.";
-            else std::cout << "focusedInputField (" << focusedInputField->placeholder << ") is NOT active.";
-            std::cout << " AppState: " << currentState << std::endl;
+            } else if ( (e.type == SDL_TEXTINPUT || (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_BACKSPACE)) && 
+                        (currentState == STATE_SEARCH_EVENT || currentState == STATE_SIGN_UP_FOR_EVENT || currentState == STATE_DELETE_EVENT || 
+                         currentState == STATE_USER_DETAILS || currentState == STATE_CREATE_EVENT_DETAILS) ) 
+            { 
+                std::cout << "Key/Text Event occurred BUT ";
+                if (!focusedInputField) std::cout << "focusedInputField is NULL.";
+                else std::cout << "focusedInputField (" << focusedInputField->placeholder << ") is NOT active.";
+                std::cout << " AppState: " << currentState << std::endl;
+            }
         }
     }
     
-    int mX_curr, mY_curr; SDL_GetMouseState(&mX_curr, &mY_curr);
+    if (currentState != screenState) screenStale = true;
+    if (screenStale || currentMessage != renderedMessage) request_redraw();
+    const auto inputDone = chrono::steady_clock::now();
+    lastFrameTiming.logicMs = ms_between(frameStart, inputDone);
+    if (!take_redraw_request()) { ++framesSkipped; return; } // Nothing changed: skip layout and rendering
+    lastFrameTiming.drawn = true;
+    ++framesDrawn; profiler_frame_drawn();
+    if (screenStale) { PROFILE_ZONE("build_screen"); build_screen(); } // Allocates, but only on entering a screen or when its content changes
+    if (currentMessage != renderedMessage) {
+        renderedMessage = currentMessage; messageColor = TEXT_COLOR;
+        if (currentMessage.find("Error:") != string::npos || currentMessage.find("Sorry!") != string::npos || currentMessage.find("not found") != string::npos) messageColor = ERROR_TEXT_COLOR;
+        else if (currentMessage.find("successfully") != string::npos || currentMessage.find("Signed up") != string::npos) messageColor = SUCCESS_TEXT_COLOR;
+    }
+
+    // From here on a steady frame touches only retained widgets and should not allocate.
+    uint64_t allocsBefore = thread_allocation_count(), clickAllocs = 0;
+    vector<InputField*>& fields = currentScreen.fields;
+    if (!fields.empty() && (!focusedInputField || !focusedInputField->isActive || std::find(fields.begin(), fields.end(), focusedInputField) == fields.end())) {
+        if (focusedInputField) focusedInputField->isActive = false;
+        focusedInputField = fields[0];
+        focusedInputField->isActive = true;
+    }
+
+    const auto layoutDone = chrono::steady_clock::now();
+    lastFrameTiming.layoutMs = ms_between(inputDone, layoutDone);
     SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255); SDL_RenderClear(gRenderer);
-    render_text("Event Management System", 10, 10, TEXT_COLOR, true, SCREEN_WIDTH - 20);
-    
-    if (currentState == STATE_EXITED) {
-        render_text("Program Exited", 0, SCREEN_HEIGHT / 2 - 50, TEXT_COLOR, true, SCREEN_WIDTH);
-        render_text("All data should be saved. You can close this browser tab.", 0, SCREEN_HEIGHT / 2, TEXT_COLOR, true, SCREEN_WIDTH - 40);
-        SDL_RenderPresent(gRenderer); return; 
+    for (const Label& label : currentScreen.labels) { render_label(label); }
+    if (!currentMessage.empty() && screenState != STATE_EXITED) { render_text(currentMessage, 20, SCREEN_HEIGHT - 60, messageColor, true, SCREEN_WIDTH - 40); }
+    for (InputField* f : fields) { render_input_field(*f); }
+    if (currentScreen.list) { render_virtual_list(*currentScreen.list); } // Formats rows only when scrolled outside the fetched window
+
+    update_button_hover(pointerX, pointerY, currentScreen.buttons); 
+    double clickMs = 0;
+    if (mouseClickedThisFrame) { // Show the click's effect next frame
+        uint64_t clickStart = thread_allocation_count();
+        const auto clickStartTime = chrono::steady_clock::now();
+        { PROFILE_ZONE("handle_mouse_click"); handle_mouse_click(mX_poll, mY_poll, currentScreen.buttons, fields); } request_redraw();
+        clickMs = ms_between(clickStartTime, chrono::steady_clock::now());
+        clickAllocs = thread_allocation_count() - clickStart;
     }
+    for (auto& btn : currentScreen.buttons) { render_button(btn); }
+    profiler_render_overlay();
+    const auto renderDone = chrono::steady_clock::now();
+    { PROFILE_ZONE("draw_list_flush"); gDrawList.flush(gRenderer); text_renderer_frame_done(); } // Widgets above only recorded their shapes and text
+    { PROFILE_ZONE("SDL_RenderPresent"); SDL_RenderPresent(gRenderer); }
+    lastFrameAllocations = thread_allocation_count() - allocsBefore - clickAllocs;
+    if (lastFrameAllocations > 0) ++framesAllocating;
+    lastFrameTiming.logicMs += clickMs; // The click's business logic, not rendering
+    lastFrameTiming.renderMs = ms_between(layoutDone, renderDone) - clickMs;
+    lastFrameTiming.submitMs = ms_between(renderDone, chrono::steady_clock::now());
+    lastFrameTiming.allocations = lastFrameAllocations;
+    lastFrameTiming.drawCalls = gDrawList.lastFrameStats().drawCalls;
+    if (startupTimings.firstFrameMs < 0) record_startup_milestone("firstFrameMs", startupTimings.firstFrameMs);
+}
 
-    if (!currentMessage.empty()) { SDL_Color mc = TEXT_COLOR; if (currentMessage.find("Error:") != string::npos || currentMessage.find("Sorry!") != string::npos || currentMessage.find("not found") != string::npos) mc = ERROR_TEXT_COLOR; else if (currentMessage.find("successfully") != string::npos || currentMessage.find("Signed up") != string::npos) mc = SUCCESS_TEXT_COLOR; render_text(currentMessage, 20, SCREEN_HEIGHT - 60, mc , true, SCREEN_WIDTH - 40); }
-    
-    if (currentState == STATE_USER_DETAILS) { 
-        render_text("Enter Your Details:", 50,100,TEXT_COLOR,false,SCREEN_WIDTH-100); activeInputFieldsOnScreen={&userNameInput,&userEmailInput,&userPhoneInput,&userCompanyInput};
-        if((!focusedInputField || !focusedInputField->isActive || std::find(activeInputFieldsOnScreen.begin(), activeInputFieldsOnScreen.end(), focusedInputField) == activeInputFieldsOnScreen.end()) && !activeInputFieldsOnScreen.empty()){
-            if(focusedInputField) focusedInputField->isActive = false;
-            focusedInputField=activeInputFieldsOnScreen[0]; 
-            if(focusedInputField)focusedInputField->isActive=true;
+// Lays out the widgets for currentState. Runs only when the screen is entered
+// or invalidate_screen() reports a change in what it shows.
+void build_screen() {
+    Screen& sc = currentScreen;
+    sc.clear();
+    screenState = currentState; screenStale = false;
+    sc.labels.emplace_back("Event Management System", 10, 10, TEXT_COLOR, true, SCREEN_WIDTH - 20);
+    int lineStep = gFont ? TTF_FontHeight(gFont) + 5 : 20;
+
+    if (currentState == STATE_EXITED) {
+        if (saveJob || loadJob) {
+            sc.labels.emplace_back("Saving events...", 0, SCREEN_HEIGHT / 2 - 50, TEXT_COLOR, true, SCREEN_WIDTH);
+        } else {
+            sc.labels.emplace_back("Program Exited", 0, SCREEN_HEIGHT / 2 - 50, TEXT_COLOR, true, SCREEN_WIDTH);
+            sc.labels.emplace_back("All data should be saved. You can close this browser tab.", 0, SCREEN_HEIGHT / 2, TEXT_COLOR, true, SCREEN_WIDTH - 40);
         }
-        for(auto f:activeInputFieldsOnScreen)render_input_field(*f); currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-100,400,200,40,"Submit Details",STATE_MAIN_MENU,0);
+    }
+    else if (currentState == STATE_USER_DETAILS) { 
+        sc.labels.emplace_back("Enter Your Details:", 50,100,TEXT_COLOR,false,SCREEN_WIDTH-100); sc.fields={&userNameInput,&userEmailInput,&userPhoneInput,&userCompanyInput};
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-100,400,200,40,"Submit Details",STATE_MAIN_MENU,0);
     }
     else if (currentState == STATE_MAIN_MENU) { 
-        render_text("Main Menu",50,60,TEXT_COLOR); int by=100,bs=50;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"1. Create Event",STATE_CREATE_EVENT_TYPE,-1);by+=bs;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"2. Delete Event",STATE_DELETE_EVENT,-1);by+=bs;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"3. Show All Events",STATE_SHOW_ALL_EVENTS,-1);by+=bs;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"4. Sign Up for Event",STATE_SIGN_UP_FOR_EVENT,-1);by+=bs;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"5. Search Events",STATE_SEARCH_EVENT,-1);by+=bs;
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"6. Exit",currentState,100);
+        sc.labels.emplace_back("Main Menu",50,60,TEXT_COLOR); int by=100,bs=50;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"1. Create Event",STATE_CREATE_EVENT_TYPE,-1);by+=bs;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"2. Delete Event",STATE_DELETE_EVENT,-1);by+=bs;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"3. Show All Events",STATE_SHOW_ALL_EVENTS,-1);by+=bs;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"4. Sign Up for Event",STATE_SIGN_UP_FOR_EVENT,-1);by+=bs;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"5. Search Events",STATE_SEARCH_EVENT,-1);by+=bs;
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,by,220,40,"6. Exit",currentState,100);
     }
     else if (currentState == STATE_CREATE_EVENT_TYPE) { 
-        render_text("Select Event Type:",50,100,TEXT_COLOR,false,SCREEN_WIDTH-100);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-75,150,150,40,"Webinar",STATE_CREATE_EVENT_DETAILS,0);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-75,200,150,40,"Conference",STATE_CREATE_EVENT_DETAILS,1);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-75,250,150,40,"Workshop",STATE_CREATE_EVENT_DETAILS,2);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-50,350,100,40,"Back",STATE_MAIN_MENU,9902);
+        sc.labels.emplace_back("Select Event Type:",50,100,TEXT_COLOR,false,SCREEN_WIDTH-100);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-75,150,150,40,"Webinar",STATE_CREATE_EVENT_DETAILS,0);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-75,200,150,40,"Conference",STATE_CREATE_EVENT_DETAILS,1);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-75,250,150,40,"Workshop",STATE_CREATE_EVENT_DETAILS,2);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-50,350,100,40,"Back",STATE_MAIN_MENU,9902);
     }
     else if (currentState == STATE_CREATE_EVENT_DETAILS) { 
-        string ts="Enter Event Details for "; if(pendingEventType==Webinar)ts+="Webinar";else if(pendingEventType==Conference)ts+="Conference";else ts+="Workshop"; render_text(ts,50,100,TEXT_COLOR,false,SCREEN_WIDTH-100);
-        activeInputFieldsOnScreen={&eventTitleInput,&eventDescInput,&eventDateInput,&eventPlatformInput,&eventCapacityInput};
-        if((!focusedInputField || !focusedInputField->isActive || std::find(activeInputFieldsOnScreen.begin(), activeInputFieldsOnScreen.end(), focusedInputField) == activeInputFieldsOnScreen.end()) && !activeInputFieldsOnScreen.empty()){
-            if(focusedInputField) focusedInputField->isActive = false;
-            focusedInputField=activeInputFieldsOnScreen[0]; 
-            if(focusedInputField)focusedInputField->isActive=true;
-        }
-        for(auto f:activeInputFieldsOnScreen)render_input_field(*f);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-160,400,150,40,"Create Event",currentState,0);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2+10,400,100,40,"Back",STATE_CREATE_EVENT_TYPE,99);
+        string ts="Enter Event Details for "; if(pendingEventType==Webinar)ts+="Webinar";else if(pendingEventType==Conference)ts+="Conference";else ts+="Workshop"; sc.labels.emplace_back(ts,50,100,TEXT_COLOR,false,SCREEN_WIDTH-100);
+        sc.fields={&eventTitleInput,&eventDescInput,&eventDateInput,&eventPlatformInput,&eventCapacityInput};
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-160,400,150,40,"Create Event",currentState,0);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2+10,400,100,40,"Back",STATE_CREATE_EVENT_TYPE,99);
     }
     else if (currentState == STATE_SHOW_ALL_EVENTS) { 
-        render_text("All Events:",50,60,TEXT_COLOR,false,SCREEN_WIDTH-100); int yp=100;
-        if(!eventManager||displayedEventList.empty()||(displayedEventList.size()==1&&displayedEventList[0].find("No events")!=string::npos)){render_text((eventManager&&displayedEventList.empty())?"No events created.":(displayedEventList.empty()?"System Error.":displayedEventList[0]),50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
-        else{for(const auto&t:displayedEventList){render_text("- "+t,50,yp,TEXT_COLOR,false,SCREEN_WIDTH-60);if(gFont)yp+=TTF_FontHeight(gFont)+5;else yp+=20; if(yp>SCREEN_HEIGHT-100){render_text("...more (not shown).",50,yp,TEXT_COLOR);break;}}}
-        currentButtonsOnScreen.emplace_back(50,SCREEN_HEIGHT-80,100,40,"Back",STATE_MAIN_MENU,99);
+        sc.labels.emplace_back(showOpenEventsOnly?"Events With Free Seats:":"All Events (by date):",50,60,TEXT_COLOR,false,SCREEN_WIDTH-100); int yp=100;
+        size_t rows = !eventManager ? 0 : listFromIndex ? indexed_row_count() : displayedEventList.size();
+        if(listJob||loadJob){sc.labels.emplace_back("Loading events...",50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
+        else if(rows==0){sc.labels.emplace_back(!eventManager?"System Error.":(showOpenEventsOnly&&eventManager->size()>0?"All events are full.":"No events created yet."),50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
+        else{eventListView.rowHeight=lineStep; eventListView.reset(rows); sc.list=&eventListView;}
+        sc.buttons.emplace_back(50,SCREEN_HEIGHT-80,100,40,"Back",STATE_MAIN_MENU,99);
+        sc.buttons.emplace_back(SCREEN_WIDTH-210,SCREEN_HEIGHT-80,160,40,showOpenEventsOnly?"Show All":"Open Only",currentState,20);
     }
     else if (currentState == STATE_DELETE_EVENT || currentState == STATE_SIGN_UP_FOR_EVENT || currentState == STATE_SEARCH_EVENT) {
         string titleText, buttonText;
         if (currentState == STATE_DELETE_EVENT) { titleText = "Enter title of event to DELETE:"; buttonText = "Delete"; sharedInputField.placeholder = "Title to Delete"; }
         else if (currentState == STATE_SIGN_UP_FOR_EVENT) { titleText = "Enter title of event to SIGN UP for:"; buttonText = "Sign Up"; sharedInputField.placeholder = "Title for Sign Up"; }
         else { titleText = "Enter event title to SEARCH:"; buttonText = "Search"; sharedInputField.placeholder = "Title to Search"; }
-        render_text(titleText, 50, 100, TEXT_COLOR, false, SCREEN_WIDTH-100);
-        
-        activeInputFieldsOnScreen = {&sharedInputField}; 
-        
-        if (focusedInputField != &sharedInputField || !sharedInputField.isActive) {
-            if(focusedInputField) focusedInputField->isActive = false; 
-            focusedInputField = &sharedInputField;
-            sharedInputField.isActive = true; 
-            std::cout << "State " << currentState << ": Set focus to sharedInputField. Placeholder: " << sharedInputField.placeholder << std::endl;
-        }
-        render_input_field(sharedInputField);
-
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-160,200,150,40,buttonText,currentState,0);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2+10,200,100,40,"Back",STATE_MAIN_MENU,99);
+        sc.labels.emplace_back(titleText, 50, 100, TEXT_COLOR, false, SCREEN_WIDTH-100);
+        sc.fields = {&sharedInputField}; 
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-160,200,150,40,buttonText,currentState,0);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2+10,200,100,40,"Back",STATE_MAIN_MENU,99);
     }
     else if (currentState == STATE_SEARCH_RESULTS) { 
-        render_text("Search Results:",50,60,TEXT_COLOR,false,SCREEN_WIDTH-100); int yp=100;
-        if(displayedEventList.empty()||(displayedEventList.size()==1&&displayedEventList[0].find("No events found")!=string::npos)){render_text(displayedEventList.empty()?"No results.":displayedEventList[0],50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
-        else{for(size_t i=0;i<displayedEventList.size();++i){render_text(to_string(i+1)+". "+displayedEventList[i],50,yp,TEXT_COLOR,false,SCREEN_WIDTH-60);if(gFont)yp+=TTF_FontHeight(gFont)+5;else yp+=20; if(yp>SCREEN_HEIGHT-100){render_text("...more (not shown).",50,yp,TEXT_COLOR);break;}}}
-        currentButtonsOnScreen.emplace_back(50,SCREEN_HEIGHT-80,100,40,"Back",STATE_SEARCH_EVENT,99);
+        sc.labels.emplace_back("Search Results:",50,60,TEXT_COLOR,false,SCREEN_WIDTH-100); int yp=100;
+        if(listJob||loadJob){sc.labels.emplace_back(loadJob?"Loading events...":"Searching for '"+lastSearchQuery+"'...",50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
+        else if(!eventManager||displayedEventList.empty()){sc.labels.emplace_back(!eventManager?"System Error.":(eventManager->size()==0?"No events available to search.":"No events found matching '"+lastSearchQuery+"'."),50,yp,TEXT_COLOR,false,SCREEN_WIDTH-100);}
+        else{eventListView.rowHeight=lineStep; eventListView.reset(displayedEventList.size()); sc.list=&eventListView;}
+        sc.buttons.emplace_back(50,SCREEN_HEIGHT-80,100,40,"Back",STATE_SEARCH_EVENT,99);
     }
     else if (currentState == STATE_CONFIRM_ACTION) { 
-        render_text("Confirm Action:",0,130,TEXT_COLOR,true,SCREEN_WIDTH);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-110,200,100,40,"Yes",currentState,10);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2+10,200,100,40,"No",currentState,11);
-        currentButtonsOnScreen.emplace_back(SCREEN_WIDTH/2-50,250,100,40,"Cancel",STATE_MAIN_MENU,99);
+        sc.labels.emplace_back("Confirm Action:",0,130,TEXT_COLOR,true,SCREEN_WIDTH);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-110,200,100,40,"Yes",currentState,10);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2+10,200,100,40,"No",currentState,11);
+        sc.buttons.emplace_back(SCREEN_WIDTH/2-50,250,100,40,"Cancel",STATE_MAIN_MENU,99);
     }
-    
-    update_button_hover(mX_curr, mY_curr, currentButtonsOnScreen); 
-    if (mouseClickedThisFrame) { handle_mouse_click(mX_poll, mY_poll, currentButtonsOnScreen, activeInputFieldsOnScreen); }
-    for (auto& btn : currentButtonsOnScreen) { render_button(btn); }
-    SDL_RenderPresent(gRenderer);
 }
 
 // --- Helper function definitions ---
@@ -346,25 +471,185 @@ void clear_input_fields_for_create_event() {
     eventPlatformInput.text = ""; 
     eventCapacityInput.text = ""; 
 }
+void invalidate_screen() {
+    screenStale = true;
+    request_redraw();
+}
 void clear_generic_input_buffer(){ 
     inputBuffer_generic = ""; 
     sharedInputField.text = ""; 
 }
+// Replaces whichever listing or search job is filling displayedEventList.
+static void begin_list_job(JobId id) {
+    if (jobScheduler && listJob) jobScheduler->cancel(listJob);
+    listJob = id;
+    displayedEventList.clear();
+    listFromIndex = false;
+    invalidate_screen();
+}
+void refresh_event_listing() { // Both orders need no job: rows are paged on demand
+    begin_list_job(0);
+    listFromIndex = eventManager != nullptr;
+}
+// Rows in the Show All listing: every event, or with Open Only those with a free seat.
+size_t indexed_row_count() {
+    return showOpenEventsOnly ? eventManager->getOpenEventCount() : eventManager->size();
+}
+// Formats rows [offset, offset + limit) of the list on screen for eventListView.
+void fetch_list_rows(size_t offset, size_t limit, vector<string>& out) {
+    if (eventManager && listFromIndex) {
+        shownListingVersion = showOpenEventsOnly ? eventManager->getOpenListingPage(offset, limit, listingRows)
+                                                 : eventManager->getListingPage(offset, limit, listingRows);
+        listingLines.resize(listingRows.size());
+        out.resize(listingRows.size()); // Assigning over the strings already there reuses their buffers
+        for (size_t i = 0; i < listingRows.size(); ++i) {
+            const ListingRow& r = listingRows[i];
+            ListingRow& line = listingLines[i];
+            if (line.handle != r.handle || line.version != r.version) {
+                line.handle = r.handle;
+                line.version = r.version;
+                line.text.assign("- ").append(r.text);
+            }
+            out[i] = line.text;
+        }
+        return;
+    }
+    out.clear();
+    if (!eventManager) return;
+    size_t end = min(displayedEventList.size(), offset + min(limit, displayedEventList.size()));
+    for (size_t i = offset; i < end; ++i) {
+        if (screenState == STATE_SEARCH_RESULTS) out.push_back(to_string(i + 1) + ". " + eventManager->getEventTitle(displayedEventList[i]));
+        else out.push_back("- " + eventManager->getEventSummary(displayedEventList[i]));
+    }
+}
+// Keeps Show All (either order) current while events change underneath it (sign-ups,
+// imports, background loads): rows are refetched in place when the listing
+// version moves, and only text the text cache has not seen is rasterized again.
+void follow_listing_changes() {
+    if (!eventManager || !listFromIndex || currentState != STATE_SHOW_ALL_EVENTS || listJob || loadJob) return;
+    uint64_t version = eventManager->getListingVersion();
+    if (version == shownListingVersion) return;
+    shownListingVersion = version; // Also covers the "no events" screen, which reads no rows
+    size_t rows = indexed_row_count();
+    if (rows == 0 || currentScreen.list != &eventListView) invalidate_screen(); // Switching between the list and its placeholder
+    else { eventListView.refresh(rows); request_redraw(); }
+}
+void start_search(const string& query) {
+    if (!eventManager || !jobScheduler) { begin_list_job(0); return; }
+    auto search = make_shared<EventSearch>(*eventManager, query); // Pins the current snapshot
+    begin_list_job(jobScheduler->submit(
+        [search] { return search->step(JOB_STEP_SLOTS); },
+        [search] { displayedEventList = search->takeResults(); listJob = 0; invalidate_screen(); }));
+}
+// The delete or sign-up itself, once the title needs no scan (see start_title_action).
+static void finish_title_action(AppState screen, const string& title) {
+    bool fd = false, fs = false;
+    if (screen == STATE_DELETE_EVENT) {
+        if (eventManager) currentMessage = eventManager->attemptDeleteEvent(title, fd, fs, suggestedEvent); else currentMessage = "Error: System not initialized.";
+        if (fd) clear_generic_input_buffer(); else if (fs) { actionToConfirm = 0; currentState = STATE_CONFIRM_ACTION; }
+    } else {
+        string sMsg;
+        if (eventManager && currentUser) currentMessage = eventManager->attemptSignUp(currentUser, title, fd, fs, sMsg, suggestedEvent); else currentMessage = "Error: System not initialized for sign up.";
+        if (fd) { currentMessage = sMsg; clear_generic_input_buffer(); } else if (fs) { actionToConfirm = 1; currentState = STATE_CONFIRM_ACTION; }
+    }
+    invalidate_screen();
+}
+// Delete and sign-up by title act at once when the title is exact or its "did
+// you mean" answer is cached. Otherwise the fuzzy scan runs as a stepped job,
+// as a search does, and the action follows if the screen is still up when it
+// completes (scanning again if a title changed meanwhile).
+void start_title_action(AppState screen, const string& title) {
+    if (jobScheduler && titleJob) { jobScheduler->cancel(titleJob); titleJob = 0; }
+    if (!eventManager || !jobScheduler || eventManager->answersTitleWithoutScan(title)) { finish_title_action(screen, title); return; }
+    auto scan = make_shared<SuggestionScan>(*eventManager, title); // Pins the current snapshot
+    titleJob = jobScheduler->submit(
+        [scan] { return scan->step(JOB_STEP_SLOTS); },
+        [screen, title] { titleJob = 0; if (currentState == screen) start_title_action(screen, title); });
+    currentMessage = "Looking for '" + title + "'...";
+    invalidate_screen();
+}
+void start_save() {
+    if (!eventManager || !jobScheduler || saveJob) return;
+    if (!eventManager->isLoaded()) { cout << "Events still loading; saving once they are in." << endl; return; } // See start_loading_events
+    auto writer = make_shared<EventFileWriter>(*eventManager); // Pins the current snapshot
+    saveJob = jobScheduler->submit(
+        [writer] { return writer->step(JOB_STEP_SLOTS); },
+        [writer] { saveJob = 0; invalidate_screen(); std::cout << "Events save on exit: " << (writer->succeeded() ? "OK" : "FAIL") << std::endl; });
+}
 void reset_confirmation_state() { 
-    suggestedMatch = ""; 
+    suggestedEvent = EventHandle{}; 
     actionToConfirm = -1; 
+    if (jobScheduler && titleJob) { jobScheduler->cancel(titleJob); titleJob = 0; } // Left the screen before the scan finished
+}
+
+// --- Startup ---
+static double startup_clock_ms() {
+    #ifdef __EMSCRIPTEN__
+    return emscripten_get_now(); // performance.now(): since navigation start
+    #else
+    static const chrono::steady_clock::time_point processStart = chrono::steady_clock::now(); // First call is at the top of main
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - processStart).count();
+    #endif
+}
+// Stores the milestone, logs it, and on the web publishes it as Module.startupTimings[name].
+void record_startup_milestone(const char* name, double& slot) {
+    slot = startup_clock_ms();
+    cout << "Startup: " << name << " = " << slot << " ms" << endl;
+    #ifdef __EMSCRIPTEN__
+    EM_ASM({ Module.startupTimings = Module.startupTimings || {}; Module.startupTimings[UTF8ToString($0)] = $1; }, name, slot);
+    #endif
+}
+// Reads the events file on the job scheduler, a slice of lines per step; the
+// screens that list events say "Loading events..." until it completes, then refresh.
+void start_loading_events() {
+    if (!eventManager || !jobScheduler || loadJob || eventManager->isLoaded()) return;
+    auto loader = make_shared<EventFileLoader>(*eventManager);
+    loadJob = jobScheduler->submit(
+        [loader] { return loader->step(JOB_STEP_LINES); },
+        [] {
+            loadJob = 0;
+            record_startup_milestone("dataReadyMs", startupTimings.dataReadyMs);
+            if (currentState == STATE_EXITED) start_save(); // Exited before the load finished
+            else if (currentState == STATE_SHOW_ALL_EVENTS) refresh_event_listing();
+            else if (currentState == STATE_SEARCH_RESULTS) start_search(lastSearchQuery);
+            invalidate_screen();
+        });
 }
+#ifdef __EMSCRIPTEN__
+// The full font arrived in MEMFS: swap it in. The new font is opened before the
+// old one is closed, so the text renderer sees a different font and rebuilds.
+static void full_font_fetched(const char* file) {
+    TTF_Font* full = TTF_OpenFont(file, FONT_SIZE);
+    if (!full) { cerr << "Failed to open downloaded font " << file << ": " << TTF_GetError() << endl; return; }
+    TTF_Font* startupFont = gFont;
+    gFont = full;
+    if (startupFont) TTF_CloseFont(startupFont);
+    record_startup_milestone("fontReadyMs", startupTimings.fontReadyMs);
+    invalidate_screen(); // Line heights may differ
+}
+static void full_font_failed(const char* file) {
+    cerr << "Failed to download " << file << "; keeping the startup font." << endl;
+}
+#endif
 
 
 bool init_sdl() { 
     if(SDL_Init(SDL_INIT_VIDEO|SDL_INIT_EVENTS)<0){cerr<<"SDL Init Fail: "<<SDL_GetError()<<endl;return false;}
     gWindow=SDL_CreateWindow("Event GUI",SDL_WINDOWPOS_UNDEFINED,SDL_WINDOWPOS_UNDEFINED,SCREEN_WIDTH,SCREEN_HEIGHT,SDL_WINDOW_SHOWN);
     if(!gWindow){cerr<<"Window Fail: "<<SDL_GetError()<<endl;return false;}
-    gRenderer=SDL_CreateRenderer(gWindow,-1,SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC);
+    gRenderer=SDL_CreateRenderer(gWindow,-1,rendererFlags);
+    if(!gRenderer)gRenderer=SDL_CreateRenderer(gWindow,-1,SDL_RENDERER_SOFTWARE); // e.g. under the dummy video driver
     if(!gRenderer){cerr<<"Renderer Fail: "<<SDL_GetError()<<endl;SDL_DestroyWindow(gWindow);gWindow=nullptr;return false;}
     if(TTF_Init()==-1){cerr<<"TTF Init Fail: "<<TTF_GetError()<<endl;SDL_DestroyRenderer(gRenderer);gRenderer=nullptr;SDL_DestroyWindow(gWindow);gWindow=nullptr;return false;}
     
-    gFont = TTF_OpenFont("arial.ttf", 18);
+    #ifdef __EMSCRIPTEN__
+    gFont = TTF_OpenFont(STARTUP_FONT_FILE, FONT_SIZE);
+    if (gFont) emscripten_async_wget(FULL_FONT_FILE, FULL_FONT_FILE, full_font_fetched, full_font_failed); // Downloads while the first frames draw
+    #endif
+    if (!gFont) { // Native builds, and web builds that preload the full font
+        gFont = TTF_OpenFont(FULL_FONT_FILE, FONT_SIZE);
+        if (gFont) record_startup_milestone("fontReadyMs", startupTimings.fontReadyMs);
+    }
     if (!gFont) {
         #ifndef __EMSCRIPTEN__
         std::cout << "arial.ttf not found, trying fallback fonts for native build..." << std::endl;
@@ -374,7 +659,7 @@ bool init_sdl() {
             "/System/Library/Fonts/Supplemental/Arial.ttf"
         };
         for (const string& p : fb_paths) {
-            gFont = TTF_OpenFont(p.c_str(), 18);
+            gFont = TTF_OpenFont(p.c_str(), FONT_SIZE);
             if (gFont) {
                 cout << "Loaded font from fallback: " << p << endl;
                 break;
@@ -388,40 +673,140 @@ bool init_sdl() {
     SDL_StartTextInput(); return true;
 }
 void close_sdl() { 
-    SDL_StopTextInput(); if(gFont)TTF_CloseFont(gFont);gFont=nullptr; if(gRenderer)SDL_DestroyRenderer(gRenderer);gRenderer=nullptr; if(gWindow)SDL_DestroyWindow(gWindow);gWindow=nullptr; TTF_Quit(); SDL_Quit();
+    SDL_StopTextInput(); text_renderer_shutdown(); if(gFont)TTF_CloseFont(gFont);gFont=nullptr; if(gRenderer)SDL_DestroyRenderer(gRenderer);gRenderer=nullptr; if(gWindow)SDL_DestroyWindow(gWindow);gWindow=nullptr; TTF_Quit(); SDL_Quit();
 }
 #ifdef __EMSCRIPTEN__
-extern "C" { void filesystem_ready_callback() { std::cout << "C++: Filesystem ready callback." << std::endl; } }
+// Called from the FS.syncfs callback once IndexedDB has populated the mount
+// (or failed to, in which case the file is simply not there).
+extern "C" { EMSCRIPTEN_KEEPALIVE void filesystem_ready_callback() { std::cout << "C++: Filesystem ready callback." << std::endl; start_loading_events(); } }
+#else
+// Command line of native builds:
+//   --record FILE        Record this session's input (format in input_replay.h)
+//   --replay FILE        Play an input script headless, then print frame-time percentiles
+//   --frame-times CSV    With --replay: write each drawn frame's phase times
+//   --fail-above-ms MS   With --replay: exit with status 3 if the p99 frame time exceeds MS
+//   --data FILE          Events file; a replay starts from an empty in-memory list unless given, and never saves
+struct NativeOptions {
+    string recordPath, replayPath, frameTimesPath, dataFile = events::DEFAULT_DATA_FILE;
+    bool dataFileGiven = false;
+    double failAboveMs = 0;
+};
+static bool parse_native_options(int argc, char* argv[], NativeOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg != "--record" && arg != "--replay" && arg != "--frame-times" && arg != "--data" && arg != "--fail-above-ms") { cerr << "Error: Unknown option " << arg << "." << endl; return false; }
+        if (i + 1 >= argc) { cerr << "Error: " << arg << " needs a value." << endl; return false; }
+        string value = argv[++i];
+        if (arg == "--record") options.recordPath = value;
+        else if (arg == "--replay") options.replayPath = value;
+        else if (arg == "--frame-times") options.frameTimesPath = value;
+        else if (arg == "--data") { options.dataFile = value; options.dataFileGiven = true; }
+        else if (arg == "--fail-above-ms") {
+            char* end = nullptr;
+            options.failAboveMs = strtod(value.c_str(), &end);
+            if (*end != '\0' || options.failAboveMs <= 0) { cerr << "Error: --fail-above-ms needs a positive number." << endl; return false; }
+        }
+    }
+    if (!options.recordPath.empty() && !options.replayPath.empty()) { cerr << "Error: --record and --replay cannot be combined." << endl; return false; }
+    if (options.replayPath.empty() && (!options.frameTimesPath.empty() || options.failAboveMs > 0)) { cerr << "Error: --frame-times and --fail-above-ms need --replay." << endl; return false; }
+    if (!options.replayPath.empty() && !options.dataFileGiven) options.dataFile = ""; // Same starting state every run
+    return true;
+}
+// Feeds each frame its scripted events, with every job finished beforehand so
+// results land on the same frame every run; quits the frame after the script
+// ends if it does not quit itself.
+static void run_replay(InputScript& script, FrameTimeLog& log) {
+    bool quitPushed = script.hasQuit();
+    while (currentState != STATE_EXITED) {
+        if (jobScheduler) jobScheduler->waitUntilIdle(); // Outside the measured frame
+        script.pushEventsFor(loopIteration);
+        if (!quitPushed && loopIteration > 0 && script.finishedAfter(loopIteration - 1)) {
+            SDL_Event quit = {}; quit.type = SDL_QUIT;
+            SDL_PushEvent(&quit); quitPushed = true;
+        }
+        main_loop_iteration(); log.add(loopIteration, lastFrameTiming); ++loopIteration;
+    }
+}
 #endif
 int main(int argc, char* argv[]) {
+    startup_clock_ms(); // Natively, milestones count from here
+    #ifdef __EMSCRIPTEN__
+    (void)argc; (void)argv;
+    const string dataFile = events::DEFAULT_DATA_FILE;
+    #else
+    NativeOptions options;
+    if (!parse_native_options(argc, argv, options)) return 2;
+    InputScript script;
+    if (!options.replayPath.empty()) {
+        if (!script.load(options.replayPath)) return 1;
+        cout << "Replaying " << script.eventCount() << " input events from " << options.replayPath << endl;
+        SDL_SetHintWithPriority(SDL_HINT_VIDEODRIVER, "dummy", SDL_HINT_DEFAULT); // Headless; an SDL_VIDEODRIVER setting still wins
+        rendererFlags = SDL_RENDERER_ACCELERATED;
+    }
+    if (!options.recordPath.empty() && !inputRecorder.open(options.recordPath)) return 1;
+    const string dataFile = options.dataFile;
+    #endif
     if (!init_sdl()) { close_sdl(); return 1; }
+    currentUser = User::getInstance(); eventManager = new events(dataFile, events::DeferLoad()); jobScheduler = new JobScheduler();
+    #ifndef __EMSCRIPTEN__
+    if (!options.replayPath.empty()) eventManager->disableSaving(); // A replay reads --data but never writes it back
+    #endif
+    events_api_attach(eventManager);
+    eventListView.fetchRows = fetch_list_rows;
+    memory_set_evictor(MEM_TEXT_CACHE, text_cache_trim);
+    memory_set_evictor(MEM_SNAPSHOTS, [](size_t) { if (eventManager) eventManager->reclaimRetired(); });
     #ifdef __EMSCRIPTEN__ 
     EM_ASM(
         if (typeof FS !=='undefined'&&FS.mkdir&&FS.mount&&FS.syncfs&&typeof IDBFS !=='undefined') {
             const idbfsP = '/database_eventmgm'; FS.mkdir(idbfsP); FS.mount(IDBFS,{},idbfsP);
             console.log('Attempting FS.syncfs for ' + idbfsP);
-            FS.syncfs(true, function(err){ if(err)console.error("FS.syncfs load err for "+idbfsP+":",err); else console.log("FS.syncfs load OK for "+idbfsP); });
-        } else console.warn("FS/IDBFS not fully available for persistence.");
+            const syncStarted = performance.now();
+            FS.syncfs(true, function(err){ Module.ccall('metrics_record_sync', null, ['number','number'], [performance.now() - syncStarted, err ? 1 : 0]); if(err)console.error("FS.syncfs load err for "+idbfsP+":",err); else console.log("FS.syncfs load OK for "+idbfsP); Module.ccall('filesystem_ready_callback', null, [], []); });
+        } else { console.warn("FS/IDBFS not fully available for persistence."); Module.ccall('filesystem_ready_callback', null, [], []); }
     );
+    #else
+    if (const char* tracePath = getenv("EVENTS_TRACE")) { if (guiTraceRecorder.open(tracePath)) eventManager->setTraceRecorder(&guiTraceRecorder); }
+    start_loading_events(); // No storage to wait for; the worker thread reads the file while the first frame draws
     #endif
-    currentUser = User::getInstance(); eventManager = new events(); 
     if (currentState == STATE_USER_DETAILS ) { focusedInputField = &userNameInput; if(focusedInputField)focusedInputField->isActive = true;}
 
 
+    int exitCode = 0;
     #ifdef __EMSCRIPTEN__
         emscripten_set_main_loop(main_loop_iteration, 0, 1);
     #else
-        bool running_native = true; SDL_Event event_native; Uint32 last_tick = SDL_GetTicks();
+    if (!options.replayPath.empty()) {
+        FrameTimeLog frameTimes;
+        run_replay(script, frameTimes);
+        frameTimes.printSummary(cout);
+        if (!options.frameTimesPath.empty() && frameTimes.writeCsv(options.frameTimesPath)) cout << "Frame times written to " << options.frameTimesPath << endl;
+        double p99 = frameTimes.percentileTotalMs(99);
+        if (options.failAboveMs > 0 && p99 > options.failAboveMs) {
+            cerr << "Error: p99 frame time " << p99 << " ms is above " << options.failAboveMs << " ms." << endl;
+            exitCode = 3;
+        }
+    } else {
+        // Sleep until input arrives (left queued for main_loop_iteration), a redraw is
+        // already due, or pending jobs need their results picked up.
+        bool running_native = true;
         while (running_native) { 
-            Uint32 current_tick = SDL_GetTicks(); if (current_tick - last_tick < 16) SDL_Delay(16 - (current_tick - last_tick)); last_tick = current_tick;
-            while(SDL_PollEvent(&event_native)!=0){ if(event_native.type == SDL_QUIT){ running_native=false; if(eventManager && currentState != STATE_EXITED)eventManager->saveEventsToFile();}} 
-            if (!running_native && currentState != STATE_EXITED) { currentState = STATE_EXITED; } 
-            main_loop_iteration(); if (currentState == STATE_EXITED && running_native) running_native = false; 
+            Uint32 wait_ms = redraw_requested() ? 0 : (jobScheduler && jobScheduler->pendingCount() > 0) ? 16 : IDLE_WAIT_MS;
+            if (wait_ms > 0) SDL_WaitEventTimeout(nullptr, static_cast<int>(wait_ms));
+            main_loop_iteration(); ++loopIteration; if (currentState == STATE_EXITED) running_native = false; 
         }
+    }
+    inputRecorder.close();
     #endif
-    cout << "Exiting main. Cleaning up..." << endl; 
+    cout << "Tracked memory (KB, peak):";
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) { MemoryUsage u = memory_usage(static_cast<MemoryTag>(t)); cout << " " << memory_tag_name(static_cast<MemoryTag>(t)) << " " << u.bytes / 1024 << " (" << u.peakBytes / 1024 << ")"; }
+    cout << endl;
+    cout << "Exiting main. Frames drawn: " << framesDrawn << ", skipped: " << framesSkipped;
+    if (ALLOC_COUNTER_ENABLED) cout << ", drawn frames that allocated in the UI path: " << framesAllocating;
+    cout << ", draw calls in the last frame: " << gDrawList.lastFrameStats().drawCalls << ". Cleaning up..." << endl; 
+    if (jobScheduler) { delete jobScheduler; jobScheduler = nullptr; } // Finishes a pending save; jobs pin snapshots of eventManager
+    events_api_attach(nullptr);
     if (eventManager) { delete eventManager; eventManager = nullptr; } 
     close_sdl(); cout << "SDL closed. Terminated." << endl;
-    return 0;
+    return exitCode;
 }
 
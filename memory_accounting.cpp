@@ -0,0 +1,178 @@
+#include "memory_accounting.h"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#include <emscripten/heap.h>
+#include <malloc.h>
+#include <unistd.h>
+#define MEMORY_EXPORT EMSCRIPTEN_KEEPALIVE
+#else
+#define MEMORY_EXPORT
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif
+
+using namespace std;
+
+MemoryAccount gMemoryAccounts[MEM_TAG_COUNT];
+
+static const char* const TAG_NAMES[MEM_TAG_COUNT] = {"events", "attendees", "indexes", "snapshots", "text_cache", "glyph_atlas", "api_results"};
+
+// Evictors and the headroom are configuration, touched rarely and only from the UI thread.
+static mutex configLock;
+static function<void(size_t)> evictors[MEM_TAG_COUNT];
+#ifdef __EMSCRIPTEN__
+static uint64_t heapHeadroom = DEFAULT_HEAP_HEADROOM_BYTES;
+// Freed chunks go back to malloc, not above the break, so headroom does not
+// recover after an eviction. Remember where the last one left things and
+// evict again only once the heap has grown or the tracked bytes have grown by
+// the headroom since; otherwise every evictor would run on every frame.
+static uint64_t lowHeapSize = 0;   // Heap size at the last low-headroom eviction
+static int64_t lowHeapTracked = 0; // Tracked bytes just after it
+#else
+static uint64_t heapHeadroom = 0; // Native heaps grow without copying: nothing to get ahead of
+#endif
+
+const char* memory_tag_name(MemoryTag tag) {
+    return tag >= 0 && tag < MEM_TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+MemoryUsage memory_usage(MemoryTag tag) {
+    const MemoryAccount& account = gMemoryAccounts[tag];
+    MemoryUsage usage;
+    usage.bytes = account.bytes.load(memory_order_relaxed);
+    usage.peakBytes = account.peakBytes.load(memory_order_relaxed);
+    usage.budgetBytes = account.budgetBytes.load(memory_order_relaxed);
+    usage.evictions = account.evictions.load(memory_order_relaxed);
+    return usage;
+}
+
+int64_t memory_tracked_bytes() {
+    int64_t total = 0;
+    for (const MemoryAccount& account : gMemoryAccounts) total += account.bytes.load(memory_order_relaxed);
+    return total;
+}
+
+void memory_set_tag_budget(MemoryTag tag, uint64_t budgetBytes) {
+    gMemoryAccounts[tag].budgetBytes.store(budgetBytes, memory_order_relaxed);
+}
+
+void memory_set_evictor(MemoryTag tag, function<void(size_t)> evictor) {
+    lock_guard<mutex> guard(configLock);
+    evictors[tag] = move(evictor);
+}
+
+void memory_set_headroom(uint64_t bytes) {
+    lock_guard<mutex> guard(configLock);
+    heapHeadroom = bytes;
+}
+
+#ifdef __EMSCRIPTEN__
+// Space above the program break: what malloc can still take before the heap
+// has to grow. Free chunks inside malloc's arena are not counted, so this errs
+// towards evicting early. O(1), unlike mallinfo().
+static uint64_t heap_headroom() {
+    uint64_t size = emscripten_get_heap_size();
+    uint64_t brk = reinterpret_cast<uintptr_t>(sbrk(0));
+    return size > brk ? size - brk : 0;
+}
+#endif
+
+HeapUsage memory_heap_usage() {
+    HeapUsage heap;
+#ifdef __EMSCRIPTEN__
+    struct mallinfo info = mallinfo(); // Walks the heap: for reports, not every frame
+    heap.sizeBytes = emscripten_get_heap_size();
+    heap.usedBytes = static_cast<uint64_t>(info.uordblks);
+    heap.headroomBytes = heap_headroom();
+#elif defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+    heap.sizeBytes = info.arena + info.hblkhd;
+    heap.usedBytes = info.uordblks + info.hblkhd;
+#endif
+#endif
+    return heap;
+}
+
+void memory_enforce_budgets() {
+    bool heapLow = false;
+#ifdef __EMSCRIPTEN__
+    uint64_t headroom = heapHeadroom; // Only the UI thread writes it
+    heapLow = headroom > 0 && heap_headroom() < headroom &&
+              (emscripten_get_heap_size() != lowHeapSize || memory_tracked_bytes() >= lowHeapTracked + static_cast<int64_t>(headroom));
+#endif
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        MemoryAccount& account = gMemoryAccounts[t];
+        int64_t bytes = account.bytes.load(memory_order_relaxed);
+        uint64_t budget = account.budgetBytes.load(memory_order_relaxed);
+        size_t target;
+        if (heapLow && bytes > 0) target = static_cast<size_t>(bytes / 2);
+        else if (budget > 0 && bytes > static_cast<int64_t>(budget)) target = static_cast<size_t>(budget);
+        else continue; // The common case: no lock, no call
+        function<void(size_t)> evictor;
+        {
+            lock_guard<mutex> guard(configLock);
+            evictor = evictors[t];
+        }
+        if (!evictor) continue;
+        account.evictions.fetch_add(1, memory_order_relaxed);
+        evictor(target);
+    }
+#ifdef __EMSCRIPTEN__
+    if (heapLow) {
+        lowHeapSize = emscripten_get_heap_size();
+        lowHeapTracked = memory_tracked_bytes();
+    }
+#endif
+}
+
+string memory_breakdown() {
+    string json;
+    json.reserve(128 + 96 * MEM_TAG_COUNT);
+    char buffer[192];
+    json += "{\"tags\":{";
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        MemoryUsage u = memory_usage(static_cast<MemoryTag>(t));
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":{\"bytes\":%lld,\"peak\":%lld,\"budget\":%llu,\"evictions\":%llu}", t ? "," : "",
+                 TAG_NAMES[t], static_cast<long long>(u.bytes), static_cast<long long>(u.peakBytes),
+                 static_cast<unsigned long long>(u.budgetBytes), static_cast<unsigned long long>(u.evictions));
+        json += buffer;
+    }
+    HeapUsage heap = memory_heap_usage();
+    snprintf(buffer, sizeof(buffer), "},\"tracked\":%lld,\"heap\":{\"size\":%llu,\"used\":%llu,\"headroom\":%llu}}",
+             static_cast<long long>(memory_tracked_bytes()), static_cast<unsigned long long>(heap.sizeBytes),
+             static_cast<unsigned long long>(heap.usedBytes), static_cast<unsigned long long>(heap.headroomBytes));
+    json += buffer;
+    return json;
+}
+
+// --- Exported functions ---
+extern "C" {
+
+MEMORY_EXPORT const char* memory_breakdown_json() {
+    static string breakdown;
+    breakdown = memory_breakdown();
+    return breakdown.c_str();
+}
+
+MEMORY_EXPORT int memory_set_budget(const char* tag, double budgetBytes) {
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        if (tag && strcmp(tag, TAG_NAMES[t]) == 0) {
+            memory_set_tag_budget(static_cast<MemoryTag>(t), budgetBytes > 0 ? static_cast<uint64_t>(budgetBytes) : 0);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+MEMORY_EXPORT void memory_set_heap_headroom(double bytes) {
+    memory_set_headroom(bytes > 0 ? static_cast<uint64_t>(bytes) : 0);
+}
+
+}
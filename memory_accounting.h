@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// --- Memory accounting ---
+// Live bytes per subsystem, kept by the owners of the memory: containers use
+// TrackedAllocator, and objects whose size is known only after construction
+// (strings, SDL textures) call memory_add / memory_release themselves. Every
+// update is one relaxed atomic add, so the accounts are always on.
+//
+// A tag may have a budget. memory_enforce_budgets(), called once per frame on
+// the UI thread, runs the evictor registered for each tag over its budget, and
+// every evictor when the heap is about to grow (WebAssembly builds: free space
+// in the current heap below the headroom; once per heap size, unless the tracked
+// bytes grow by the headroom again). Tags without an evictor (the event table
+// itself) are only reported.
+enum MemoryTag {
+    MEM_EVENTS,       // Event objects and the slot table
+    MEM_ATTENDEES,    // Attendee objects and attendee list blocks
+    MEM_INDEXES,      // Title, time and availability indexes
+    MEM_SNAPSHOTS,    // Published snapshot versions and their chunks
+    MEM_TEXT_CACHE,   // TextTextureCache textures (estimated at 4 bytes a pixel)
+    MEM_GLYPH_ATLAS,  // Glyph atlas texture
+    MEM_API_RESULTS,  // Result columns and string table of the JavaScript API (events_api.h)
+    MEM_TAG_COUNT
+};
+
+const char* memory_tag_name(MemoryTag tag); // "events", "attendees", ...
+
+struct MemoryAccount {
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peakBytes{0};
+    std::atomic<uint64_t> budgetBytes{0}; // 0: no budget
+    std::atomic<uint64_t> evictions{0};   // Times the evictor was run for this tag
+};
+
+extern MemoryAccount gMemoryAccounts[MEM_TAG_COUNT]; // Constant-initialized: usable from static constructors
+
+inline void memory_add(MemoryTag tag, size_t bytes) {
+    MemoryAccount& account = gMemoryAccounts[tag];
+    int64_t now = account.bytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+    int64_t peak = account.peakBytes.load(std::memory_order_relaxed);
+    while (now > peak && !account.peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+}
+
+inline void memory_release(MemoryTag tag, size_t bytes) {
+    gMemoryAccounts[tag].bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+struct MemoryUsage {
+    int64_t bytes = 0;
+    int64_t peakBytes = 0;
+    uint64_t budgetBytes = 0;
+    uint64_t evictions = 0;
+};
+MemoryUsage memory_usage(MemoryTag tag);
+int64_t memory_tracked_bytes(); // Sum over every tag
+
+void memory_set_tag_budget(MemoryTag tag, uint64_t budgetBytes); // 0 removes the budget
+// Called on the UI thread with the tag's target size; frees what it can down to it.
+void memory_set_evictor(MemoryTag tag, std::function<void(size_t targetBytes)> evictor);
+// Web builds: once less than this is free before the heap has to grow, every
+// evictor is asked to halve its tag, again only after the heap grows or the
+// tracked bytes grow by this much. 0 turns the check off.
+void memory_set_headroom(uint64_t bytes);
+const uint64_t DEFAULT_HEAP_HEADROOM_BYTES = 8 * 1024 * 1024;
+void memory_enforce_budgets();
+
+// Heap as the allocator sees it; 0 where the platform cannot tell.
+struct HeapUsage {
+    uint64_t sizeBytes = 0;     // Current heap (WASM memory) size
+    uint64_t usedBytes = 0;     // Allocated by malloc and still in use
+    uint64_t headroomBytes = 0; // Free before the heap has to grow
+};
+HeapUsage memory_heap_usage();
+
+// {"tags":{"events":{"bytes":..,"peak":..,"budget":..,"evictions":..},...},"tracked":..,"heap":{"size":..,"used":..,"headroom":..}}
+std::string memory_breakdown();
+
+// Bytes a string holds on the heap beyond its own object (none while it fits
+// in the small-string buffer).
+inline size_t string_heap_bytes(const std::string& s) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+// Standard allocator that charges what it hands out to `Tag`.
+template <typename T, MemoryTag Tag>
+struct TrackedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef TrackedAllocator<U, Tag> other; };
+
+    TrackedAllocator() noexcept = default;
+    template <typename U> TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        T* p = std::allocator<T>().allocate(n);
+        memory_add(Tag, n * sizeof(T));
+        return p;
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        memory_release(Tag, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <typename U> bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const TrackedAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+// Exported to JavaScript (add all three to EXPORTED_FUNCTIONS):
+//   JSON.parse(Module.ccall('memory_breakdown_json', 'string', [], []))
+//   Module.ccall('memory_set_budget', 'number', ['string', 'number'], ['text_cache', 2 << 20])
+// The returned buffer stays valid until the next call.
+extern "C" {
+const char* memory_breakdown_json();
+int memory_set_budget(const char* tag, double budgetBytes); // 0 if the tag is unknown
+void memory_set_heap_headroom(double bytes);
+}
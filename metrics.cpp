@@ -0,0 +1,139 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#define METRICS_EXPORT EMSCRIPTEN_KEEPALIVE
+#else
+#define METRICS_EXPORT
+#endif
+
+using namespace std;
+
+// --- Metric types ---
+MetricCounter::MetricCounter(const char* name) : metricName(name) {
+    MetricsRegistry::global().add(this);
+}
+
+MetricGauge::MetricGauge(const char* name) : metricName(name) {
+    MetricsRegistry::global().add(this);
+}
+
+LatencyHistogram::LatencyHistogram(const char* name) : metricName(name) {
+    MetricsRegistry::global().add(this);
+}
+
+int LatencyHistogram::bucketOf(uint64_t v) {
+    if (v < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(v);
+    int exponent = 63 - __builtin_clzll(v);      // >= SUB_BUCKET_BITS
+    int shift = exponent - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((v >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t low = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return low + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets[bucketOf(ns)].fetch_add(1, memory_order_relaxed);
+    sum.fetch_add(ns, memory_order_relaxed);
+    uint64_t seen = maxValue.load(memory_order_relaxed);
+    while (ns > seen && !maxValue.compare_exchange_weak(seen, ns, memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const {
+    Summary s;
+    uint64_t counts[BUCKET_COUNT];
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        counts[b] = buckets[b].load(memory_order_relaxed);
+        s.count += counts[b]; // Summed from the buckets so the percentiles agree with it
+    }
+    s.sum = sum.load(memory_order_relaxed);
+    s.max = maxValue.load(memory_order_relaxed);
+    if (s.count == 0) return s;
+    const double quantiles[4] = {0.5, 0.9, 0.99, 0.999};
+    uint64_t* outputs[4] = {&s.p50, &s.p90, &s.p99, &s.p999};
+    uint64_t seen = 0;
+    int q = 0;
+    for (int b = 0; b < BUCKET_COUNT && q < 4; ++b) {
+        seen += counts[b];
+        while (q < 4 && seen >= static_cast<uint64_t>(quantiles[q] * s.count + 0.5) && seen > 0) {
+            *outputs[q++] = min(bucketUpperBound(b), s.max);
+        }
+    }
+    return s;
+}
+
+// --- MetricsRegistry ---
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry; // Constructed on first use, so metrics in any translation unit can register
+    return registry;
+}
+
+void MetricsRegistry::add(MetricCounter* counter) {
+    lock_guard<mutex> guard(lock);
+    counters.push_back(counter);
+}
+
+void MetricsRegistry::add(MetricGauge* gauge) {
+    lock_guard<mutex> guard(lock);
+    gauges.push_back(gauge);
+}
+
+void MetricsRegistry::add(LatencyHistogram* histogram) {
+    lock_guard<mutex> guard(lock);
+    histograms.push_back(histogram);
+}
+
+string MetricsRegistry::snapshotJson() const {
+    lock_guard<mutex> guard(lock);
+    string json;
+    json.reserve(256 + 48 * (counters.size() + gauges.size()) + 160 * histograms.size());
+    char buffer[256];
+    json += "{\"counters\":{";
+    for (size_t i = 0; i < counters.size(); ++i) {
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":%llu", i ? "," : "", counters[i]->name(),
+                 static_cast<unsigned long long>(counters[i]->get()));
+        json += buffer;
+    }
+    json += "},\"gauges\":{";
+    for (size_t i = 0; i < gauges.size(); ++i) {
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":%lld", i ? "," : "", gauges[i]->name(), static_cast<long long>(gauges[i]->get()));
+        json += buffer;
+    }
+    json += "},\"histograms\":{";
+    for (size_t i = 0; i < histograms.size(); ++i) {
+        LatencyHistogram::Summary s = histograms[i]->summarize();
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":{\"count\":%llu,\"sum\":%llu,\"max\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu}",
+                 i ? "," : "", histograms[i]->name(), static_cast<unsigned long long>(s.count), static_cast<unsigned long long>(s.sum),
+                 static_cast<unsigned long long>(s.max), static_cast<unsigned long long>(s.p50), static_cast<unsigned long long>(s.p90),
+                 static_cast<unsigned long long>(s.p99), static_cast<unsigned long long>(s.p999));
+        json += buffer;
+    }
+    json += "}}";
+    return json;
+}
+
+EventMetrics gMetrics;
+
+// --- Exported functions ---
+extern "C" {
+
+METRICS_EXPORT const char* metrics_snapshot_json() {
+    static string snapshot;
+    snapshot = MetricsRegistry::global().snapshotJson();
+    return snapshot.c_str();
+}
+
+METRICS_EXPORT void metrics_record_sync(double milliseconds, int failed) {
+    if (milliseconds < 0) milliseconds = 0;
+    gMetrics.syncDuration.record(static_cast<uint64_t>(milliseconds * 1e6));
+    if (failed) gMetrics.syncFailures.add();
+}
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// --- Metrics ---
+// Process-wide counters, gauges and latency histograms for the events core,
+// cheap enough to leave on: recording is one relaxed atomic add (histograms:
+// two, plus a compare-and-swap when a new maximum is seen). Hot loops count
+// locally and add once per step. Every metric registers itself with
+// MetricsRegistry::global() by name; snapshotJson() reads them all, and
+// metrics_snapshot_json() (below) hands that to JavaScript.
+class MetricCounter {
+public:
+    explicit MetricCounter(const char* name);
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    const char* name() const { return metricName; }
+
+private:
+    const char* metricName;
+    std::atomic<uint64_t> value{0};
+};
+
+class MetricGauge {
+public:
+    explicit MetricGauge(const char* name);
+    void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(int64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t get() const { return value.load(std::memory_order_relaxed); }
+    const char* name() const { return metricName; }
+
+private:
+    const char* metricName;
+    std::atomic<int64_t> value{0};
+};
+
+// HDR-style log-linear buckets: exact below 16, then 16 buckets per power of
+// two, so any recorded value is reported within 1/16 (6.25%) of itself, from
+// nanoseconds to centuries, in a fixed 8 KB.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    explicit LatencyHistogram(const char* name); // Values in nanoseconds
+    void record(uint64_t ns);
+    const char* name() const { return metricName; }
+
+    struct Summary {
+        uint64_t count = 0, sum = 0, max = 0;
+        uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0; // Upper bound of the bucket holding the percentile
+    };
+    Summary summarize() const;
+
+    static int bucketOf(uint64_t v);
+    static uint64_t bucketUpperBound(int bucket);
+
+private:
+    const char* metricName;
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+};
+
+inline uint64_t metrics_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Records the time from construction to destruction.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& h) : histogram(h), startNs(metrics_now_ns()) {}
+    ~ScopedLatency() { histogram.record(metrics_now_ns() - startNs); }
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram;
+    uint64_t startNs;
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& global();
+
+    void add(MetricCounter* counter);
+    void add(MetricGauge* gauge);
+    void add(LatencyHistogram* histogram);
+    // {"counters":{name:value,...},"gauges":{...},"histograms":{name:{"count":..,"sum":..,"max":..,"p50":..,...}}}
+    std::string snapshotJson() const;
+
+private:
+    mutable std::mutex lock; // Guards registration only; values are read atomically
+    std::vector<MetricCounter*> counters;
+    std::vector<MetricGauge*> gauges;
+    std::vector<LatencyHistogram*> histograms;
+};
+
+// The events core's metrics. Histograms are in nanoseconds; search and save
+// durations are the time spent in their steps, as for the operation trace.
+struct EventMetrics {
+    MetricCounter signUps{"signups_total"};                 // Seats taken
+    MetricCounter signUpsRefused{"signups_refused_total"};  // Event full
+    MetricCounter signUpsNotFound{"signups_not_found_total"};
+    MetricCounter searches{"searches_total"};
+    MetricCounter levenshteinCalls{"levenshtein_calls_total"};
+    MetricCounter candidatesPruned{"candidates_pruned_total"}; // Ruled out by length before Levenshtein
+    MetricCounter suggestionCacheHits{"suggestion_cache_hits_total"};     // "Did you mean" answered without a scan
+    MetricCounter suggestionCacheMisses{"suggestion_cache_misses_total"};
+    MetricCounter suggestionCacheSavedNs{"suggestion_cache_saved_ns_total"}; // Scan time the hits did not spend
+    MetricCounter eventsCreated{"events_created_total"};
+    MetricCounter eventsDeleted{"events_deleted_total"};
+    MetricCounter saves{"saves_total"};
+    MetricCounter saveFailures{"save_failures_total"};
+    MetricCounter bytesSaved{"bytes_saved_total"};
+    MetricCounter loads{"loads_total"};
+    MetricCounter bytesLoaded{"bytes_loaded_total"};
+    MetricCounter syncFailures{"sync_failures_total"};
+    MetricGauge liveEvents{"live_events"}; // Across every events manager in the process
+    LatencyHistogram signUpLatency{"signup_latency_ns"};
+    LatencyHistogram searchLatency{"search_latency_ns"};
+    LatencyHistogram saveDuration{"save_duration_ns"};
+    LatencyHistogram loadDuration{"load_duration_ns"};
+    LatencyHistogram syncDuration{"sync_duration_ns"}; // IndexedDB FS.syncfs, browser builds only
+};
+
+extern EventMetrics gMetrics;
+
+// Exported to JavaScript (add both to EXPORTED_FUNCTIONS):
+//   JSON.parse(Module.ccall('metrics_snapshot_json', 'string', [], []))
+// The returned buffer stays valid until the next call.
+extern "C" {
+const char* metrics_snapshot_json();
+void metrics_record_sync(double milliseconds, int failed); // Called from FS.syncfs callbacks
+}
@@ -0,0 +1,129 @@
+#include "op_trace.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+static const char TRACE_MAGIC[8] = {'E', 'V', 'T', 'R', 'A', 'C', 'E', '1'};
+
+const char* traceOpName(TraceOp op) {
+    switch (op) {
+        case TRACE_CREATE: return "create";
+        case TRACE_SIGN_UP: return "signUp";
+        case TRACE_SEARCH: return "search";
+        case TRACE_DELETE: return "delete";
+        case TRACE_SAVE: return "save";
+    }
+    return "unknown";
+}
+
+static void putVarint(string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out += static_cast<char>((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+// --- OpTraceRecorder ---
+bool OpTraceRecorder::open(const string& path) {
+    lock_guard<mutex> guard(lock);
+    if (file.is_open()) file.close();
+    file.open(path, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open trace file " << path << " for writing." << endl;
+        return false;
+    }
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    opened = chrono::steady_clock::now();
+    lastStartNs = 0;
+    records = 0;
+    return true;
+}
+
+void OpTraceRecorder::close() {
+    lock_guard<mutex> guard(lock);
+    if (file.is_open()) file.close();
+}
+
+uint64_t OpTraceRecorder::nowNs() const {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - opened).count());
+}
+
+void OpTraceRecorder::record(TraceOp op, uint64_t startNs, uint64_t durationNs, uint64_t outcome, initializer_list<string> fields) {
+    lock_guard<mutex> guard(lock);
+    if (!file.is_open()) return;
+    buffer.clear();
+    buffer += static_cast<char>(op);
+    int64_t delta = static_cast<int64_t>(startNs - lastStartNs);
+    putVarint(buffer, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63)); // Zigzag
+    putVarint(buffer, durationNs);
+    putVarint(buffer, outcome);
+    buffer += static_cast<char>(fields.size());
+    for (const string& f : fields) {
+        putVarint(buffer, f.size());
+        buffer += f;
+    }
+    file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    lastStartNs = startNs;
+    ++records;
+}
+
+uint64_t OpTraceRecorder::recordCount() const {
+    lock_guard<mutex> guard(lock);
+    return records;
+}
+
+// --- OpTraceReader ---
+bool OpTraceReader::open(const string& path) {
+    file.open(path, ios::binary);
+    if (!file.is_open()) {
+        lastError = "could not open " + path;
+        return false;
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), TRACE_MAGIC)) {
+        lastError = path + " is not an events trace";
+        return false;
+    }
+    lastStartNs = 0;
+    return true;
+}
+
+bool OpTraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = file.get();
+        if (c == EOF) return false;
+        value |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool OpTraceReader::next(TraceRecord& record) {
+    int op = file.get();
+    if (op == EOF) return false;
+    uint64_t zigzag = 0;
+    int fieldCount = EOF;
+    bool ok = op >= TRACE_CREATE && op <= TRACE_SAVE && readVarint(zigzag) && readVarint(record.durationNs) &&
+              readVarint(record.outcome) && (fieldCount = file.get()) != EOF;
+    record.fields.resize(ok ? static_cast<size_t>(fieldCount) : 0);
+    for (size_t i = 0; ok && i < record.fields.size(); ++i) {
+        uint64_t length = 0;
+        ok = readVarint(length) && length <= (1u << 24);
+        if (!ok) break;
+        record.fields[i].resize(static_cast<size_t>(length));
+        ok = length == 0 || file.read(&record.fields[i][0], static_cast<streamsize>(length));
+    }
+    if (!ok) {
+        lastError = "truncated or corrupt record";
+        return false;
+    }
+    record.op = static_cast<TraceOp>(op);
+    int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    record.startNs = lastStartNs + static_cast<uint64_t>(delta);
+    lastStartNs = record.startNs;
+    return true;
+}
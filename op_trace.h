@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// --- Operation traces ---
+// A compact binary log of the calls made on an `events` manager (creates,
+// sign-ups, searches, deletes, saves) with their start times, durations and
+// outcomes, so a real session can be replayed later (tools/trace_replay.cpp).
+//
+// File layout: the 8-byte magic "EVTRACE1", then one record per call:
+//   u8 op | varint zigzag(start - previous start) ns | varint duration ns |
+//   varint outcome | u8 field count | per field: varint length, bytes
+// Fields by op:
+//   TRACE_CREATE:  type ("0".."2"), host, title, description, date, platform, capacity
+//   TRACE_SIGN_UP: title query, name, email, phone, company
+// Fields that identify a person (the host, and a sign-up's name, email, phone
+// and company) are stored the way the data file stores them, cEncrypt(field,
+// SHIFT), so a trace does not hold them in plain text. A reader decodes them
+// with cDecrypt; the mapping is one-to-one, so replayed duplicates and
+// attendee counts come out as recorded.
+//   TRACE_SEARCH:  query (outcome is the number of results)
+//   TRACE_DELETE:  title query
+//   TRACE_SAVE:    none
+enum TraceOp : uint8_t {
+    TRACE_CREATE = 1,
+    TRACE_SIGN_UP = 2,
+    TRACE_SEARCH = 3,
+    TRACE_DELETE = 4,
+    TRACE_SAVE = 5,
+};
+const int TRACE_OP_COUNT = 5;
+const char* traceOpName(TraceOp op); // "create", "signUp", ...
+
+// Outcomes of create, sign-up, delete and save calls. A replay compares them
+// with the recorded ones to spot runs that diverged.
+enum TraceOutcome : uint8_t {
+    TRACE_MISS = 0,      // Not found, or the call failed
+    TRACE_SUGGESTED = 1, // Not found, but a near title was offered
+    TRACE_REFUSED = 2,   // Found, but not done (event full or gone)
+    TRACE_OK = 3,
+};
+
+struct TraceRecord {
+    TraceOp op = TRACE_CREATE;
+    uint64_t startNs = 0;    // Since the recorder was opened
+    uint64_t durationNs = 0;
+    uint64_t outcome = 0;
+    std::vector<std::string> fields;
+};
+
+// Thread-safe: concurrent calls append whole records under a mutex. Records
+// are written in completion order, so start times may step backwards slightly
+// when calls overlap.
+class OpTraceRecorder {
+public:
+    OpTraceRecorder() = default;
+    OpTraceRecorder(const OpTraceRecorder&) = delete;
+    OpTraceRecorder& operator=(const OpTraceRecorder&) = delete;
+    ~OpTraceRecorder() { close(); }
+
+    bool open(const std::string& path); // Truncates; false (and cerr) on failure
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    uint64_t nowNs() const; // Trace clock
+    void record(TraceOp op, uint64_t startNs, uint64_t durationNs, uint64_t outcome, std::initializer_list<std::string> fields);
+    uint64_t recordCount() const;
+
+private:
+    mutable std::mutex lock;
+    std::ofstream file;
+    std::chrono::steady_clock::time_point opened;
+    uint64_t lastStartNs = 0;
+    uint64_t records = 0;
+    std::string buffer; // One encoded record
+};
+
+// Times one call for an optional recorder: free when recorder is null.
+class TracedCall {
+public:
+    explicit TracedCall(OpTraceRecorder* r) : recorder(r), startNs(r ? r->nowNs() : 0) {}
+    bool active() const { return recorder != nullptr; }
+    void finish(TraceOp op, uint64_t outcome, std::initializer_list<std::string> fields) {
+        if (recorder) recorder->record(op, startNs, recorder->nowNs() - startNs, outcome, fields);
+    }
+
+private:
+    OpTraceRecorder* recorder;
+    uint64_t startNs;
+};
+
+class OpTraceReader {
+public:
+    bool open(const std::string& path); // False (and error() set) if missing or not a trace
+    bool next(TraceRecord& record);     // False at the end, or on a truncated record (error() set)
+    const std::string& error() const { return lastError; }
+
+private:
+    std::ifstream file;
+    uint64_t lastStartNs = 0;
+    std::string lastError;
+
+    bool readVarint(uint64_t& value);
+};
@@ -0,0 +1,216 @@
+#include "person_table.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+// --- attendee Class Method Definitions ---
+attendee::attendee(string n, string e, string p, string cs) :
+    name(n), email(e), phoneNum(p), companyOrSchool(cs), accountedBytes(footprint()) {
+    memory_add(MEM_ATTENDEES, accountedBytes);
+}
+attendee::attendee(const attendee& other) :
+    name(other.name), email(other.email), phoneNum(other.phoneNum), companyOrSchool(other.companyOrSchool), accountedBytes(footprint()) {
+    memory_add(MEM_ATTENDEES, accountedBytes);
+}
+attendee::attendee(attendee&& other) noexcept :
+    name(move(other.name)), email(move(other.email)), phoneNum(move(other.phoneNum)), companyOrSchool(move(other.companyOrSchool)),
+    accountedBytes(other.accountedBytes) { // The strings' heap bytes move with them
+    other.accountedBytes = other.footprint();
+    memory_add(MEM_ATTENDEES, other.accountedBytes);
+}
+attendee& attendee::operator=(const attendee& other) {
+    name = other.name; email = other.email; phoneNum = other.phoneNum; companyOrSchool = other.companyOrSchool;
+    memory_release(MEM_ATTENDEES, accountedBytes);
+    accountedBytes = footprint();
+    memory_add(MEM_ATTENDEES, accountedBytes);
+    return *this;
+}
+attendee::~attendee() { memory_release(MEM_ATTENDEES, accountedBytes); }
+size_t attendee::footprint() const {
+    return sizeof(attendee) + string_heap_bytes(name) + string_heap_bytes(email) + string_heap_bytes(phoneNum) + string_heap_bytes(companyOrSchool);
+}
+string attendee::getName() const { return name; }
+string attendee::getEmail() const { return email; }
+string attendee::getPhoneNum() const { return phoneNum; }
+string attendee::getcompanyOrSchool() const { return companyOrSchool; }
+
+// --- PersonTable ---
+namespace {
+
+bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// [begin, end) of `email` without surrounding whitespace; false if nothing is left.
+bool trimmedRange(const string& email, size_t& begin, size_t& end) {
+    begin = 0;
+    end = email.size();
+    while (begin < end && isBlank(email[begin])) ++begin;
+    while (end > begin && isBlank(email[end - 1])) --end;
+    return begin < end;
+}
+
+char lower(char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); }
+
+// FNV-1a
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+uint64_t hashBytes(uint64_t h, const string& s) {
+    for (char c : s) h = (h ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+    return h;
+}
+
+} // namespace
+
+uint32_t PersonTable::keyHash(const attendee& who) {
+    uint64_t h = FNV_OFFSET;
+    size_t begin, end;
+    if (trimmedRange(who.email, begin, end)) {
+        for (size_t i = begin; i < end; ++i) h = (h ^ static_cast<unsigned char>(lower(who.email[i]))) * FNV_PRIME;
+    } else {
+        h = hashBytes(hashBytes(hashBytes(h ^ 0xFF, who.name) ^ 0x1F, who.phoneNum) ^ 0x1F, who.companyOrSchool);
+    }
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+bool PersonTable::sameKey(const attendee& a, const attendee& b) {
+    size_t aBegin, aEnd, bBegin, bEnd;
+    bool aHasEmail = trimmedRange(a.email, aBegin, aEnd);
+    bool bHasEmail = trimmedRange(b.email, bBegin, bEnd);
+    if (aHasEmail != bHasEmail) return false;
+    if (!aHasEmail) return a.name == b.name && a.phoneNum == b.phoneNum && a.companyOrSchool == b.companyOrSchool;
+    if (aEnd - aBegin != bEnd - bBegin) return false;
+    for (size_t i = 0; i < aEnd - aBegin; ++i) {
+        if (lower(a.email[aBegin + i]) != lower(b.email[bBegin + i])) return false;
+    }
+    return true;
+}
+
+PersonTable::~PersonTable() {
+    for (const attendee* person : people) delete person;
+}
+
+size_t PersonTable::probe(const attendee& who, uint32_t hash) const {
+    const size_t mask = index.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const IndexSlot& slot = index[i];
+        if (slot.id == NO_PERSON || (slot.hash == hash && sameKey(*people[slot.id], who))) return i;
+    }
+}
+
+PersonId PersonTable::place(size_t slot, uint32_t hash, const attendee* person) {
+    PersonId id = static_cast<PersonId>(people.size());
+    people.push_back(person);
+    index[slot] = IndexSlot{hash, id};
+    if (people.size() * 2 > index.size()) growIndex(people.size());
+    return id;
+}
+
+void PersonTable::growIndex(size_t peopleCount) {
+    size_t size = 16;
+    while (size < peopleCount * 2 + 1) size <<= 1;
+    if (size <= index.size()) return;
+    decltype(index) grown(size, IndexSlot{0, NO_PERSON});
+    for (const IndexSlot& slot : index) {
+        if (slot.id == NO_PERSON) continue;
+        size_t i = slot.hash & (size - 1);
+        while (grown[i].id != NO_PERSON) i = (i + 1) & (size - 1);
+        grown[i] = slot;
+    }
+    index.swap(grown);
+}
+
+PersonId PersonTable::intern(const attendee& who) {
+    const uint32_t hash = keyHash(who);
+    {
+        shared_lock<shared_mutex> guard(lookupLock);
+        if (!index.empty()) {
+            const IndexSlot& slot = index[probe(who, hash)];
+            if (slot.id != NO_PERSON) return slot.id;
+        }
+    }
+    unique_lock<shared_mutex> guard(lookupLock);
+    if (index.empty()) growIndex(1);
+    size_t slot = probe(who, hash); // Again: another thread may have added them meanwhile
+    return index[slot].id != NO_PERSON ? index[slot].id : place(slot, hash, new attendee(who));
+}
+
+// Bulk imports bring mostly new people: straight to the exclusive lock, so the
+// index is probed once.
+PersonId PersonTable::intern(attendee&& who) {
+    const uint32_t hash = keyHash(who);
+    unique_lock<shared_mutex> guard(lookupLock);
+    if (index.empty()) growIndex(1);
+    size_t slot = probe(who, hash);
+    return index[slot].id != NO_PERSON ? index[slot].id : place(slot, hash, new attendee(move(who)));
+}
+
+// Grows geometrically: an import reserves once per batch, and exact reserves
+// would copy everything each time.
+void PersonTable::reserve(size_t additional) {
+    {
+        unique_lock<shared_mutex> guard(lookupLock);
+        growIndex(people.size() + additional);
+    }
+    lock_guard<mutex> guard(attendanceLock);
+    size_t needed = attendancePool.size() + additional;
+    if (needed > attendancePool.capacity()) attendancePool.reserve(max(needed, 2 * attendancePool.capacity()));
+}
+
+PersonId PersonTable::find(const string& email) const {
+    size_t begin, end;
+    if (!trimmedRange(email, begin, end)) return NO_PERSON;
+    attendee key("", email, "", "");
+    const uint32_t hash = keyHash(key);
+    shared_lock<shared_mutex> guard(lookupLock);
+    return index.empty() ? NO_PERSON : index[probe(key, hash)].id;
+}
+
+void PersonTable::addAttendance(PersonId id, EventHandle h) {
+    lock_guard<mutex> guard(attendanceLock);
+    addAttendanceLocked(id, h);
+}
+
+void PersonTable::addAttendances(const vector<pair<PersonId, EventHandle>>& entries) {
+    lock_guard<mutex> guard(attendanceLock);
+    for (const auto& entry : entries) addAttendanceLocked(entry.first, entry.second);
+}
+
+void PersonTable::addAttendanceLocked(PersonId id, EventHandle h) {
+    if (id >= newestAttendance.size()) newestAttendance.resize(id + 1, NO_ENTRY);
+    for (uint32_t e = newestAttendance[id]; e != NO_ENTRY; e = attendancePool[e].next) {
+        if (attendancePool[e].event == h) return; // Signed up for it before
+    }
+    uint32_t entry = freeAttendance;
+    if (entry != NO_ENTRY) {
+        freeAttendance = attendancePool[entry].next;
+    } else {
+        entry = static_cast<uint32_t>(attendancePool.size());
+        attendancePool.emplace_back();
+    }
+    attendancePool[entry] = Attendance{h, newestAttendance[id]};
+    newestAttendance[id] = entry;
+}
+
+void PersonTable::removeAttendance(const vector<PersonId>& ids, EventHandle h) {
+    lock_guard<mutex> guard(attendanceLock);
+    for (PersonId id : ids) { // A repeated id finds nothing left to remove
+        if (id >= newestAttendance.size()) continue;
+        uint32_t* link = &newestAttendance[id];
+        while (*link != NO_ENTRY && attendancePool[*link].event != h) link = &attendancePool[*link].next;
+        if (*link == NO_ENTRY) continue;
+        uint32_t entry = *link;
+        *link = attendancePool[entry].next;
+        attendancePool[entry].next = freeAttendance;
+        freeAttendance = entry;
+    }
+}
+
+vector<EventHandle> PersonTable::attendanceOf(PersonId id) const {
+    vector<EventHandle> result;
+    lock_guard<mutex> guard(attendanceLock);
+    if (id >= newestAttendance.size()) return result;
+    for (uint32_t e = newestAttendance[id]; e != NO_ENTRY; e = attendancePool[e].next) result.push_back(attendancePool[e].event);
+    reverse(result.begin(), result.end()); // Oldest sign-up first
+    return result;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event_types.h" // EventHandle, PersonId
+#include "event_snapshot.h" // AppendOnlyList
+#include "memory_accounting.h" // TrackedAllocator, memory_add
+
+// One person's contact details. The PersonTable keeps one per person; events
+// refer to it by PersonId.
+class attendee {
+    friend class PersonTable; // Hashes and compares the fields without copying them
+private:
+    std::string name;
+    std::string email;
+    std::string phoneNum;
+    std::string companyOrSchool;
+    size_t accountedBytes; // Charged to MEM_ATTENDEES while this object lives
+    size_t footprint() const;
+public:
+    attendee(std::string n, std::string e, std::string p, std::string cs);
+    attendee(const attendee& other);
+    attendee(attendee&& other) noexcept;
+    attendee& operator=(const attendee& other);
+    ~attendee();
+    std::string getName() const;      // Added const
+    std::string getEmail() const;     // Added const
+    std::string getPhoneNum() const;  // Added const
+    std::string getcompanyOrSchool() const; // Added const
+};
+
+// --- PersonTable ---
+// Every person who signed up for any event, once each, keyed by email
+// (trimmed, any case). People without an email are keyed by their exact
+// details instead, so they only merge with identical entries. People are never
+// removed while the table lives, so a PersonId read from any event (even a
+// deleted one still held by a pinned snapshot) stays valid. The first
+// sign-up's details are the ones kept.
+//
+// The key index is open-addressed (hash, id) pairs compared against the
+// people themselves, so it stores no key strings: 8 bytes a slot, at most
+// half full.
+//
+// get() takes no lock: ids reach readers through an event's AttendeeList,
+// whose release-ordered append happens after the person was added here.
+// intern() and find() share lookupLock; the attendance lists (which events
+// each person attends) have their own lock, taken after the events' locks.
+class PersonTable {
+public:
+    static constexpr PersonId NO_PERSON = UINT32_MAX;
+
+    PersonTable() = default;
+    PersonTable(const PersonTable&) = delete;
+    PersonTable& operator=(const PersonTable&) = delete;
+    ~PersonTable();
+
+    PersonId intern(const attendee& who); // The existing id for who's key, or a new person
+    PersonId intern(attendee&& who);      // Same; a new person takes who's strings
+    void reserve(size_t additional);      // Room for that many new people and attendances without regrowing
+    PersonId find(const std::string& email) const; // NO_PERSON if nobody signed up with it
+    const attendee& get(PersonId id) const { return *people[id]; }
+    size_t size() const { return people.size(); }
+
+    // Attendance, kept by events as sign-ups land and events are deleted. Each
+    // event is listed once per person, however often they signed up for it.
+    void addAttendance(PersonId id, EventHandle h);
+    void addAttendances(const std::vector<std::pair<PersonId, EventHandle>>& entries); // One lock for a whole import batch
+    void removeAttendance(const std::vector<PersonId>& ids, EventHandle h); // ids may repeat
+    std::vector<EventHandle> attendanceOf(PersonId id) const;
+
+private:
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+    // One (person, event) pair. Each person's entries form a chain, newest
+    // first, in one shared pool: most people attend a handful of events, and a
+    // vector per person would cost more than the entries themselves.
+    struct Attendance {
+        EventHandle event;
+        uint32_t next; // Older entry of the same person, or the next free entry
+    };
+
+    struct IndexSlot {
+        uint32_t hash;
+        PersonId id; // NO_PERSON: empty
+    };
+
+    AppendOnlyList<const attendee*> people; // Indexed by PersonId; owned
+    mutable std::shared_mutex lookupLock;   // Guards index and appends to people
+    std::vector<IndexSlot, TrackedAllocator<IndexSlot, MEM_INDEXES>> index; // Power-of-two size, linear probing
+    mutable std::mutex attendanceLock;      // Guards the three members below
+    std::vector<uint32_t, TrackedAllocator<uint32_t, MEM_INDEXES>> newestAttendance; // By PersonId; NO_ENTRY if none
+    std::vector<Attendance, TrackedAllocator<Attendance, MEM_INDEXES>> attendancePool;
+    uint32_t freeAttendance = NO_ENTRY;     // Chain of removed entries, reused first
+
+    void addAttendanceLocked(PersonId id, EventHandle h); // Needs attendanceLock
+    static uint32_t keyHash(const attendee& who);
+    static bool sameKey(const attendee& a, const attendee& b);
+    // Slot holding who's key, or the empty slot where it would go. Needs lookupLock and a non-empty index.
+    size_t probe(const attendee& who, uint32_t hash) const;
+    // The rest need lookupLock held exclusively.
+    PersonId place(size_t slot, uint32_t hash, const attendee* person); // Appends person, filed in the empty `slot`
+    void growIndex(size_t peopleCount);
+};
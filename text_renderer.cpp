@@ -0,0 +1,397 @@
+#include "text_renderer.h"
+#include "gui_utils.h" // gRenderer, gFont, SCREEN_WIDTH
+#include "draw_list.h"
+#include "frame_profiler.h"
+#include "memory_accounting.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iterator>
+
+using namespace std;
+
+// --- GlyphAtlas ---
+bool GlyphAtlas::build(SDL_Renderer* renderer, TTF_Font* font) {
+    PROFILE_ZONE("glyph_atlas_build");
+    release();
+    if (!renderer || !font) return false;
+
+    fontHeight = TTF_FontHeight(font);
+    fontLineSkip = TTF_FontLineSkip(font);
+    const int ascent = TTF_FontAscent(font);
+    const SDL_Color white = {255, 255, 255, 255};
+
+    // Rasterize each glyph, then shelf-pack them left to right in rows.
+    vector<SDL_Surface*> rendered(LAST_CODEPOINT - FIRST_CODEPOINT + 1, nullptr);
+    int penX = GLYPH_PADDING, penY = GLYPH_PADDING, rowHeight = 0;
+    for (uint32_t cp = FIRST_CODEPOINT; cp <= LAST_CODEPOINT; ++cp) {
+        if (cp > 126 && cp < 160) continue; // DEL and the C1 controls
+        Glyph& g = glyphs[cp - FIRST_CODEPOINT];
+        int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+        if (TTF_GlyphMetrics(font, static_cast<Uint16>(cp), &minx, &maxx, &miny, &maxy, &advance) != 0) continue;
+        g.advance = advance;
+        g.present = true;
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(cp), white);
+        if (!surface || surface->w == 0 || surface->h == 0) { // Blank (e.g. space): advance only
+            if (surface) SDL_FreeSurface(surface);
+            continue;
+        }
+        // Newer SDL_ttf renders a glyph into a full-height cell at the pen
+        // position; older releases return the tight bitmap, which needs placing.
+        if (surface->h != fontHeight) {
+            g.xOffset = minx;
+            g.yOffset = ascent - maxy;
+        }
+        if (penX + surface->w + GLYPH_PADDING > ATLAS_WIDTH) {
+            penX = GLYPH_PADDING;
+            penY += rowHeight + GLYPH_PADDING;
+            rowHeight = 0;
+        }
+        g.src = {penX, penY, surface->w, surface->h};
+        penX += surface->w + GLYPH_PADDING;
+        rowHeight = max(rowHeight, surface->h);
+        rendered[cp - FIRST_CODEPOINT] = surface;
+    }
+    texWidth = ATLAS_WIDTH;
+    texHeight = penY + rowHeight + GLYPH_PADDING;
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, texWidth, texHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    if (sheet) {
+        SDL_FillRect(sheet, nullptr, 0);
+        for (uint32_t i = 0; i < rendered.size(); ++i) {
+            if (!rendered[i]) continue;
+            SDL_Rect dst = glyphs[i].src;
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE); // Copy coverage into alpha as-is
+            SDL_BlitSurface(rendered[i], nullptr, sheet, &dst);
+        }
+        atlasTexture = SDL_CreateTextureFromSurface(renderer, sheet);
+        PROFILE_COUNT(PROFILE_TEXTURE_UPLOADS);
+        SDL_FreeSurface(sheet);
+    }
+    for (SDL_Surface* surface : rendered) {
+        if (surface) SDL_FreeSurface(surface);
+    }
+    if (!atlasTexture) {
+        cerr << "Unable to build glyph atlas! SDL Error: " << SDL_GetError() << endl;
+        release();
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+    memory_add(MEM_GLYPH_ATLAS, textureBytes());
+    builtRenderer = renderer;
+    builtFont = font;
+    return true;
+}
+
+void GlyphAtlas::release() {
+    if (atlasTexture) {
+        SDL_DestroyTexture(atlasTexture);
+        memory_release(MEM_GLYPH_ATLAS, textureBytes());
+    }
+    atlasTexture = nullptr;
+    builtRenderer = nullptr;
+    builtFont = nullptr;
+    texWidth = texHeight = 0;
+    for (Glyph& g : glyphs) g = Glyph();
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::glyph(uint32_t codepoint) const {
+    if (codepoint >= FIRST_CODEPOINT && codepoint <= LAST_CODEPOINT && glyphs[codepoint - FIRST_CODEPOINT].present) {
+        return glyphs[codepoint - FIRST_CODEPOINT];
+    }
+    return glyphs['?' - FIRST_CODEPOINT];
+}
+
+// --- TextTextureCache ---
+namespace {
+
+Uint32 packColor(SDL_Color c) {
+    return (Uint32(c.r) << 24) | (Uint32(c.g) << 16) | (Uint32(c.b) << 8) | Uint32(c.a);
+}
+
+} // namespace
+
+TextTextureCache::TextTextureCache(size_t budgetBytes) {
+    counters.budgetBytes = budgetBytes;
+}
+
+SDL_Texture* TextTextureCache::get(SDL_Renderer* renderer, TTF_Font* font, const string& text, SDL_Color color,
+                                   int wrapWidth, int& w, int& h) {
+    if (renderer != cachedRenderer || font != cachedFont) {
+        clear();
+        cachedRenderer = renderer;
+        cachedFont = font;
+    }
+    const Uint32 rgba = packColor(color);
+    size_t hash = std::hash<string>()(text);
+    hash ^= (size_t(rgba) * 0x9E3779B1u) + (size_t(wrapWidth) << 7) + (hash >> 2);
+
+    auto range = byHash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        Entry& e = *it->second;
+        if (e.color == rgba && e.wrapWidth == wrapWidth && e.text == text) {
+            lru.splice(lru.begin(), lru, it->second); // Iterators stay valid across splice
+            ++counters.hits;
+            w = e.w;
+            h = e.h;
+            return e.texture;
+        }
+    }
+
+    ++counters.misses;
+    SDL_Surface* surface = wrapWidth > 0 ? TTF_RenderText_Blended_Wrapped(font, text.c_str(), color, wrapWidth)
+                                         : TTF_RenderText_Blended(font, text.c_str(), color);
+    if (!surface) {
+        cerr << "Unable to render text surface! SDL_ttf Error: " << TTF_GetError() << " for text: " << text.substr(0, 50) << endl;
+        return nullptr;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    PROFILE_COUNT(PROFILE_TEXTURE_UPLOADS);
+    w = surface->w;
+    h = surface->h;
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        cerr << "Unable to create texture from rendered text! SDL Error: " << SDL_GetError() << endl;
+        return nullptr;
+    }
+
+    const size_t bytes = size_t(w) * size_t(h) * 4;
+    lru.push_front({hash, text, rgba, wrapWidth, texture, w, h, bytes});
+    byHash.emplace(hash, lru.begin());
+    counters.bytes += bytes;
+    memory_add(MEM_TEXT_CACHE, bytes);
+    counters.entries = lru.size();
+    evictToBudget();
+    return texture;
+}
+
+void TextTextureCache::clear() {
+    releaseRetired();
+    for (Entry& e : lru) SDL_DestroyTexture(e.texture);
+    lru.clear();
+    byHash.clear();
+    counters.entries = 0;
+    memory_release(MEM_TEXT_CACHE, counters.bytes);
+    counters.bytes = 0;
+    cachedRenderer = nullptr;
+    cachedFont = nullptr;
+}
+
+void TextTextureCache::setBudget(size_t budgetBytes) {
+    counters.budgetBytes = budgetBytes;
+    evictToBudget();
+}
+
+void TextTextureCache::trimTo(size_t bytes) {
+    while (counters.bytes > bytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        ++counters.evictions;
+    }
+}
+
+void TextTextureCache::releaseRetired() {
+    for (SDL_Texture* texture : retired) SDL_DestroyTexture(texture);
+    retired.clear();
+}
+
+// Never evicts the most recent entry, so a string larger than the whole
+// budget can still be drawn once.
+void TextTextureCache::evictToBudget() {
+    while (counters.bytes > counters.budgetBytes && lru.size() > 1) {
+        erase(std::prev(lru.end()));
+        ++counters.evictions;
+    }
+}
+
+void TextTextureCache::erase(EntryRef entry) {
+    auto range = byHash.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == entry) {
+            byHash.erase(it);
+            break;
+        }
+    }
+    retired.push_back(entry->texture); // May still be queued in this frame's draw list
+    counters.bytes -= entry->bytes;
+    memory_release(MEM_TEXT_CACHE, entry->bytes);
+    lru.erase(entry);
+    counters.entries = lru.size();
+}
+
+// --- Text rendering ---
+namespace {
+
+struct TextLine {
+    size_t begin, end; // Byte range of the line, without the break character
+    int width;
+};
+
+struct TextRendererState {
+    GlyphAtlas atlas;
+    TextTextureCache cache;
+    const SDL_Renderer* failedRenderer = nullptr; // Don't retry a failed build every frame
+    const TTF_Font* failedFont = nullptr;
+    vector<TextLine> lines; // Reused between calls so laying out text allocates nothing once warmed up
+};
+
+TextRendererState& state() {
+    static TextRendererState s;
+    return s;
+}
+
+const GlyphAtlas* currentAtlas() {
+    TextRendererState& s = state();
+    if (!gRenderer || !gFont) return nullptr;
+    if (s.atlas.isBuiltFor(gRenderer, gFont)) return &s.atlas;
+    if (s.failedRenderer == gRenderer && s.failedFont == gFont) return nullptr;
+    if (!s.atlas.build(gRenderer, gFont)) {
+        s.failedRenderer = gRenderer;
+        s.failedFont = gFont;
+        return nullptr;
+    }
+    s.failedRenderer = nullptr;
+    s.failedFont = nullptr;
+    return &s.atlas;
+}
+
+// Decodes one UTF-8 sequence at text[i] and advances i past it. A malformed
+// byte is taken as Latin-1 on its own, which also covers non-UTF-8 input.
+uint32_t nextCodepoint(const string& text, size_t& i) {
+    const unsigned char lead = static_cast<unsigned char>(text[i++]);
+    if (lead < 0x80) return lead;
+    const int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+    if (extra < 0 || i + extra > text.size()) return lead;
+    uint32_t cp = lead & (0x3F >> extra);
+    for (int k = 0; k < extra; ++k) {
+        const unsigned char next = static_cast<unsigned char>(text[i + k]);
+        if ((next & 0xC0) != 0x80) return lead;
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    i += extra;
+    return cp;
+}
+
+// Splits text into lines at '\n' and, when wrapWidth > 0, at the last space
+// that keeps a line within wrapWidth (a word wider than that is broken
+// between characters). Returns the widest line.
+int layoutLines(const GlyphAtlas& atlas, const string& text, int wrapWidth, vector<TextLine>& lines) {
+    lines.clear();
+    size_t lineBegin = 0, lastSpace = string::npos;
+    int width = 0, widthBeforeSpace = 0, maxWidth = 0;
+    const int spaceAdvance = atlas.glyph(' ').advance;
+    auto endLine = [&](size_t end, int lineWidth) {
+        lines.push_back({lineBegin, end, lineWidth});
+        maxWidth = max(maxWidth, lineWidth);
+    };
+
+    for (size_t i = 0; i < text.size();) {
+        const size_t at = i;
+        const uint32_t cp = nextCodepoint(text, i);
+        if (cp == '\n') {
+            endLine(at, width);
+            lineBegin = i;
+            width = 0;
+            lastSpace = string::npos;
+            continue;
+        }
+        const int advance = atlas.glyph(cp).advance;
+        if (wrapWidth > 0 && cp != ' ' && width + advance > wrapWidth) {
+            if (lastSpace != string::npos) {
+                endLine(lastSpace, widthBeforeSpace);
+                lineBegin = lastSpace + 1;
+                width -= widthBeforeSpace + spaceAdvance;
+            } else if (at > lineBegin) {
+                endLine(at, width);
+                lineBegin = at;
+                width = 0;
+            }
+            lastSpace = string::npos;
+        }
+        if (cp == ' ') {
+            lastSpace = at;
+            widthBeforeSpace = width;
+        }
+        width += advance;
+    }
+    endLine(text.size(), width);
+    return maxWidth;
+}
+
+// SDL_ttf sizes a wrapped surface to the wrap width once it spans several lines.
+int blockWidth(const vector<TextLine>& lines, int maxLineWidth, int wrapWidth) {
+    return (wrapWidth > 0 && lines.size() > 1) ? wrapWidth : maxLineWidth;
+}
+
+} // namespace
+
+bool render_text_atlas(const string& text, int x, int y, SDL_Color color, bool center, int wrapWidth) {
+    if (!gDrawList.geometrySupported()) return false; // Per-glyph copies would cost more than cached whole strings
+    const GlyphAtlas* atlas = currentAtlas();
+    if (!atlas) return false;
+    TextRendererState& s = state();
+
+    const int maxLineWidth = layoutLines(*atlas, text, wrapWidth, s.lines);
+    if (center) x = (SCREEN_WIDTH - blockWidth(s.lines, maxLineWidth, wrapWidth)) / 2;
+
+    int lineTop = y;
+    for (const TextLine& line : s.lines) {
+        int penX = x;
+        for (size_t i = line.begin; i < line.end;) {
+            const GlyphAtlas::Glyph& g = atlas->glyph(nextCodepoint(text, i));
+            if (g.src.w > 0) {
+                SDL_Rect dst = {penX + g.xOffset, lineTop + g.yOffset, g.src.w, g.src.h};
+                gDrawList.texturedQuad(atlas->texture(), atlas->textureWidth(), atlas->textureHeight(), g.src, dst, color);
+            }
+            penX += g.advance;
+        }
+        lineTop += atlas->lineSkip();
+    }
+    return true;
+}
+
+bool measure_text_atlas(const string& text, int wrapWidth, int& w, int& h) {
+    const GlyphAtlas* atlas = currentAtlas();
+    if (!atlas) return false;
+    TextRendererState& s = state();
+    const int maxLineWidth = layoutLines(*atlas, text, wrapWidth, s.lines);
+    w = blockWidth(s.lines, maxLineWidth, wrapWidth);
+    h = atlas->lineHeight() + static_cast<int>(s.lines.size() - 1) * atlas->lineSkip();
+    return true;
+}
+
+int render_text_cached(const string& text, int x, int y, SDL_Color color, bool center, int wrapWidth) {
+    if (!gRenderer || !gFont || text.empty()) return 0;
+    int w = 0, h = 0;
+    SDL_Texture* texture = state().cache.get(gRenderer, gFont, text, color, wrapWidth, w, h);
+    if (!texture) return 0;
+    SDL_Rect renderQuad = {center ? (SCREEN_WIDTH - w) / 2 : x, y, w, h};
+    gDrawList.texturedQuad(texture, w, h, {0, 0, w, h}, renderQuad, {255, 255, 255, 255}); // Already coloured
+    return w;
+}
+
+void text_renderer_frame_done() {
+    state().cache.releaseRetired();
+}
+
+const TextCacheStats& text_cache_stats() {
+    return state().cache.stats();
+}
+
+void text_cache_trim(size_t bytes) {
+    state().cache.trimTo(bytes);
+}
+
+void text_renderer_shutdown() {
+    TextRendererState& s = state();
+    const TextCacheStats& stats = s.cache.stats();
+    if (stats.hits + stats.misses > 0) {
+        cout << "Text cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+             << stats.evictions << " evictions." << endl;
+    }
+    s.cache.clear();
+    s.atlas.release();
+    s.failedRenderer = nullptr;
+    s.failedFont = nullptr;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- GlyphAtlas ---
+// Every glyph of one font, rasterized once into a single texture. Covers
+// printable ASCII and Latin-1 (U+0020-U+007E, U+00A0-U+00FF); any other
+// codepoint draws as '?'. Glyphs are rendered white so one atlas serves every
+// text colour: the colour is applied per vertex at draw time.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        SDL_Rect src = {0, 0, 0, 0}; // In the atlas texture; w == 0 for blank glyphs
+        int xOffset = 0, yOffset = 0; // From the pen position and line top
+        int advance = 0;
+        bool present = false;
+    };
+
+    GlyphAtlas() = default;
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+    ~GlyphAtlas() { release(); }
+
+    bool build(SDL_Renderer* renderer, TTF_Font* font); // False (and empty) on failure
+    void release();
+    bool isBuiltFor(const SDL_Renderer* renderer, const TTF_Font* font) const {
+        return atlasTexture && renderer == builtRenderer && font == builtFont;
+    }
+
+    const Glyph& glyph(uint32_t codepoint) const;
+    SDL_Texture* texture() const { return atlasTexture; }
+    int textureWidth() const { return texWidth; }
+    int textureHeight() const { return texHeight; }
+    int lineHeight() const { return fontHeight; } // One line of text
+    int lineSkip() const { return fontLineSkip; } // Baseline to baseline in wrapped text
+    size_t textureBytes() const { return size_t(texWidth) * size_t(texHeight) * 4; } // Charged to MEM_GLYPH_ATLAS
+
+private:
+    static const uint32_t FIRST_CODEPOINT = 32;
+    static const uint32_t LAST_CODEPOINT = 255;
+    static const int ATLAS_WIDTH = 512;
+    static const int GLYPH_PADDING = 1; // Keeps linear filtering from bleeding neighbours in
+
+    Glyph glyphs[LAST_CODEPOINT - FIRST_CODEPOINT + 1];
+    SDL_Texture* atlasTexture = nullptr;
+    const SDL_Renderer* builtRenderer = nullptr;
+    const TTF_Font* builtFont = nullptr;
+    int texWidth = 0, texHeight = 0;
+    int fontHeight = 0, fontLineSkip = 0;
+};
+
+// --- TextTextureCache ---
+// Whole strings rendered by SDL_ttf, kept as textures keyed by (text, colour,
+// wrap width, font) and evicted least recently used first once their pixel
+// memory exceeds the budget. A hit costs a hash and one SDL_RenderCopy, and
+// allocates nothing. The cache empties itself when asked for a different
+// font or renderer, since the old textures belong to the old pair.
+struct TextCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;       // Estimated texture memory: w * h * 4 per entry
+    size_t budgetBytes = 0;
+};
+
+class TextTextureCache {
+public:
+    static const size_t DEFAULT_BUDGET_BYTES = 4 * 1024 * 1024;
+
+    explicit TextTextureCache(size_t budgetBytes = DEFAULT_BUDGET_BYTES);
+    TextTextureCache(const TextTextureCache&) = delete;
+    TextTextureCache& operator=(const TextTextureCache&) = delete;
+    ~TextTextureCache() { clear(); }
+
+    // Texture for the string, rendering it on a miss; nullptr if SDL_ttf fails.
+    // Evicted textures are only destroyed by releaseRetired() or clear(), so
+    // everything returned stays valid until the frame's draw list is flushed.
+    SDL_Texture* get(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color,
+                     int wrapWidth, int& w, int& h);
+    void clear();                    // Destroys every texture; counters are kept
+    void setBudget(size_t budgetBytes);
+    // Evicts least recently used entries until at most `bytes` remain, even the
+    // most recent one. For memory budgets; call between frames.
+    void trimTo(size_t bytes);
+    void releaseRetired();           // Destroys evicted textures; call once the frame is drawn
+    const TextCacheStats& stats() const { return counters; }
+
+private:
+    struct Entry {
+        size_t hash;
+        std::string text;
+        Uint32 color; // RGBA packed
+        int wrapWidth;
+        SDL_Texture* texture;
+        int w, h;
+        size_t bytes;
+    };
+    typedef std::list<Entry>::iterator EntryRef;
+
+    std::list<Entry> lru;                           // Most recently used first
+    std::unordered_multimap<size_t, EntryRef> byHash;
+    std::vector<SDL_Texture*> retired;              // Evicted, awaiting releaseRetired()
+    const SDL_Renderer* cachedRenderer = nullptr;
+    const TTF_Font* cachedFont = nullptr;
+    TextCacheStats counters;
+
+    void evictToBudget();
+    void erase(EntryRef entry);
+};
+
+// --- Text rendering ---
+// Both functions record into gDrawList rather than drawing immediately.
+// render_text_atlas lays text out from the atlas for gFont on gRenderer,
+// building it on first use and rebuilding it whenever either changes. Lines
+// are wrapped at spaces from the cached advances and each glyph becomes one
+// quad of the atlas texture, so all atlas text in a frame is one batch.
+// Returns false without drawing if the atlas cannot be built or the renderer
+// cannot draw geometry, so the caller can use render_text_cached instead.
+bool render_text_atlas(const std::string& text, int x, int y, SDL_Color color, bool center, int wrapWidth);
+// Records the string as one texture from the shared TextTextureCache and
+// returns its width (0 if nothing was drawn).
+int render_text_cached(const std::string& text, int x, int y, SDL_Color color, bool center, int wrapWidth);
+// Size the string would be drawn at by the atlas; false if it is unavailable.
+bool measure_text_atlas(const std::string& text, int wrapWidth, int& w, int& h);
+const TextCacheStats& text_cache_stats();
+void text_cache_trim(size_t bytes); // TextTextureCache::trimTo on the shared cache; the MEM_TEXT_CACHE evictor
+void text_renderer_frame_done(); // After the draw list is flushed: frees textures evicted during the frame
+void text_renderer_shutdown(); // Frees the atlas and cache; call before destroying the renderer or font
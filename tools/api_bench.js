@@ -0,0 +1,105 @@
+// Rows per second through the JavaScript API (events_api.h, events_api.js):
+// listing pages read through typed-array views over the result columns, against
+// the same pages read one field at a time with UTF8ToString.
+//
+// Build (from the repository root):
+//   emcc -std=c++17 -O2 -I. events_api.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp \
+//        --no-entry -s MODULARIZE=1 -s ALLOW_MEMORY_GROWTH=1 --post-js events_api.js \
+//        -s "EXPORTED_FUNCTIONS=['_events_api_create','_events_api_sign_up','_events_api_delete','_events_api_search','_events_api_list','_events_api_columns']" \
+//        -s "EXPORTED_RUNTIME_METHODS=['ccall','UTF8ToString','HEAPU8','HEAPU32']" -o events_api_module.js
+// Usage:
+//   node tools/api_bench.js [--module ./events_api_module.js] [--events 100000] [--page 1000] [--min-time 0.5]
+
+'use strict';
+
+const path = require('path');
+
+function parseArgs(argv) {
+  const options = {module: './events_api_module.js', events: 100000, page: 1000, minTime: 0.5};
+  for (let i = 2; i < argv.length; ++i) {
+    const value = argv[i + 1];
+    switch (argv[i]) {
+      case '--module': options.module = value; ++i; break;
+      case '--events': options.events = parseInt(value, 10); ++i; break;
+      case '--page': options.page = parseInt(value, 10); ++i; break;
+      case '--min-time': options.minTime = parseFloat(value); ++i; break;
+      default:
+        console.error(`Error: Unknown option '${argv[i]}'.`);
+        process.exit(1);
+    }
+  }
+  if (!(options.events > 0) || !(options.page > 0)) {
+    console.error('Error: --events and --page must be positive.');
+    process.exit(1);
+  }
+  return options;
+}
+
+// Runs readPage(offset) over consecutive pages until minTime has passed; rows per second.
+function measure(name, options, readPage) {
+  let rows = 0, offset = 0, checksum = 0;
+  const start = process.hrtime.bigint();
+  let seconds = 0;
+  while (seconds < options.minTime) {
+    const result = readPage(offset);
+    rows += result.rows;
+    checksum += result.checksum;
+    offset = offset + options.page >= options.events ? 0 : offset + options.page;
+    seconds = Number(process.hrtime.bigint() - start) / 1e9;
+  }
+  const rate = rows / seconds;
+  console.log(`${name.padEnd(14)} ${Math.round(rate).toLocaleString('en-US').padStart(14)} rows/s  (checksum ${checksum})`);
+  return rate;
+}
+
+async function main() {
+  const options = parseArgs(process.argv);
+  const factory = require(path.resolve(options.module));
+  const Module = await factory();
+  const api = Module.eventsApi;
+
+  const HOSTS = ['Ada Lovelace', 'Grace Hopper', 'Émilie du Châtelet', 'Søren Kierkegaard', '李小龍'];
+  const created = Date.now();
+  for (let i = 0; i < options.events; ++i) {
+    const day = 1 + (i % 28), hour = i % 24;
+    const message = api.create(i % 3, HOSTS[i % HOSTS.length], `Event ${i} — ${HOSTS[(i * 7) % HOSTS.length]}`, 'Benchmark event',
+                               `${String(day).padStart(2, '0')}/${String(1 + (i % 12)).padStart(2, '0')}/2026 ${String(hour).padStart(2, '0')}:00`,
+                               'Online', 10 + (i % 90));
+    if (message.startsWith('Error')) {
+      console.error(message);
+      process.exit(1);
+    }
+  }
+  console.error(`Created ${options.events} events in ${Date.now() - created} ms; pages of ${options.page} rows.`);
+
+  // Every field of every row, as a table view would need them.
+  const columnar = measure('columns', options, (offset) => {
+    const page = api.list(offset, options.page);
+    let checksum = 0;
+    for (let i = 0; i < page.rows; ++i) {
+      checksum += page.title(i).length + page.host(i).length + page.attendees[i] + page.capacity[i] + page.type[i];
+      if (!Number.isNaN(page.startTime[i])) checksum += page.startTime[i] % 7;
+    }
+    return {rows: page.rows, checksum: checksum};
+  });
+
+  // Baseline: the same reads, strings decoded per field from their byte offsets.
+  const perRow = measure('UTF8ToString', options, (offset) => {
+    const page = api.list(offset, options.page);
+    let checksum = 0;
+    for (let i = 0; i < page.rows; ++i) {
+      checksum += Module.UTF8ToString(page.stringsPtr + page.titleByte[i]).length +
+                  Module.UTF8ToString(page.stringsPtr + page.hostByte[i]).length +
+                  page.attendees[i] + page.capacity[i] + page.type[i];
+      if (!Number.isNaN(page.startTime[i])) checksum += page.startTime[i] % 7;
+    }
+    return {rows: page.rows, checksum: checksum};
+  });
+
+  console.log(`speedup        ${(columnar / perRow).toFixed(2)}x`);
+}
+
+main().catch((error) => {
+  console.error(`Error: ${error && error.stack ? error.stack : error}`);
+  process.exit(1);
+});
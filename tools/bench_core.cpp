@@ -0,0 +1,439 @@
+// Benchmark suite for the events core. Builds a seeded synthetic catalog
+// (titles, hosts, companies, attendee lists) at each requested scale, then
+// times levenshteinDistance, searchEvents, getListingPage, didYouMean,
+// attemptSignUp, saveEventsToFile, loadEventsFromFile and attemptDeleteEvent.
+// Results are written as JSON, one result object per line, so native and WASM
+// runs can be compared with --compare.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -I. tools/bench_core.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -o bench_core
+//   emcc -std=c++17 -O2 -I. tools/bench_core.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -s ALLOW_MEMORY_GROWTH=1 -s MAXIMUM_MEMORY=4GB -s NODERAWFS=1 -o bench_core.js
+// Usage:
+//   ./bench_core [--events 1000,10000,100000] [--attendees-per-event 5] [--seed 42]
+//                [--min-time SECONDS] [--only NAME] [--data FILE] [--json FILE]
+//   node bench_core.js ...same options...
+//   ./bench_core --compare BASE.json NEW.json
+// Counts accept k and M suffixes (e.g. --events 1k,1M,10M).
+
+#include "app_logic.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static const char* USAGE =
+    "Usage:\n"
+    "  bench_core [--events 1000,10000,100000] [--attendees-per-event 5] [--seed 42]\n"
+    "             [--min-time SECONDS] [--only NAME] [--data FILE] [--json FILE]\n"
+    "  bench_core --compare BASE.json NEW.json\n";
+
+#ifdef __EMSCRIPTEN__
+static const char* PLATFORM = "wasm";
+#else
+static const char* PLATFORM = "native";
+#endif
+
+struct Options {
+    vector<size_t> scales = {1000, 10000, 100000};
+    double attendeesPerEvent = 5;
+    uint64_t seed = 42;
+    double minSeconds = 0.5;    // Per benchmark, after at least MIN_ITERATIONS
+    string only;                // Run just this benchmark
+    string dataFile = "bench_core_events.txt";
+    string jsonFile = "-";      // "-": stdout
+};
+
+static const size_t MIN_ITERATIONS = 3;
+static const size_t IMPORT_BATCH = 65536;
+
+// --- Synthetic dataset ---
+// Everything is drawn from one seeded engine, so a (seed, scale) pair always
+// produces the same catalog and the same query mix.
+static const char* ADJECTIVES[] = {"Advanced", "Practical", "Modern", "Intro to", "Hands-on", "Applied", "Scalable",
+                                   "Secure", "Effective", "Open", "Annual", "Global", "Regional", "Weekly"};
+static const char* TOPICS[] = {"C++", "Rust", "WebAssembly", "Machine Learning", "Data Engineering", "Cloud Security",
+                               "UX Research", "Product Design", "Databases", "Compilers", "Embedded Systems",
+                               "Game Development", "Robotics", "Quantum Computing", "DevOps", "Accessibility"};
+static const char* FORMATS[] = {"Summit", "Workshop", "Bootcamp", "Meetup", "Masterclass", "Forum", "Webinar", "Symposium"};
+static const char* FIRST_NAMES[] = {"Alex", "Sam", "Jordan", "Taylor", "Morgan", "Casey", "Riley", "Jamie", "Avery",
+                                    "Quinn", "Noor", "Mateo", "Aiko", "Priya", "Lars", "Chidi", "Elena", "Tomas"};
+static const char* LAST_NAMES[] = {"Smith", "Garcia", "Chen", "Okafor", "Novak", "Silva", "Kim", "Haddad", "Larsen",
+                                   "Rossi", "Patel", "Nguyen", "Dubois", "Kowalski", "Tanaka", "Mensah", "Ortiz"};
+static const char* COMPANIES[] = {"Northwind Labs", "Contoso", "Initech", "Globex", "Umbrella Research", "Stark Industries",
+                                  "University of Lisbon", "ETH Zurich", "MIT", "Tokyo Tech", "Acme Corp", "Hooli",
+                                  "Wayne Enterprises", "Aperture Science", "Vandelay Industries", "Oscorp"};
+static const char* PLATFORMS[] = {"Zoom", "Teams", "Google Meet", "Webex", "Jitsi"};
+
+template <size_t N>
+static const char* pick(mt19937_64& rng, const char* (&words)[N]) {
+    return words[rng() % N];
+}
+
+static string personName(mt19937_64& rng) {
+    return string(pick(rng, FIRST_NAMES)) + " " + pick(rng, LAST_NAMES);
+}
+
+static string eventTitle(mt19937_64& rng, size_t i) {
+    return string(pick(rng, ADJECTIVES)) + " " + pick(rng, TOPICS) + " " + pick(rng, FORMATS) + " #" + to_string(i);
+}
+
+static string eventDate(mt19937_64& rng) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02u/%02u/%04u %02u:%02u", unsigned(1 + rng() % 28), unsigned(1 + rng() % 12),
+             unsigned(2025 + rng() % 6), unsigned(8 + rng() % 12), unsigned((rng() % 4) * 15));
+    return buf;
+}
+
+static attendee makeAttendee(mt19937_64& rng) {
+    string first = pick(rng, FIRST_NAMES), last = pick(rng, LAST_NAMES);
+    string email = first + "." + last + to_string(rng() % 10000) + "@example.com";
+    transform(email.begin(), email.end(), email.begin(), [](unsigned char c) { return char(tolower(c)); });
+    char phone[16];
+    snprintf(phone, sizeof(phone), "555-%04u", unsigned(rng() % 10000));
+    return attendee(first + " " + last, email, phone, pick(rng, COMPANIES));
+}
+
+// One character replaced, inserted or dropped: the near misses users type.
+static string withTypo(mt19937_64& rng, string s) {
+    if (s.empty()) return "x";
+    size_t pos = rng() % s.size();
+    switch (rng() % 3) {
+        case 0: s[pos] = char('a' + rng() % 26); break;
+        case 1: s.insert(pos, 1, char('a' + rng() % 26)); break;
+        default: s.erase(pos, 1); break;
+    }
+    return s;
+}
+
+struct Dataset {
+    vector<string> titles; // By creation order
+    size_t attendees = 0;
+};
+
+// Fills `manager` through importBatch, IMPORT_BATCH events at a time.
+static Dataset generateCatalog(events& manager, size_t eventCount, double attendeesPerEvent, mt19937_64& rng) {
+    Dataset data;
+    data.titles.reserve(eventCount);
+    const int maxAttendees = max(0, int(2 * attendeesPerEvent + 0.5)); // Uniform in [0, 2 * mean]
+    for (size_t begin = 0; begin < eventCount; begin += IMPORT_BATCH) {
+        events::ImportBatch batch;
+        size_t end = min(eventCount, begin + IMPORT_BATCH);
+        batch.newEvents.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            string title = eventTitle(rng, i);
+            int attendeeCount = maxAttendees ? int(rng() % (maxAttendees + 1)) : 0;
+            int capacity = attendeeCount + 5 + int(rng() % 50);
+            string description = string("A ") + pick(rng, FORMATS) + " on " + pick(rng, TOPICS) + ".";
+            eventType type = eventType(rng() % 3);
+            batch.newEvents.push_back(event::createEvent(type, personName(rng), title, description, eventDate(rng), pick(rng, PLATFORMS), capacity));
+            for (int a = 0; a < attendeeCount; ++a) batch.attendees.emplace_back(title, makeAttendee(rng));
+            data.titles.push_back(move(title));
+        }
+        size_t added = 0;
+        vector<size_t> rejected;
+        manager.importBatch(batch, added, rejected);
+        data.attendees += added;
+    }
+    return data;
+}
+
+// --- Measurement ---
+struct BenchResult {
+    string name;
+    size_t scale = 0;
+    vector<double> samplesNs;
+    vector<pair<string, double>> extra; // Benchmark-specific counters
+};
+
+// Times op(i) for i = 0, 1, ... until minSeconds have passed (and at least
+// MIN_ITERATIONS ran) or maxIterations is reached.
+template <typename Op>
+static BenchResult measure(const string& name, size_t scale, double minSeconds, size_t maxIterations, Op op) {
+    BenchResult r;
+    r.name = name;
+    r.scale = scale;
+    Clock::time_point started = Clock::now();
+    for (size_t i = 0; i < maxIterations; ++i) {
+        Clock::time_point t0 = Clock::now();
+        op(i);
+        r.samplesNs.push_back(chrono::duration<double, nano>(Clock::now() - t0).count());
+        if (i + 1 >= MIN_ITERATIONS && chrono::duration<double>(Clock::now() - started).count() >= minSeconds) break;
+    }
+    return r;
+}
+
+static double percentile(vector<double> sorted, double p) {
+    if (sorted.empty()) return 0;
+    sort(sorted.begin(), sorted.end());
+    size_t idx = min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + 0.5));
+    return sorted[idx];
+}
+
+static string jsonEscape(const string& s) {
+    string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out;
+}
+
+static string resultJson(const BenchResult& r) {
+    double total = 0;
+    for (double ns : r.samplesNs) total += ns;
+    const double mean = r.samplesNs.empty() ? 0 : total / r.samplesNs.size();
+    ostringstream out;
+    out << fixed << setprecision(1);
+    out << "{\"name\":\"" << jsonEscape(r.name) << "\",\"events\":" << r.scale << ",\"iterations\":" << r.samplesNs.size()
+        << ",\"minNs\":" << percentile(r.samplesNs, 0) << ",\"medianNs\":" << percentile(r.samplesNs, 0.5)
+        << ",\"p99Ns\":" << percentile(r.samplesNs, 0.99) << ",\"meanNs\":" << mean
+        << ",\"opsPerSec\":" << (mean > 0 ? 1e9 / mean : 0);
+    for (const auto& kv : r.extra) out << ",\"" << jsonEscape(kv.first) << "\":" << kv.second;
+    out << "}";
+    return out.str();
+}
+
+static void printSummary(const BenchResult& r) {
+    cerr << "  " << left << setw(20) << r.name << right << " median " << setw(14) << fixed << setprecision(0)
+         << percentile(r.samplesNs, 0.5) << " ns   p99 " << setw(14) << percentile(r.samplesNs, 0.99) << " ns   x"
+         << r.samplesNs.size() << endl;
+}
+
+// --- Suite ---
+static void runScale(const Options& opt, size_t scale, vector<BenchResult>& results) {
+    mt19937_64 rng(opt.seed ^ (scale * 0x9E3779B97F4A7C15ull));
+    remove(opt.dataFile.c_str());
+    auto setupStart = Clock::now();
+    // Deliberately never deleted: ~events saves, which would only add untimed
+    // seconds at large scales. The OS reclaims it.
+    events* manager = new events(opt.dataFile); // The file was just removed: starts empty, saving allowed
+    Dataset data = generateCatalog(*manager, scale, opt.attendeesPerEvent, rng);
+    double setupSeconds = chrono::duration<double>(Clock::now() - setupStart).count();
+    cerr << "events=" << scale << " attendees=" << data.attendees << " setup=" << fixed << setprecision(2) << setupSeconds << "s" << endl;
+
+    auto wanted = [&](const char* name) { return opt.only.empty() || opt.only == name; };
+    auto randomTitle = [&]() -> const string& { return data.titles[rng() % data.titles.size()]; };
+    auto record = [&](BenchResult r) { printSummary(r); results.push_back(move(r)); };
+    const size_t bulkIterations = scale >= 1000000 ? 1 : 5; // Whole-table operations
+
+    if (wanted("levenshteinDistance")) {
+        const size_t pairs = 4096;
+        vector<pair<string, string>> inputs;
+        for (size_t i = 0; i < pairs; ++i) inputs.emplace_back(randomTitle(), withTypo(rng, randomTitle()));
+        long checksum = 0;
+        BenchResult r = measure("levenshteinDistance", scale, opt.minSeconds, 1000000, [&](size_t i) {
+            const auto& p = inputs[i % pairs];
+            checksum += levenshteinDistance(p.first, p.second);
+        });
+        r.extra.emplace_back("checksum", double(checksum));
+        record(move(r));
+    }
+    if (wanted("searchEvents")) {
+        // A third each: exact titles, typos, and words that match nothing.
+        vector<string> queries;
+        for (size_t i = 0; i < 64; ++i) {
+            if (i % 3 == 0) queries.push_back(randomTitle());
+            else if (i % 3 == 1) queries.push_back(withTypo(rng, randomTitle()));
+            else queries.push_back(string("Zyxwv ") + to_string(rng() % 1000));
+        }
+        size_t matches = 0;
+        BenchResult r = measure("searchEvents", scale, opt.minSeconds, queries.size() * 4, [&](size_t i) {
+            matches += manager->searchEvents(queries[i % queries.size()]).size();
+        });
+        r.extra.emplace_back("matchesPerQuery", double(matches) / r.samplesNs.size());
+        record(move(r));
+    }
+    if (wanted("getListingPage")) {
+        // One screen of Show All at a random position, kept between reads as the GUI keeps it.
+        const size_t pageRows = 64;
+        vector<ListingRow> page;
+        size_t bytes = 0;
+        BenchResult r = measure("getListingPage", scale, opt.minSeconds, 100000, [&](size_t) {
+            size_t offset = manager->size() > pageRows ? rng() % (manager->size() - pageRows) : 0;
+            manager->getListingPage(offset, pageRows, page);
+            for (const ListingRow& row : page) bytes += row.text.size();
+        });
+        r.extra.emplace_back("bytesPerPage", double(bytes) / r.samplesNs.size());
+        record(move(r));
+    }
+    if (wanted("didYouMean")) {
+        // Mistyped titles, each asked twice in a row as a retry would: the second is a suggestion cache hit.
+        vector<string> queries;
+        while (queries.size() < 64) {
+            string query = withTypo(rng, randomTitle());
+            if (find(data.titles.begin(), data.titles.end(), query) == data.titles.end()) queries.push_back(query); // A real title would be deleted
+        }
+        uint64_t hits = gMetrics.suggestionCacheHits.get(), misses = gMetrics.suggestionCacheMisses.get();
+        uint64_t savedNs = gMetrics.suggestionCacheSavedNs.get();
+        BenchResult r = measure("didYouMean", scale, opt.minSeconds, queries.size() * 2, [&](size_t i) {
+            bool foundDirectly = false, foundSuggestion = false;
+            EventHandle suggestion;
+            manager->attemptDeleteEvent(queries[(i / 2) % queries.size()], foundDirectly, foundSuggestion, suggestion); // Never an exact title: only suggests
+        });
+        hits = gMetrics.suggestionCacheHits.get() - hits;
+        misses = gMetrics.suggestionCacheMisses.get() - misses;
+        r.extra.emplace_back("cacheHitRate", hits + misses ? double(hits) / double(hits + misses) : 0.0);
+        r.extra.emplace_back("savedNsPerCall", double(gMetrics.suggestionCacheSavedNs.get() - savedNs) / r.samplesNs.size());
+        record(move(r));
+    }
+    if (wanted("attemptSignUp")) {
+        User* user = User::getInstance();
+        user->setName("Bench User");
+        user->setEmail("bench.user@example.com");
+        user->setPhoneNumber("555-0000");
+        user->setCompanyOrSchool("Northwind Labs");
+        size_t signedUp = 0;
+        BenchResult r = measure("attemptSignUp", scale, opt.minSeconds, 200000, [&](size_t) {
+            bool foundDirectly = false, foundSuggestion = false, done = false;
+            string message;
+            EventHandle suggestion;
+            manager->attemptSignUp(user, randomTitle(), foundDirectly, foundSuggestion, message, suggestion, done);
+            if (done) ++signedUp;
+        });
+        r.extra.emplace_back("signedUp", double(signedUp));
+        record(move(r));
+    }
+    if (wanted("saveEventsToFile")) {
+        bool ok = true;
+        BenchResult r = measure("saveEventsToFile", scale, opt.minSeconds, bulkIterations, [&](size_t) { ok = manager->saveEventsToFile() && ok; });
+        ifstream saved(opt.dataFile, ios::binary | ios::ate);
+        r.extra.emplace_back("bytes", saved ? double(saved.tellg()) : 0.0);
+        r.extra.emplace_back("ok", ok ? 1.0 : 0.0);
+        record(move(r));
+    }
+    if (wanted("loadEventsFromFile")) {
+        if (!opt.only.empty()) manager->saveEventsToFile(); // The save benchmark did not run: write the file to read
+        vector<unique_ptr<events>> loaded; // Destroyed (and re-saved) after timing
+        BenchResult r = measure("loadEventsFromFile", scale, opt.minSeconds, bulkIterations, [&](size_t) {
+            loaded.emplace_back(new events(opt.dataFile));
+        });
+        r.extra.emplace_back("eventsLoaded", double(loaded.empty() ? 0 : loaded.back()->size()));
+        record(move(r));
+    }
+    if (wanted("attemptDeleteEvent")) { // Last: it shrinks the catalog
+        shuffle(data.titles.begin(), data.titles.end(), rng);
+        const size_t deletions = min<size_t>(data.titles.size(), 20000);
+        size_t deleted = 0;
+        BenchResult r = measure("attemptDeleteEvent", scale, opt.minSeconds, deletions, [&](size_t i) {
+            bool foundDirectly = false, foundSuggestion = false;
+            EventHandle suggestion;
+            manager->attemptDeleteEvent(data.titles[i], foundDirectly, foundSuggestion, suggestion);
+            if (foundDirectly) ++deleted;
+        });
+        r.extra.emplace_back("deleted", double(deleted));
+        record(move(r));
+    }
+    remove(opt.dataFile.c_str());
+}
+
+// --- Comparison ---
+struct ParsedResult {
+    string name;
+    size_t events = 0;
+    double medianNs = 0;
+};
+
+// Reads the result lines written by this tool (one object per line).
+static bool readResults(const string& path, vector<ParsedResult>& out) {
+    ifstream in(path);
+    if (!in) { cerr << "Error: Could not open " << path << endl; return false; }
+    string line;
+    auto field = [&](const string& key) -> string {
+        size_t at = line.find("\"" + key + "\":");
+        if (at == string::npos) return "";
+        at += key.size() + 3;
+        if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+        return line.substr(at, line.find_first_of(",}", at) - at);
+    };
+    while (getline(in, line)) {
+        if (line.find("\"medianNs\"") == string::npos) continue;
+        out.push_back({field("name"), stoul(field("events")), stod(field("medianNs"))});
+    }
+    return true;
+}
+
+static int compare(const string& basePath, const string& newPath) {
+    vector<ParsedResult> base, next;
+    if (!readResults(basePath, base) || !readResults(newPath, next)) return 1;
+    cout << left << setw(22) << "benchmark" << right << setw(10) << "events" << setw(16) << "base ns" << setw(16) << "new ns" << setw(10) << "new/base" << endl;
+    for (const ParsedResult& n : next) {
+        auto b = find_if(base.begin(), base.end(), [&](const ParsedResult& r) { return r.name == n.name && r.events == n.events; });
+        cout << left << setw(22) << n.name << right << setw(10) << n.events << fixed << setprecision(0);
+        if (b == base.end()) { cout << setw(16) << "-" << setw(16) << n.medianNs << setw(10) << "-" << endl; continue; }
+        cout << setw(16) << b->medianNs << setw(16) << n.medianNs << setw(10) << setprecision(2) << (b->medianNs > 0 ? n.medianNs / b->medianNs : 0) << endl;
+    }
+    return 0;
+}
+
+static size_t parseCount(const string& s) {
+    size_t used = 0;
+    double value = stod(s, &used);
+    string suffix = s.substr(used);
+    if (suffix == "k" || suffix == "K") value *= 1e3;
+    else if (suffix == "m" || suffix == "M") value *= 1e6;
+    else if (!suffix.empty()) throw invalid_argument(s);
+    return size_t(value);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            auto next = [&]() -> string {
+                if (i + 1 >= argc) throw invalid_argument(arg);
+                return argv[++i];
+            };
+            if (arg == "--compare") {
+                string basePath = next(), newPath = next();
+                return compare(basePath, newPath);
+            }
+            else if (arg == "--events") {
+                opt.scales.clear();
+                stringstream list(next());
+                for (string item; getline(list, item, ',');) opt.scales.push_back(parseCount(item));
+            }
+            else if (arg == "--attendees-per-event") opt.attendeesPerEvent = stod(next());
+            else if (arg == "--seed") opt.seed = stoull(next());
+            else if (arg == "--min-time") opt.minSeconds = stod(next());
+            else if (arg == "--only") opt.only = next();
+            else if (arg == "--data") opt.dataFile = next();
+            else if (arg == "--json") opt.jsonFile = next();
+            else throw invalid_argument(arg);
+        }
+        if (opt.scales.empty() || find(opt.scales.begin(), opt.scales.end(), size_t(0)) != opt.scales.end()) throw invalid_argument("--events");
+    } catch (const exception& e) {
+        cerr << "Bad argument: " << e.what() << "\n" << USAGE;
+        return 2;
+    }
+
+    // The core reports loads and saves on cout; keep them out of the JSON.
+    streambuf* coutBuffer = cout.rdbuf(nullptr);
+    vector<BenchResult> results;
+    for (size_t scale : opt.scales) runScale(opt, scale, results);
+    cout.rdbuf(coutBuffer);
+    cout.clear();
+
+    ofstream file;
+    if (opt.jsonFile != "-") {
+        file.open(opt.jsonFile);
+        if (!file) { cerr << "Error: Could not open " << opt.jsonFile << " for writing." << endl; return 1; }
+    }
+    ostream& out = opt.jsonFile == "-" ? cout : file;
+    out << "{\"tool\":\"bench_core\",\"platform\":\"" << PLATFORM << "\",\"compiler\":\"" << jsonEscape(__VERSION__)
+        << "\",\"seed\":" << opt.seed << ",\"attendeesPerEvent\":" << opt.attendeesPerEvent << ",\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i) out << resultJson(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    out << "]}" << endl;
+    return 0;
+}
@@ -0,0 +1,226 @@
+// Headless event service: serves the events API (see service_protocol.h) over a
+// Unix domain socket or localhost TCP, without SDL. A single epoll loop handles
+// all connections; every complete request line in a read is executed and the
+// responses are written back in one batch, so pipelined clients are served
+// without a round trip per request. A client that half-closes still gets every
+// response before the connection is closed. Linux only (epoll).
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -I. -Itools tools/event_service.cpp tools/service_protocol.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -o event_service
+// Usage:
+//   ./event_service [--unix PATH | --tcp PORT] [--data FILE] [--trace FILE]
+// Defaults: --unix /tmp/eventmgr.sock, in-memory data (nothing saved). With
+// --data, events are loaded at start and saved on SIGINT/SIGTERM. With
+// --trace, every call is recorded for tools/trace_replay.
+
+#include "app_logic.h"
+#include "service_protocol.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace std;
+
+static volatile sig_atomic_t stopRequested = 0;
+static void onSignal(int) { stopRequested = 1; }
+
+// A client that sends without reading its responses stops being read once
+// MAX_PENDING_OUTPUT bytes of them are waiting; its requests then back up in
+// its own socket. A request line may not be longer than MAX_LINE_BYTES.
+static const size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+static const size_t MAX_LINE_BYTES = 1024 * 1024;
+
+struct Connection {
+    string in;       // Bytes received, not yet executed
+    string out;      // Responses not yet accepted by the socket
+    size_t outSent = 0;
+    bool peerDone = false; // Half-closed (or a line was too long): nothing more is read; closed once out drains
+
+    size_t pendingOutput() const { return out.size() - outSent; }
+};
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static int openListener(bool useTcp, const string& unixPath, int port) {
+    int fd = -1;
+    if (useTcp) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { close(fd); return -1; }
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (unixPath.size() >= sizeof(addr.sun_path)) { close(fd); errno = ENAMETOOLONG; return -1; }
+        strncpy(addr.sun_path, unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(unixPath.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { close(fd); return -1; }
+    }
+    if (listen(fd, SOMAXCONN) < 0 || !setNonBlocking(fd)) { close(fd); return -1; }
+    return fd;
+}
+
+// Writes as much pending output as the socket takes. Returns false on a hard error.
+static bool flushOutput(int fd, Connection& c) {
+    while (c.outSent < c.out.size()) {
+        ssize_t n = send(fd, c.out.data() + c.outSent, c.out.size() - c.outSent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        c.outSent += static_cast<size_t>(n);
+    }
+    c.out.clear();
+    c.outSent = 0;
+    return true;
+}
+
+// Executes complete request lines from c.in until the pending output is at its cap.
+static void serveLines(events& manager, Connection& c) {
+    size_t start = 0, newline;
+    while (c.pendingOutput() < MAX_PENDING_OUTPUT && (newline = c.in.find('\n', start)) != string::npos) {
+        string line = c.in.substr(start, newline - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        c.out += handleRequest(manager, line);
+        start = newline + 1;
+    }
+    c.in.erase(0, start);
+    if (!c.peerDone && c.in.size() >= MAX_LINE_BYTES && c.in.find('\n') == string::npos) {
+        c.out += "ERR\tRequest line too long.\n";
+        c.in.clear();
+        c.peerDone = true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool useTcp = false;
+    string unixPath = "/tmp/eventmgr.sock";
+    int port = 7070;
+    string dataFile, traceFile;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--unix" && i + 1 < argc) { unixPath = argv[++i]; useTcp = false; }
+        else if (arg == "--tcp" && i + 1 < argc) { port = stoi(argv[++i]); useTcp = true; }
+        else if (arg == "--data" && i + 1 < argc) { dataFile = argv[++i]; }
+        else if (arg == "--trace" && i + 1 < argc) { traceFile = argv[++i]; }
+        else { cerr << "Usage: " << argv[0] << " [--unix PATH | --tcp PORT] [--data FILE] [--trace FILE]" << endl; return 2; }
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    OpTraceRecorder recorder; // Declared first: the manager's final save is recorded too
+    if (!traceFile.empty() && !recorder.open(traceFile)) return 1;
+    events manager(dataFile);
+    if (recorder.isOpen()) manager.setTraceRecorder(&recorder);
+
+    int listenFd = openListener(useTcp, unixPath, port);
+    if (listenFd < 0) { cerr << "Error: Could not listen: " << strerror(errno) << endl; return 1; }
+    int epollFd = epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    cout << "Event service listening on " << (useTcp ? "127.0.0.1:" + to_string(port) : unixPath) << endl;
+
+    unordered_map<int, Connection> connections;
+    epoll_event ready[64];
+    char buffer[64 * 1024];
+
+    auto closeConnection = [&](int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    };
+
+    while (!stopRequested) {
+        int n = epoll_wait(epollFd, ready, 64, 500);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Error: epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = ready[i].data.fd;
+            if (fd == listenFd) {
+                while (true) {
+                    int client = accept(listenFd, nullptr, nullptr);
+                    if (client < 0) break;
+                    setNonBlocking(client);
+                    if (useTcp) { int one = 1; setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); }
+                    epoll_event cev{};
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.fd = client;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, client, &cev);
+                    connections[client];
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& c = it->second;
+            // A hang-up with no error still lets queued responses out when only
+            // the peer's write side is closed; EPOLLHUP means neither side is open.
+            bool closed = (ready[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+
+            if ((ready[i].events & (EPOLLIN | EPOLLRDHUP)) && !c.peerDone) {
+                while (c.in.size() < MAX_LINE_BYTES) { // Bounded: the rest waits in the socket
+                    ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+                    if (got > 0) { c.in.append(buffer, static_cast<size_t>(got)); continue; }
+                    if (got == 0) c.peerDone = true; // Half-close: answer what was sent, then close
+                    else if (errno == EINTR) continue;
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK) closed = true;
+                    break;
+                }
+            }
+            // Lines held back by full output are served as the output drains.
+            while (!closed) {
+                serveLines(manager, c);
+                if (!flushOutput(fd, c)) closed = true;
+                if (!c.out.empty() || c.in.find('\n') == string::npos) break; // Socket full (EPOLLOUT resumes), or nothing left to run
+            }
+            if (closed || (c.peerDone && c.out.empty())) { closeConnection(fd); continue; }
+
+            // Read only while there is room for the responses; ask for EPOLLOUT
+            // only while output is backed up.
+            bool reading = !c.peerDone && c.pendingOutput() < MAX_PENDING_OUTPUT && c.in.size() < MAX_LINE_BYTES;
+            epoll_event mod{};
+            mod.events = (reading ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u) | (c.out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+            mod.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &mod);
+        }
+    }
+
+    cout << "Shutting down event service..." << endl;
+    for (auto& entry : connections) close(entry.first);
+    close(epollFd);
+    close(listenFd);
+    if (!useTcp) unlink(unixPath.c_str());
+    return 0; // ~events saves when a data file was given
+}
@@ -0,0 +1,265 @@
+// Load generator for event_service. Seeds a catalog of events, then drives a
+// mixed workload (search, sign-up, list, create, delete) over several
+// connections, each keeping `depth` requests in flight. Reports requests/sec
+// and p50/p99/max latency overall and per operation.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -I. -Itools tools/service_loadgen.cpp tools/service_protocol.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -o service_loadgen
+// Usage:
+//   ./service_loadgen [--unix PATH | --tcp PORT] [--connections N] [--depth D]
+//                     [--requests TOTAL] [--events SEED_EVENTS] [--seed N]
+
+#include "service_protocol.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct Options {
+    bool useTcp = false;
+    string unixPath = "/tmp/eventmgr.sock";
+    int port = 7070;
+    int connections = 4;
+    int depth = 32;
+    long requests = 200000;
+    int seedEvents = 500;
+    unsigned seed = 42;
+};
+
+static const ServiceOp MEASURED_OPS[] = {OP_SEARCH, OP_SIGN_UP, OP_LIST, OP_CREATE, OP_DELETE};
+
+static int connectTo(const Options& opt) {
+    int fd;
+    if (opt.useTcp) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(opt.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opt.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return -1;
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static string seedTitle(int i) { return "Load Event " + to_string(i); }
+
+static string seedDate(int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02d/%02d/%04d %02d:%02d", 1 + i % 28, 1 + (i / 28) % 12, 2025 + i / 336 % 5, 8 + i % 10, (i * 15) % 60);
+    return buf;
+}
+
+// Pipelined request/response client for one connection.
+class Worker {
+public:
+    Worker(const Options& o, int id) : opt(o), workerId(id), rng(o.seed + id) {}
+
+    bool run(long requestCount) {
+        int fd = connectTo(opt);
+        if (fd < 0) { cerr << "Worker " << workerId << ": could not connect: " << strerror(errno) << endl; return false; }
+
+        long issued = 0, completed = 0;
+        string out;
+        auto issue = [&]() {
+            ServiceOp op;
+            out += nextRequest(op);
+            inFlight.push_back({op, Clock::now()});
+            ++issued;
+        };
+        while (issued < requestCount && static_cast<long>(inFlight.size()) < opt.depth) issue();
+        if (!sendAll(fd, out)) { close(fd); return false; }
+        out.clear();
+
+        string in;
+        char buffer[64 * 1024];
+        while (completed < requestCount) {
+            ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+            if (got <= 0) { cerr << "Worker " << workerId << ": connection lost." << endl; close(fd); return false; }
+            in.append(buffer, static_cast<size_t>(got));
+            size_t start = 0, newline;
+            while ((newline = in.find('\n', start)) != string::npos) {
+                Pending p = inFlight.front();
+                inFlight.pop_front();
+                double micros = chrono::duration<double, micro>(Clock::now() - p.sent).count();
+                latencies[p.op].push_back(micros);
+                if (in.compare(start, 3, "ERR") == 0) ++errors;
+                start = newline + 1;
+                ++completed;
+                if (issued < requestCount) issue();
+            }
+            in.erase(0, start);
+            if (!out.empty()) {
+                if (!sendAll(fd, out)) { close(fd); return false; }
+                out.clear();
+            }
+        }
+        close(fd);
+        return true;
+    }
+
+    vector<double> latencies[128]; // Indexed by opcode character
+    long errors = 0;
+
+private:
+    struct Pending { ServiceOp op; Clock::time_point sent; };
+
+    const Options& opt;
+    int workerId;
+    mt19937 rng;
+    deque<Pending> inFlight;
+    vector<string> ownEvents; // Created by this worker, candidates for delete
+    long createdCount = 0;
+
+    string nextRequest(ServiceOp& op) {
+        int roll = uniform_int_distribution<int>(0, 99)(rng);
+        int target = uniform_int_distribution<int>(0, max(0, opt.seedEvents - 1))(rng);
+        if (roll < 40) {
+            op = OP_SEARCH;
+            string q = seedTitle(target);
+            q[uniform_int_distribution<size_t>(0, q.size() - 1)(rng)] = 'x'; // One typo
+            return encodeRequest(op, {q});
+        }
+        if (roll < 80) {
+            op = OP_SIGN_UP;
+            string who = "user" + to_string(workerId) + "_" + to_string(rng() % 100000);
+            return encodeRequest(op, {seedTitle(target), who, who + "@example.com", "555-0100", "Load Test Inc"});
+        }
+        if (roll < 95) {
+            op = OP_LIST;
+            return encodeRequest(op, {to_string(target), "20"});
+        }
+        if (roll < 98 || ownEvents.empty()) {
+            op = OP_CREATE;
+            string title = "W" + to_string(workerId) + " Extra " + to_string(createdCount++);
+            ownEvents.push_back(title);
+            return encodeRequest(op, {"1", "loadgen", title, "Generated", seedDate(static_cast<int>(createdCount)), "Zoom", "100"});
+        }
+        op = OP_DELETE;
+        string title = ownEvents.back();
+        ownEvents.pop_back();
+        return encodeRequest(op, {title});
+    }
+};
+
+static double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(idx, sorted.size() - 1)];
+}
+
+static string opName(ServiceOp op) {
+    switch (op) {
+        case OP_CREATE: return "create";
+        case OP_SIGN_UP: return "signup";
+        case OP_SEARCH: return "search";
+        case OP_DELETE: return "delete";
+        case OP_LIST: return "list";
+        case OP_PING: return "ping";
+    }
+    return "?";
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--unix") { opt.unixPath = next(); opt.useTcp = false; }
+        else if (arg == "--tcp") { opt.port = stoi(next()); opt.useTcp = true; }
+        else if (arg == "--connections") opt.connections = max(1, stoi(next()));
+        else if (arg == "--depth") opt.depth = max(1, stoi(next()));
+        else if (arg == "--requests") opt.requests = max(1L, stol(next()));
+        else if (arg == "--events") opt.seedEvents = max(1, stoi(next()));
+        else if (arg == "--seed") opt.seed = static_cast<unsigned>(stoul(next()));
+        else { cerr << "Unknown option " << arg << endl; return 2; }
+    }
+
+    // Seed the catalog over one pipelined connection.
+    {
+        int fd = connectTo(opt);
+        if (fd < 0) { cerr << "Could not connect to the event service: " << strerror(errno) << endl; return 1; }
+        string batch;
+        for (int i = 0; i < opt.seedEvents; ++i) {
+            batch += encodeRequest(OP_CREATE, {to_string(i % 3), "loadgen", seedTitle(i), "Seeded by service_loadgen", seedDate(i), "Zoom", "1000000"});
+        }
+        if (!sendAll(fd, batch)) { cerr << "Seeding failed." << endl; return 1; }
+        int responses = 0;
+        string in;
+        char buffer[64 * 1024];
+        while (responses < opt.seedEvents) {
+            ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+            if (got <= 0) { cerr << "Seeding connection lost." << endl; return 1; }
+            responses += static_cast<int>(count(buffer, buffer + got, '\n'));
+        }
+        close(fd);
+    }
+
+    vector<Worker> workers;
+    for (int i = 0; i < opt.connections; ++i) workers.emplace_back(opt, i);
+    vector<thread> threads;
+    long perWorker = opt.requests / opt.connections;
+    auto start = Clock::now();
+    for (int i = 0; i < opt.connections; ++i) {
+        long share = perWorker + (i == 0 ? opt.requests % opt.connections : 0);
+        threads.emplace_back([&workers, i, share] { workers[i].run(share); });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all;
+    long errors = 0;
+    cout << fixed << setprecision(1);
+    cout << "connections=" << opt.connections << " depth=" << opt.depth << " requests=" << opt.requests
+         << " seed_events=" << opt.seedEvents << "\n";
+    cout << left << setw(8) << "op" << right << setw(10) << "count" << setw(12) << "p50_us" << setw(12) << "p99_us" << setw(12) << "max_us" << "\n";
+    for (ServiceOp op : MEASURED_OPS) {
+        vector<double> lat;
+        for (auto& w : workers) lat.insert(lat.end(), w.latencies[op].begin(), w.latencies[op].end());
+        sort(lat.begin(), lat.end());
+        all.insert(all.end(), lat.begin(), lat.end());
+        cout << left << setw(8) << opName(op) << right << setw(10) << lat.size() << setw(12) << percentile(lat, 0.50)
+             << setw(12) << percentile(lat, 0.99) << setw(12) << (lat.empty() ? 0 : lat.back()) << "\n";
+    }
+    for (auto& w : workers) errors += w.errors;
+    sort(all.begin(), all.end());
+    cout << left << setw(8) << "all" << right << setw(10) << all.size() << setw(12) << percentile(all, 0.50)
+         << setw(12) << percentile(all, 0.99) << setw(12) << (all.empty() ? 0 : all.back()) << "\n";
+    cout << "elapsed=" << setprecision(3) << seconds << "s throughput=" << setprecision(0) << (all.size() / seconds)
+         << " req/s errors=" << errors << endl;
+    return all.size() == static_cast<size_t>(opt.requests) ? 0 : 1;
+}
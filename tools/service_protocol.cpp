@@ -0,0 +1,113 @@
+#include "service_protocol.h"
+
+using namespace std;
+
+static string sanitizeField(const string& value) {
+    string out = value;
+    for (char& c : out) {
+        if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+    }
+    return out;
+}
+
+string encodeRequest(ServiceOp op, const vector<string>& fields) {
+    string line(1, static_cast<char>(op));
+    for (const string& f : fields) {
+        line += '\t';
+        line += sanitizeField(f);
+    }
+    line += '\n';
+    return line;
+}
+
+vector<string> splitFields(const string& line) {
+    vector<string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == string::npos ? string::npos : tab - start));
+        if (tab == string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+static string okLine(const string& message) { return "OK\t" + sanitizeField(message) + "\n"; }
+static string errLine(const string& message) { return "ERR\t" + sanitizeField(message) + "\n"; }
+
+static string rowsLine(size_t count, const vector<string>& rows) {
+    string line = "OK\t" + to_string(count);
+    for (const string& r : rows) {
+        line += '\t';
+        line += sanitizeField(r);
+    }
+    line += '\n';
+    return line;
+}
+
+string handleRequest(events& manager, const string& line) {
+    vector<string> f = splitFields(line);
+    if (f.empty() || f[0].size() != 1) {
+        return errLine("Error: Malformed request.");
+    }
+
+    switch (f[0][0]) {
+        case OP_CREATE: {
+            if (f.size() != 8 || f[1].size() != 1 || f[1][0] < '0' || f[1][0] > '2') {
+                return errLine("Error: Create expects type, host, title, description, date, platform, capacity.");
+            }
+            eventType type = static_cast<eventType>(f[1][0] - '0');
+            string result = manager.createEventForHost(f[2], type, f[3], f[4], f[5], f[6], f[7]);
+            return result.find("successfully") != string::npos ? okLine(result) : errLine(result);
+        }
+        case OP_SIGN_UP: {
+            if (f.size() != 6) {
+                return errLine("Error: Sign up expects title, name, email, phone, company.");
+            }
+            attendee who(f[2], f[3], f[4], f[5]);
+            bool foundDirectly, foundSuggestion, signedUp;
+            EventHandle suggestion;
+            string message;
+            manager.attemptSignUpAs(who, f[1], foundDirectly, foundSuggestion, message, suggestion, signedUp);
+            return signedUp ? okLine(message) : errLine(message);
+        }
+        case OP_SEARCH: {
+            if (f.size() != 2) {
+                return errLine("Error: Search expects a query.");
+            }
+            vector<string> titles;
+            for (const EventHandle& h : manager.searchEvents(f[1])) {
+                titles.push_back(manager.getEventTitle(h));
+            }
+            return rowsLine(titles.size(), titles);
+        }
+        case OP_DELETE: {
+            if (f.size() != 2) {
+                return errLine("Error: Delete expects a title.");
+            }
+            bool foundDirectly, foundSuggestion;
+            EventHandle suggestion;
+            string result = manager.attemptDeleteEvent(f[1], foundDirectly, foundSuggestion, suggestion);
+            return foundDirectly ? okLine(result) : errLine(result);
+        }
+        case OP_LIST: {
+            size_t offset = 0, limit = 0;
+            try {
+                if (f.size() != 3) throw invalid_argument("field count");
+                offset = stoul(f[1]);
+                limit = stoul(f[2]);
+            } catch (const exception&) {
+                return errLine("Error: List expects offset and limit.");
+            }
+            vector<ListingRow> page;
+            manager.getListingPage(offset, limit, page); // Preformatted rows, read under one lock
+            vector<string> rows;
+            rows.reserve(page.size());
+            for (ListingRow& row : page) rows.push_back(move(row.text));
+            return rowsLine(manager.size(), rows);
+        }
+        case OP_PING:
+            return okLine("pong");
+    }
+    return errLine("Error: Unknown operation '" + f[0] + "'.");
+}
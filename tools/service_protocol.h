@@ -0,0 +1,43 @@
+#pragma once
+
+// --- Event service wire protocol ---
+// One request per line, fields separated by tabs, opcode first:
+//   C <type 0-2> <host> <title> <desc> <DD/MM/YYYY HH:MM> <platform> <capacity>   create
+//   S <title> <name> <email> <phone> <company>                                     sign up
+//   Q <query>                                                                      search
+//   D <title>                                                                      delete
+//   L <offset> <limit>                                                             list (chronological)
+//   P                                                                              ping
+// Every request gets exactly one response line, in request order, so clients
+// may pipeline as many requests as they like before reading (the service stops
+// reading a connection while 4 MB of its responses are unread). Request lines
+// are at most 1 MB. After a client shuts down its write side, it still gets
+// every response before the service closes the connection:
+//   OK <message>            create / sign up / delete / ping
+//   OK <n> <row>...         search (titles) and list (summaries); list's n is the total event count
+//   ERR <message>
+// Tabs and newlines inside values are replaced with spaces by encodeRequest.
+
+#include "app_logic.h"
+
+#include <string>
+#include <vector>
+
+enum ServiceOp : char {
+    OP_CREATE = 'C',
+    OP_SIGN_UP = 'S',
+    OP_SEARCH = 'Q',
+    OP_DELETE = 'D',
+    OP_LIST = 'L',
+    OP_PING = 'P'
+};
+
+// Builds one request line (including the trailing newline).
+std::string encodeRequest(ServiceOp op, const std::vector<std::string>& fields);
+
+// Splits a line (without its newline) on tabs.
+std::vector<std::string> splitFields(const std::string& line);
+
+// Executes one request line against `manager` and returns the response line
+// (including the trailing newline).
+std::string handleRequest(events& manager, const std::string& line);
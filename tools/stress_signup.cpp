@@ -0,0 +1,102 @@
+// Native stress run for concurrent sign-ups: 16 threads hammer a single event
+// through events::attemptSignUp while reader threads list, search and walk
+// attendee lists from snapshots, and a churn thread creates and deletes events
+// so old snapshot versions are retired and reclaimed under load. Exits
+// non-zero if the event ends up with more attendees than seats, or fewer
+// than were reported as successful.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -I. tools/stress_signup.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -o stress_signup
+// Usage: ./stress_signup [capacity] [attemptsPerThread]
+
+#include "app_logic.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    const int writerThreads = 16;
+    const int readerThreads = 2;
+    const int capacity = argc > 1 ? stoi(argv[1]) : 200000;
+    const int attemptsPerThread = argc > 2 ? stoi(argv[2]) : 25000;
+
+    User* user = User::getInstance();
+    user->setName("Stress Tester");
+    user->setEmail("stress@example.com");
+
+    events manager(""); // In-memory: nothing is loaded or saved
+    string created = manager.createEvent(user, Conference, "Stress Event", "Concurrent sign-up target", "01/06/2030 09:00", "Zoom", to_string(capacity));
+    if (created.find("successfully") == string::npos) {
+        cerr << created << endl;
+        return 1;
+    }
+
+    atomic<long> succeeded{0}, rejected{0}, reads{0}, churned{0};
+    atomic<bool> writersDone{false};
+    vector<thread> threads;
+
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < writerThreads; ++t) {
+        threads.emplace_back([&] {
+            bool fd, fs, signedUp;
+            EventHandle suggestion;
+            string message;
+            for (int i = 0; i < attemptsPerThread; ++i) {
+                manager.attemptSignUp(user, "Stress Event", fd, fs, message, suggestion, signedUp);
+                if (signedUp) ++succeeded; else ++rejected;
+            }
+        });
+    }
+    for (int t = 0; t < readerThreads; ++t) {
+        threads.emplace_back([&] {
+            while (!writersDone.load()) {
+                for (const EventHandle& h : manager.getEventsWithFreeSeats()) manager.getEventSummary(h);
+                manager.searchEvents("Stress");
+                size_t seen = 0;
+                manager.visitEvents([&](EventHandle, const event& e) {
+                    for (PersonId who : e.getAttendees()) seen += manager.getPerson(who).getName().size();
+                });
+                ++reads;
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        for (long i = 0; !writersDone.load(); ++i) {
+            string title = "Churn " + to_string(i % 64);
+            if (i % 2 == 0) {
+                manager.createEvent(user, Webinar, title, "Created and deleted under load", "02/06/2030 09:00", "Zoom", "10");
+            } else {
+                vector<EventHandle> found = manager.searchEvents(title);
+                if (!found.empty()) manager.deleteEvent(found.front());
+            }
+            ++churned;
+        }
+    });
+    for (int t = 0; t < writerThreads; ++t) threads[t].join();
+    auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    writersDone = true;
+    for (size_t t = writerThreads; t < threads.size(); ++t) threads[t].join();
+
+    EventHandle h = manager.searchEvents("Stress Event").front();
+    const event* e = manager.get(h);
+    const long attempts = static_cast<long>(writerThreads) * attemptsPerThread;
+    const long attendeesStored = static_cast<long>(e->getAttendees().size());
+    const long expected = min<long>(attempts, capacity);
+
+    cout << "threads=" << writerThreads << " capacity=" << capacity << " attempts=" << attempts << "\n"
+         << "succeeded=" << succeeded << " rejected=" << rejected << " stored=" << attendeesStored
+         << " count=" << e->getAttendeeCount() << " readerPasses=" << reads << " churnOps=" << churned << "\n"
+         << "elapsed=" << elapsed << "s throughput=" << static_cast<long>(attempts / elapsed) << " sign-ups/s" << endl;
+
+    if (attendeesStored > capacity || attendeesStored != succeeded || succeeded != expected || e->getAttendeeCount() != attendeesStored) {
+        cerr << "FAIL: seat accounting is inconsistent." << endl;
+        return 1;
+    }
+    cout << "OK" << endl;
+    return 0;
+}
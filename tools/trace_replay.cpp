@@ -0,0 +1,193 @@
+// Replays an operation trace (see op_trace.h) against a fresh events manager
+// and reports throughput and p50/p95/p99/max latency per operation, next to
+// the latencies that were recorded. Calls whose outcome differs from the
+// recorded one are counted as mismatches: a replay that diverges (e.g. because
+// the starting catalog differs) is not measuring the same work.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -I. tools/trace_replay.cpp app_logic.cpp event_index.cpp event_snapshot.cpp op_trace.cpp metrics.cpp memory_accounting.cpp person_table.cpp -o trace_replay
+// Usage:
+//   ./trace_replay TRACE [--speed max|recorded|FACTOR] [--initial DATAFILE] [--data SCRATCH] [--json FILE]
+// --speed max (the default) issues calls back to back; recorded keeps the
+// recorded gaps between call starts, and a factor such as 2 replays twice as
+// fast. --initial copies a data file in first, for traces recorded against an
+// existing catalog. Saves go to the scratch file, which is removed afterwards.
+
+#include "app_logic.h"
+#include "op_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static const char* USAGE =
+    "Usage: trace_replay TRACE [--speed max|recorded|FACTOR] [--initial DATAFILE] [--data SCRATCH] [--json FILE]\n";
+
+struct OpStats {
+    vector<double> replayNs;
+    vector<double> recordedNs;
+    size_t mismatches = 0;
+};
+
+static double percentile(vector<double>& values, double p) {
+    if (values.empty()) return 0;
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, size_t(p * (values.size() - 1) + 0.5))];
+}
+
+static bool copyFile(const string& from, const string& to) {
+    ifstream in(from, ios::binary);
+    ofstream out(to, ios::binary | ios::trunc);
+    if (!in || !out) return false;
+    out << in.rdbuf();
+    return bool(out);
+}
+
+// Executes one recorded call; returns its outcome in the trace's terms.
+static uint64_t replay(events& manager, const TraceRecord& r) {
+    const vector<string>& f = r.fields;
+    bool foundDirectly = false, foundSuggestion = false;
+    EventHandle suggestion;
+    switch (r.op) {
+        case TRACE_CREATE: {
+            if (f.size() < 7) return TRACE_MISS;
+            string result = manager.createEventForHost(cDecrypt(f[1], SHIFT), eventType(stoi(f[0]) % EVENT_TYPE_COUNT), f[2], f[3], f[4], f[5], f[6]);
+            return result.find("successfully") != string::npos ? TRACE_OK : TRACE_MISS;
+        }
+        case TRACE_SIGN_UP: {
+            if (f.size() < 5) return TRACE_MISS;
+            string message;
+            bool signedUp;
+            manager.attemptSignUpAs(attendee(cDecrypt(f[1], SHIFT), cDecrypt(f[2], SHIFT), cDecrypt(f[3], SHIFT), cDecrypt(f[4], SHIFT)), f[0], foundDirectly, foundSuggestion, message, suggestion, signedUp);
+            if (foundDirectly) return signedUp ? TRACE_OK : TRACE_REFUSED;
+            return foundSuggestion ? TRACE_SUGGESTED : TRACE_MISS;
+        }
+        case TRACE_SEARCH:
+            return manager.searchEvents(f.empty() ? string() : f[0]).size();
+        case TRACE_DELETE: {
+            if (f.empty()) return TRACE_MISS;
+            string result = manager.attemptDeleteEvent(f[0], foundDirectly, foundSuggestion, suggestion);
+            if (foundDirectly) return result.rfind("Deleted", 0) == 0 ? TRACE_OK : TRACE_REFUSED;
+            return foundSuggestion ? TRACE_SUGGESTED : TRACE_MISS;
+        }
+        case TRACE_SAVE:
+            return manager.saveEventsToFile() ? TRACE_OK : TRACE_MISS;
+    }
+    return TRACE_MISS;
+}
+
+int main(int argc, char* argv[]) {
+    string tracePath, initialFile, scratchFile = "trace_replay_events.txt", jsonFile;
+    double speed = 0; // 0: as fast as possible
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            auto next = [&]() -> string {
+                if (i + 1 >= argc) throw invalid_argument(arg);
+                return argv[++i];
+            };
+            if (arg == "--speed") {
+                string s = next();
+                speed = s == "max" ? 0 : s == "recorded" ? 1 : stod(s);
+                if (speed < 0) throw invalid_argument(s);
+            }
+            else if (arg == "--initial") initialFile = next();
+            else if (arg == "--data") scratchFile = next();
+            else if (arg == "--json") jsonFile = next();
+            else if (arg.rfind("--", 0) == 0 || !tracePath.empty()) throw invalid_argument(arg);
+            else tracePath = arg;
+        }
+        if (tracePath.empty()) throw invalid_argument("no trace given");
+    } catch (const exception& e) {
+        cerr << "Bad argument: " << e.what() << "\n" << USAGE;
+        return 2;
+    }
+
+    OpTraceReader reader;
+    if (!reader.open(tracePath)) { cerr << "Error: " << reader.error() << endl; return 1; }
+    remove(scratchFile.c_str());
+    if (!initialFile.empty() && !copyFile(initialFile, scratchFile)) {
+        cerr << "Error: Could not copy " << initialFile << " to " << scratchFile << endl;
+        return 1;
+    }
+
+    // The core reports loads and saves on cout; keep the report readable.
+    streambuf* coutBuffer = cout.rdbuf(nullptr);
+    size_t replayed = 0;
+    OpStats stats[TRACE_OP_COUNT + 1];
+    Clock::time_point started;
+    double wallSeconds = 0;
+    {
+        events manager(scratchFile);
+        size_t initialEvents = manager.size();
+        started = Clock::now();
+        TraceRecord record;
+        uint64_t firstStartNs = 0;
+        while (reader.next(record)) {
+            if (replayed == 0) firstStartNs = record.startNs;
+            if (speed > 0 && record.startNs > firstStartNs) {
+                this_thread::sleep_until(started + chrono::nanoseconds(uint64_t((record.startNs - firstStartNs) / speed)));
+            }
+            Clock::time_point t0 = Clock::now();
+            uint64_t outcome = replay(manager, record);
+            OpStats& s = stats[record.op];
+            s.replayNs.push_back(chrono::duration<double, nano>(Clock::now() - t0).count());
+            s.recordedNs.push_back(double(record.durationNs));
+            if (outcome != record.outcome) ++s.mismatches;
+            ++replayed;
+        }
+        wallSeconds = chrono::duration<double>(Clock::now() - started).count();
+        cout.rdbuf(coutBuffer);
+        cout.clear();
+        if (!reader.error().empty()) cerr << "Warn: " << tracePath << ": " << reader.error() << " after " << replayed << " records." << endl;
+        ostringstream speedLabel;
+        if (speed > 0) speedLabel << speed << "x"; else speedLabel << "max";
+        cout << "Replayed " << replayed << " calls from " << tracePath << " against " << initialEvents << " initial events in "
+             << fixed << setprecision(3) << wallSeconds << " s (" << setprecision(0) << (wallSeconds > 0 ? replayed / wallSeconds : 0)
+             << " calls/s, speed " << speedLabel.str() << ")" << endl;
+        cout.rdbuf(nullptr); // ~events saves to the scratch file
+    }
+    cout.rdbuf(coutBuffer);
+    cout.clear();
+    remove(scratchFile.c_str());
+
+    ostringstream json;
+    json << fixed << setprecision(1) << "{\"tool\":\"trace_replay\",\"trace\":\"" << tracePath << "\",\"calls\":" << replayed
+         << ",\"wallSeconds\":" << setprecision(6) << wallSeconds << ",\"ops\":[\n" << setprecision(1);
+    cout << left << setw(8) << "op" << right << setw(9) << "count" << setw(12) << "ops/s" << setw(12) << "p50 us" << setw(12) << "p95 us"
+         << setw(12) << "p99 us" << setw(12) << "max us" << setw(14) << "rec p50 us" << setw(12) << "mismatch" << endl;
+    bool first = true;
+    for (int op = TRACE_CREATE; op <= TRACE_SAVE; ++op) {
+        OpStats& s = stats[op];
+        if (s.replayNs.empty()) continue;
+        double busy = 0;
+        for (double ns : s.replayNs) busy += ns;
+        double opsPerSec = busy > 0 ? s.replayNs.size() * 1e9 / busy : 0;
+        double p50 = percentile(s.replayNs, 0.5), p95 = percentile(s.replayNs, 0.95), p99 = percentile(s.replayNs, 0.99);
+        double maxNs = s.replayNs.back(), recordedP50 = percentile(s.recordedNs, 0.5);
+        cout << left << setw(8) << traceOpName(TraceOp(op)) << right << setw(9) << s.replayNs.size() << setw(12) << setprecision(0) << opsPerSec
+             << setprecision(1) << setw(12) << p50 / 1e3 << setw(12) << p95 / 1e3 << setw(12) << p99 / 1e3 << setw(12) << maxNs / 1e3
+             << setw(14) << recordedP50 / 1e3 << setw(12) << s.mismatches << endl;
+        json << (first ? "" : ",\n") << "{\"op\":\"" << traceOpName(TraceOp(op)) << "\",\"count\":" << s.replayNs.size()
+             << ",\"opsPerSec\":" << opsPerSec << ",\"p50Ns\":" << p50 << ",\"p95Ns\":" << p95 << ",\"p99Ns\":" << p99
+             << ",\"maxNs\":" << maxNs << ",\"recordedP50Ns\":" << recordedP50 << ",\"mismatches\":" << s.mismatches << "}";
+        first = false;
+    }
+    json << "\n]}\n";
+    if (!jsonFile.empty()) {
+        ofstream out(jsonFile);
+        if (!out) { cerr << "Error: Could not open " << jsonFile << " for writing." << endl; return 1; }
+        out << json.str();
+    }
+    return 0;
+}